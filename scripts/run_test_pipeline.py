@@ -4,7 +4,7 @@ run_test_pipeline.py
 测试流水线 CLI：
 1. 使用 CMake 在 build/ 目录构建 C++ 基准程序 test_forest_bench
 2. 运行基准程序，生成 test-works/logs/*.csv
-3. 调用 tscripts.metrics + tscripts.visualize 读取最新日志并绘制 N vs Time 图
+3. 调用 tscripts.metrics + tscripts.visualize 读取最新日志并绘制 N vs Time 图（线程扩展性记录绘制 T vs Time 图）
 
 运行完整流水线（configure + build + run + scatter）：
 python ./scripts/run_test_pipeline.py
@@ -167,11 +167,48 @@ def run_cpp_bench(project_root: Path, build_dir: Path) -> None:
 # ============================================================
 
 
+def parse_int_field(parts: List[str], key: str) -> int | None:
+    """
+    在 test_func_name 的各段中查找 "key=整数" 并返回该整数，找不到或无法解析时返回 None。
+
+    Find a "key=<int>" part of a test_func_name and return the integer, or None.
+    """
+    prefix = key + "="
+    for p in parts:
+        if p.startswith(prefix):
+            try:
+                return int(p[len(prefix):])
+            except ValueError:
+                return None
+    return None
+
+
+def sort_series(data: Dict[str, Dict[str, Dict[str, List[float]]]]) -> None:
+    """
+    对每条曲线按 x 排序，保证图像是单调向右的折线。
+
+    Sort every curve by x so the plot runs left to right.
+    """
+    for op, containers in data.items():
+        for cname, series in containers.items():
+            xs = series["x"]
+            ys = series["y"]
+            if len(xs) != len(ys):
+                logger.log_error(
+                    f"[pipeline] length mismatch for op={op}, container={cname}"
+                )
+                continue
+            pairs = sorted(zip(xs, ys), key=lambda t: t[0])
+            if pairs:
+                series["x"], series["y"] = map(list, zip(*pairs))
+
+
 def build_time_vs_n_data(
     records: List[metrics.Record],
 ) -> Dict[str, Dict[str, Dict[str, List[float]]]]:
     """
     将 metrics.Record 列表转换为可供 visualize.plot_time_vs_n 使用的数据结构。
+    带 "T=" 段的线程扩展性记录不在这里，见 build_time_vs_t_data。
 
     输入：多条像 "BinaryTree.insert.N=100" 这样的 test_func_name 记录
     输出：
@@ -200,15 +237,11 @@ def build_time_vs_n_data(
         container = parts[0]
         op = parts[1]
 
-        n_value = None
-        for p in parts[2:]:
-            if p.startswith("N="):
-                try:
-                    n_value = int(p.split("N=", 1)[1])
-                except ValueError:
-                    n_value = None
-                break
+        if parse_int_field(parts[2:], "T") is not None:
+            # 线程扩展性记录按 T 作图 / thread-scaling records are plotted against T
+            continue
 
+        n_value = parse_int_field(parts[2:], "N")
         if n_value is None:
             logger.log_error(
                 f"[pipeline] Failed to parse N from test_func_name: {name}"
@@ -220,27 +253,57 @@ def build_time_vs_n_data(
         series["x"].append(float(n_value))
         series["y"].append(float(r.time_usage))
 
-    # 对每条曲线按 N 排序，保证图像是单调向右的折线
-    for op, containers in data.items():
-        for cname, series in containers.items():
-            xs = series["x"]
-            ys = series["y"]
-            if len(xs) != len(ys):
-                logger.log_error(
-                    f"[pipeline] length mismatch for op={op}, container={cname}"
-                )
-                continue
-            pairs = sorted(zip(xs, ys), key=lambda t: t[0])
-            if pairs:
-                series["x"], series["y"] = map(list, zip(*pairs))
+    sort_series(data)
+    return data
 
+
+def build_time_vs_t_data(
+    records: List[metrics.Record],
+) -> Dict[str, Dict[str, Dict[str, List[float]]]]:
+    """
+    把线程扩展性记录转换为 T（线程数）vs Time 的数据，每个 (op, N) 一张图。
+
+    输入：多条像 "ConcurrentAVLTree.mixed_r90.T=8.N=1048576" 或
+          "AVLTree@pool.alloc_scaling.T=4.N=10000" 这样的 test_func_name 记录
+    输出：
+        {
+            "mixed_r90.N=1048576": {
+                "ConcurrentAVLTree": {"x": [1, 2, 4, ...], "y": [...]},
+                "MutexAVLTree": {...},
+            },
+            ...
+        }
+    """
+    # op.N=n -> container_name -> {"x": [...], "y": [...]}
+    data: Dict[str, Dict[str, Dict[str, List[float]]]] = {}
+
+    for r in records:
+        parts = r.test_func_name.split(".")
+        if len(parts) < 3:
+            continue
+
+        t_value = parse_int_field(parts[2:], "T")
+        if t_value is None:
+            continue
+
+        container = parts[0]
+        op = parts[1]
+        n_value = parse_int_field(parts[2:], "N")
+        key = op if n_value is None else f"{op}.N={n_value}"
+
+        op_dict = data.setdefault(key, {})
+        series = op_dict.setdefault(container, {"x": [], "y": []})
+        series["x"].append(float(t_value))
+        series["y"].append(float(r.time_usage))
+
+    sort_series(data)
     return data
 
 
 def analyze_and_plot(project_root: Path) -> None:
     """
     从 test-works/logs 中找到最新一份 CSV，
-    解析记录并按操作类型绘制 N vs Time 图。
+    解析记录并按操作类型绘制 N vs Time 图；线程扩展性记录另绘 T vs Time 图。
     """
     # 保证 cwd 为工程根目录，这样 metrics.default_logs_directory() 就是 <root>/test-works/logs
     os.chdir(project_root)
@@ -274,6 +337,23 @@ def analyze_and_plot(project_root: Path) -> None:
         )
         logger.log_info(f"[pipeline] Figure saved to: {save_path}")
 
+    # 线程扩展性：每个 (op, N) 单独画一张 T vs Time 图
+    time_vs_t_data = build_time_vs_t_data(records)
+    for op, curves in time_vs_t_data.items():
+        if not curves:
+            continue
+        title = f"{op} time vs T"
+        logger.log_info(f"[pipeline] Scattering thread-scaling figure for op={op}")
+        save_path = visualize.scatter_time_vs_n(
+            data=curves,
+            title=title,
+            xlabel="T (threads)",
+            ylabel="Time (seconds)",
+            save_path=None,
+            show=False,
+        )
+        logger.log_info(f"[pipeline] Figure saved to: {save_path}")
+
 
 # ============================================================
 # CLI
@@ -5,12 +5,39 @@
 #include <cassert>
 #include <cstddef>
 #include <functional>
+#include <future>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace test_forest
 {
 
+    /**
+     * @brief AVL 节点的顺序统计字段：关闭时为空基类，不占空间
+     *        order-statistic field of an AVL node: an empty base taking no space when disabled
+     */
+    template <bool Enabled>
+    struct avl_subtree_count
+    {
+    };
+
+    /**
+     * @brief 开启顺序统计时记录以该节点为根的子树节点数
+     *        with order statistics enabled, holds the node count of the subtree rooted here
+     */
+    template <>
+    struct avl_subtree_count<true>
+    {
+        /// @brief 子树节点数 / subtree node count
+        std::size_t count = 1;
+    };
+
     /**
      * @brief AVL树容器（类似 std::set 的有序唯一键集合）
      *        AVL tree container (set-like ordered unique-key container)
@@ -18,13 +45,16 @@ namespace test_forest
      * @tparam T         键/值类型 / key & value type
      * @tparam Compare   比较器(less) / comparator (less)
      * @tparam Allocator 分配器(allocator) / allocator
+     * @tparam OrderStatistics 是否维护子树大小以支持 rank/select（缺省关闭）
+     *                         whether to maintain subtree sizes for rank/select (off by default)
      *
      * @note
      *  - 内部使用 AVL 树(AVL tree) 维护平衡，高度为 O(log N)
      *  - 使用 header 哨兵节点(sentinel) 模式，end() 指向 header
      *  - 迭代器为双向迭代器(bidirectional iterator)，中序遍历(in-order)
      */
-    template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>,
+              bool OrderStatistics = false>
     class avl_tree
     {
     private:
@@ -34,10 +64,10 @@ namespace test_forest
          * @brief AVL 树节点结构 / AVL tree node structure
          *
          * @note
-         *  - 存储值、父指针、左右子指针以及高度
+         *  - 存储值、父指针、左右子指针以及高度（开启顺序统计时另有子树大小）
          *  - 仅用于 avl_tree 内部实现 / internal-only for avl_tree
          */
-        struct node
+        struct node : avl_subtree_count<OrderStatistics>
         {
             /// @brief 节点存储的值 / stored value
             T value;
@@ -191,26 +221,36 @@ namespace test_forest
                 }
 
                 auto *p = node_->parent;
-                while (p && node_ == p->right)
+                while (node_ == p->right)
                 {
                     node_ = p;
                     p = p->parent;
                 }
-                node_ = p;
+                // 根即最大值时会经 header 绕回根，此时停在 header（end()）
+                // when the root is the maximum the climb wraps through header back to the
+                // root; stay on header (end()) in that case
+                if (node_->right != p)
+                    node_ = p;
             }
 
             /**
              * @brief 中序 -- / in-order --
              *
              * @note
-             *  - 对 --end() 未做 header 特殊处理，行为未定义
-             *  - STL 中 --end() 通常是定义良好的，这里实现略为简化
+             *  - --end() 得到最大元素 / --end() yields the largest element
              */
             void decrement() noexcept
             {
                 if (!node_)
                     return;
 
+                // header 的高度恒为 0：--end() 落到最大值 / header height is always 0: --end() yields the maximum
+                if (node_->height == 0)
+                {
+                    node_ = node_->right;
+                    return;
+                }
+
                 if (node_->left)
                 {
                     node_ = node_->left;
@@ -337,12 +377,16 @@ namespace test_forest
                 }
 
                 auto *p = node_->parent;
-                while (p && node_ == p->right)
+                while (node_ == p->right)
                 {
                     node_ = p;
                     p = p->parent;
                 }
-                node_ = p;
+                // 根即最大值时会经 header 绕回根，此时停在 header（end()）
+                // when the root is the maximum the climb wraps through header back to the
+                // root; stay on header (end()) in that case
+                if (node_->right != p)
+                    node_ = p;
             }
 
             void decrement() noexcept
@@ -350,6 +394,13 @@ namespace test_forest
                 if (!node_)
                     return;
 
+                // header 的高度恒为 0：--end() 落到最大值 / header height is always 0: --end() yields the maximum
+                if (node_->height == 0)
+                {
+                    node_ = node_->right;
+                    return;
+                }
+
                 if (node_->left)
                 {
                     node_ = node_->left;
@@ -404,7 +455,7 @@ namespace test_forest
          * @param alloc 分配器 / allocator
          */
         explicit avl_tree(const key_compare &comp, const allocator_type &alloc = allocator_type())
-            : header_(nullptr), size_(0), comp_(comp), alloc_(alloc)
+            : header_(nullptr), size_(0), comp_(comp), alloc_(alloc), finger_(nullptr)
         {
             init_header();
         }
@@ -415,23 +466,50 @@ namespace test_forest
          * @param alloc 分配器 / allocator
          */
         explicit avl_tree(const allocator_type &alloc)
-            : header_(nullptr), size_(0), comp_(key_compare()), alloc_(alloc)
+            : header_(nullptr), size_(0), comp_(key_compare()), alloc_(alloc), finger_(nullptr)
         {
             init_header();
         }
 
         /**
-         * @brief 拷贝构造 / copy constructor
+         * @brief 区间构造；有序（或可排序的随机访问）输入以 O(N) 批量建树
+         *        range constructor; sorted (or sortable random-access) input is bulk-loaded in O(N)
+         *
+         * @param first 起始迭代器 / begin iterator
+         * @param last  终止迭代器 / end iterator
+         * @param comp  比较器 / comparator
+         * @param alloc 分配器 / allocator
+         */
+        template <class InputIt>
+        avl_tree(InputIt first, InputIt last,
+                 const key_compare &comp = key_compare(),
+                 const allocator_type &alloc = allocator_type())
+            : avl_tree(comp, alloc)
+        {
+            insert(first, last);
+        }
+
+        /**
+         * @brief 初始化列表构造 / initializer-list constructor
+         */
+        avl_tree(std::initializer_list<value_type> init,
+                 const key_compare &comp = key_compare(),
+                 const allocator_type &alloc = allocator_type())
+            : avl_tree(comp, alloc)
+        {
+            insert(init.begin(), init.end());
+        }
+
+        /**
+         * @brief 拷贝构造：源序列已有序，直接 O(N) 批量建树
+         *        copy constructor: the source is already sorted, so it is bulk-loaded in O(N)
          *
          * @param other 另一个 AVL 树 / another AVL tree
          */
         avl_tree(const avl_tree &other)
             : avl_tree(other.comp_, other.get_allocator())
         {
-            for (const auto &v : other)
-            {
-                insert(v);
-            }
+            insert(other.begin(), other.end());
         }
 
         /**
@@ -440,10 +518,12 @@ namespace test_forest
          * @param other 被移动的 AVL 树 / AVL tree to move from
          */
         avl_tree(avl_tree &&other) noexcept
-            : header_(other.header_), size_(other.size_), comp_(std::move(other.comp_)), alloc_(std::move(other.alloc_))
+            : header_(other.header_), size_(other.size_), comp_(std::move(other.comp_)), alloc_(std::move(other.alloc_)),
+              finger_(other.finger_)
         {
             other.header_ = nullptr;
             other.size_ = 0;
+            other.finger_ = nullptr;
         }
 
         /**
@@ -480,9 +560,11 @@ namespace test_forest
             size_ = other.size_;
             comp_ = std::move(other.comp_);
             alloc_ = std::move(other.alloc_);
+            finger_ = other.finger_;
 
             other.header_ = nullptr;
             other.size_ = 0;
+            other.finger_ = nullptr;
 
             return *this;
         }
@@ -544,6 +626,7 @@ namespace test_forest
             header_->left = header_;
             header_->right = header_;
             size_ = 0;
+            finger_ = nullptr;
         }
 
         // ===================== 插入 / Insertion =====================
@@ -572,6 +655,96 @@ namespace test_forest
             return insert_impl(std::move(value));
         }
 
+        /**
+         * @brief 带提示插入（左值）：以 hint 为手指查找，hint 为 end() 时从最大值开始
+         *        hinted insert (lvalue): finger search from hint; end() starts from the maximum
+         *
+         * @param hint  位置提示 / position hint
+         * @param value 要插入的值 / value to insert
+         * @return 指向插入或已存在元素的迭代器 / iterator to the inserted or existing element
+         *
+         * @note 追加到最大值之后为 O(1) 加摊还 O(1) 回溯，其余为 O(log d)
+         *       appending past the maximum is O(1) plus amortized O(1) retracing, otherwise O(log d)
+         */
+        iterator insert(const_iterator hint, const value_type &value)
+        {
+            return insert_near(const_cast<node *>(hint.node_), value).first;
+        }
+
+        /**
+         * @brief 带提示插入（右值）/ hinted insert (rvalue)
+         */
+        iterator insert(const_iterator hint, value_type &&value)
+        {
+            return insert_near(const_cast<node *>(hint.node_), std::move(value)).first;
+        }
+
+        /**
+         * @brief 以参数就地构造值后带提示插入 / construct a value from args, then insert it with a hint
+         */
+        template <class... Args>
+        iterator emplace_hint(const_iterator hint, Args &&...args)
+        {
+            return insert(hint, value_type(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief 以上次插入（或命中）的位置为手指插入，适合局部性强的输入流
+         *        insert using the last insertion (or hit) point as the finger, for streams with
+         *        strong locality
+         *
+         * @return pair(迭代器, 是否插入成功) / pair(iterator, inserted ?)
+         */
+        std::pair<iterator, bool> finger_insert(const value_type &value)
+        {
+            return insert_near(finger_ ? finger_ : header_, value);
+        }
+
+        /**
+         * @brief finger_insert 的右值版本 / rvalue finger_insert
+         */
+        std::pair<iterator, bool> finger_insert(value_type &&value)
+        {
+            return insert_near(finger_ ? finger_ : header_, std::move(value));
+        }
+
+        /**
+         * @brief 插入区间 [first, last) / insert range [first, last)
+         *
+         * @note
+         *  - 空树时批量建树：有序输入（随机访问的无序输入先排序）按中位数递归一次建成，
+         *    同时写好高度与父指针，O(N)；其它迭代器只批量处理首个逆序元素之前的有序前缀
+         *    on an empty tree this bulk-loads: sorted input (unsorted random-access input is
+         *    sorted first) is built by recursive median in one pass that also sets heights and
+         *    parent links, O(N); other iterators bulk-load the sorted prefix up to the first
+         *    out-of-order element
+         *  - 其余元素逐个插入 / remaining elements are inserted one by one
+         */
+        template <class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if (empty() && first != last)
+            {
+                if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>)
+                {
+                    if (!std::is_sorted(first, last, comp_))
+                    {
+                        std::vector<value_type> sorted(first, last);
+                        std::sort(sorted.begin(), sorted.end(), comp_);
+                        bulk_load_prefix(std::make_move_iterator(sorted.begin()),
+                                         std::make_move_iterator(sorted.end()));
+                        return;
+                    }
+                }
+                first = bulk_load_prefix(first, last);
+            }
+            for (; first != last; ++first)
+            {
+                insert(*first);
+            }
+        }
+
         // ===================== 删除 / Erase =====================
 
         /**
@@ -901,6 +1074,228 @@ namespace test_forest
             return comp_;
         }
 
+        // ===================== 顺序统计 / Order statistics =====================
+
+        /**
+         * @brief 小于 key 的元素个数，O(log N) / number of elements less than key, O(log N)
+         *
+         * @note 需要 OrderStatistics = true / requires OrderStatistics = true
+         */
+        size_type rank(const key_type &key) const
+        {
+            static_assert(OrderStatistics, "avl_tree::rank requires OrderStatistics = true");
+            size_type r = 0;
+            const node *cur = root();
+            while (cur)
+            {
+                if (comp_(cur->value, key))
+                {
+                    r += 1 + subtree_count(cur->left);
+                    cur = cur->right;
+                }
+                else
+                {
+                    cur = cur->left;
+                }
+            }
+            return r;
+        }
+
+        /**
+         * @brief 第 k 小（从 0 起）的元素，k >= size() 时返回 end()，O(log N)
+         *        the k-th smallest element (0-based), end() if k >= size(), O(log N)
+         */
+        iterator select(size_type k)
+        {
+            return iterator(select_node(k));
+        }
+
+        /**
+         * @brief const 版本 select / const select
+         */
+        const_iterator select(size_type k) const
+        {
+            return const_iterator(select_node(k));
+        }
+
+        /**
+         * @brief [lo, hi) 内的元素个数，O(log N) / number of elements in [lo, hi), O(log N)
+         */
+        size_type count_range(const key_type &lo, const key_type &hi) const
+        {
+            if (!comp_(lo, hi))
+                return 0;
+            return rank(hi) - rank(lo);
+        }
+
+        /**
+         * @brief 迭代器的中序下标，end() 为 size()，O(log N)
+         *        in-order index of an iterator, size() for end(), O(log N)
+         */
+        size_type index_of(const_iterator pos) const
+        {
+            static_assert(OrderStatistics, "avl_tree::index_of requires OrderStatistics = true");
+            const node *n = pos.node_;
+            if (n == header_)
+                return size_;
+            size_type r = subtree_count(n->left);
+            while (n->parent != header_)
+            {
+                if (n == n->parent->right)
+                    r += 1 + subtree_count(n->parent->left);
+                n = n->parent;
+            }
+            return r;
+        }
+
+        /**
+         * @brief 两个迭代器之间的距离（last 的下标减 first 的下标），O(log N)
+         *        distance between two iterators (index of last minus index of first), O(log N)
+         */
+        difference_type distance(const_iterator first, const_iterator last) const
+        {
+            return static_cast<difference_type>(index_of(last)) -
+                   static_cast<difference_type>(index_of(first));
+        }
+
+        // ===================== 拼接、切分与集合代数 / Join, split & set algebra =====================
+
+        /**
+         * @brief 以 key 为分隔拼接两棵树：left 的元素均小于 key，right 的元素均大于 key
+         *        join two trees around key: every element of left is less than key and every
+         *        element of right is greater than key
+         *
+         * @param left  左树（被取走节点）/ left tree (its nodes are taken over)
+         * @param key   分隔键 / separating key
+         * @param right 右树（被取走节点）/ right tree (its nodes are taken over)
+         * @return 拼接结果，复杂度 O(|h(left) - h(right)| + 1)；分配器不等时另加复制 right 的 O(|right|)
+         *         / joined tree, O(|h(left) - h(right)| + 1), plus O(|right|) to copy right when
+         *         the allocators differ
+         *
+         * @throws std::invalid_argument 键序不满足前提 / ordering precondition violated
+         */
+        static avl_tree join(avl_tree left, value_type key, avl_tree right)
+        {
+            if ((!left.empty() && !left.comp_(left.header_->right->value, key)) ||
+                (!right.empty() && !left.comp_(key, right.header_->left->value)))
+            {
+                throw std::invalid_argument("avl_tree::join: keys are not ordered left < key < right");
+            }
+
+            // 结果沿用 left 的分配器；right 的节点若来自别的分配器（如各自独立的内存池），
+            // 先把元素复制到 left 的分配器上，否则 right 的池销毁后结果会悬空
+            // the result keeps left's allocator; if right's nodes come from a different one
+            // (e.g. a separate pool), copy its elements onto left's allocator first, otherwise
+            // the result would dangle once right's pool goes away
+            if constexpr (!node_traits::is_always_equal::value)
+            {
+                if (!(left.alloc_ == right.alloc_))
+                {
+                    avl_tree copied(right.comp_, left.get_allocator());
+                    copied.insert(right.begin(), right.end());
+                    right = std::move(copied);
+                }
+            }
+
+            avl_tree result(left.comp_, left.get_allocator());
+            node *k = result.create_node(std::move(key));
+            size_type n = left.size_ + right.size_ + 1;
+            node *l = left.release_root();
+            node *r = right.release_root();
+            result.adopt_root(result.join_nodes(l, k, r), n);
+            return result;
+        }
+
+        /**
+         * @brief 切分：本树保留小于 key 的元素，大于等于 key 的元素移入返回的树
+         *        split: this tree keeps the elements less than key; the elements not less than
+         *        key are moved into the returned tree
+         *
+         * @param key 切分键 / split key
+         * @return 含所有 >= key 元素的树 / tree holding every element >= key
+         *
+         * @note
+         *  - 结构调整 O(log N)；开启顺序统计时大小直接可得，否则两侧元素个数以交替步进的方式
+         *    统计，额外 O(min(|L|, |R|))
+         *    restructuring is O(log N); with order statistics the sizes are read off the roots,
+         *    otherwise they are counted by stepping both sides in lockstep, an extra
+         *    O(min(|L|, |R|))
+         */
+        avl_tree split(const key_type &key)
+        {
+            avl_tree upper(comp_, get_allocator());
+            size_type total = size_;
+            split_result parts = split_nodes(release_root(), key);
+            node *hi = parts.mid ? join_nodes(nullptr, parts.mid, parts.right) : parts.right;
+            adopt_root(parts.left, 0);
+            upper.adopt_root(hi, 0);
+
+            if constexpr (OrderStatistics)
+            {
+                size_ = subtree_count(root());
+                upper.size_ = total - size_;
+                return upper;
+            }
+
+            // size_ 尚未确定，直接从 header 最左指针起步 / sizes are not known yet, so start from the header extremes
+            size_type counted = 0;
+            iterator a(header_->left);
+            iterator b(upper.header_->left);
+            while (a != end() && b != upper.end())
+            {
+                ++a;
+                ++b;
+                ++counted;
+            }
+            size_ = a == end() ? counted : total - counted;
+            upper.size_ = total - size_;
+            return upper;
+        }
+
+        /**
+         * @brief 基于 join 的并集，复杂度 O(m log(n/m + 1))，两侧递归以 fork-join 并行
+         *        join-based union in O(m log(n/m + 1)); the two recursive halves run fork-join
+         *        in parallel
+         *
+         * @param a 第一棵树（节点被复用）/ first tree (nodes are reused)
+         * @param b 第二棵树（节点被复用，重复元素保留 a 的）/ second tree (nodes are reused;
+         *          duplicates keep a's element)
+         * @param max_threads 最多使用的线程数，缺省 1 即串行，并行须显式指定
+         *                    / maximum number of threads; the default 1 runs serially, parallelism is opt-in
+         * @return 并集 / the union
+         *
+         * @note
+         *  - max_threads > 1 时分配器须可并发释放，比较器不得抛出异常
+         *    with max_threads > 1 the allocator must support concurrent deallocation; the
+         *    comparator must not throw
+         */
+        static avl_tree set_union(avl_tree a, avl_tree b,
+                                  unsigned max_threads = 1)
+        {
+            return set_operation(std::move(a), std::move(b), max_threads, &avl_tree::union_nodes);
+        }
+
+        /**
+         * @brief 基于 join 的交集（保留 a 的元素），复杂度与并行方式同 set_union
+         *        join-based intersection (keeps a's elements), same cost and parallelism as
+         *        set_union
+         */
+        static avl_tree set_intersection(avl_tree a, avl_tree b,
+                                         unsigned max_threads = 1)
+        {
+            return set_operation(std::move(a), std::move(b), max_threads, &avl_tree::intersection_nodes);
+        }
+
+        /**
+         * @brief 基于 join 的差集 a \ b，复杂度与并行方式同 set_union
+         *        join-based difference a \ b, same cost and parallelism as set_union
+         */
+        static avl_tree set_difference(avl_tree a, avl_tree b,
+                                       unsigned max_threads = 1)
+        {
+            return set_operation(std::move(a), std::move(b), max_threads, &avl_tree::difference_nodes);
+        }
+
         // ===================== 其它辅助接口 / Other helpers =====================
 
         /**
@@ -915,6 +1310,7 @@ namespace test_forest
             swap(size_, other.size_);
             swap(comp_, other.comp_);
             swap(alloc_, other.alloc_);
+            swap(finger_, other.finger_);
         }
 
     private:
@@ -932,6 +1328,10 @@ namespace test_forest
         /// @brief 节点分配器 / node allocator
         node_allocator_raw alloc_;
 
+        /// @brief 上次插入（或命中）的位置，供 finger_insert 使用；删除该节点时置空
+        ///        last insertion (or hit) point used by finger_insert; cleared when that node is erased
+        node *finger_;
+
         // ===================== 内部工具函数 / Internal helpers =====================
 
         /**
@@ -942,6 +1342,34 @@ namespace test_forest
             return header_ ? header_->parent : nullptr;
         }
 
+        /**
+         * @brief 按中序下标定位节点，越界返回 header / locate a node by in-order index, header
+         *        if out of range
+         */
+        node *select_node(size_type k) const
+        {
+            static_assert(OrderStatistics, "avl_tree::select requires OrderStatistics = true");
+            node *cur = root();
+            while (cur)
+            {
+                size_type left = subtree_count(cur->left);
+                if (k < left)
+                {
+                    cur = cur->left;
+                }
+                else if (k == left)
+                {
+                    return cur;
+                }
+                else
+                {
+                    k -= left + 1;
+                    cur = cur->right;
+                }
+            }
+            return header_;
+        }
+
         /**
          * @brief 设置根节点 / set root node
          *
@@ -977,7 +1405,19 @@ namespace test_forest
         }
 
         /**
-         * @brief 更新节点高度 / update node height
+         * @brief 子树节点数（未开启顺序统计时恒为 0）/ subtree node count (always 0 without
+         *        order statistics)
+         */
+        static size_type subtree_count(const node *n) noexcept
+        {
+            if constexpr (OrderStatistics)
+                return n ? n->count : 0;
+            else
+                return 0;
+        }
+
+        /**
+         * @brief 更新节点高度（及子树大小）/ update node height (and subtree size)
          *
          * @param n 节点指针 / node pointer
          */
@@ -988,6 +1428,8 @@ namespace test_forest
             int hl = height(n->left);
             int hr = height(n->right);
             n->height = (hl > hr ? hl : hr) + 1;
+            if constexpr (OrderStatistics)
+                n->count = 1 + subtree_count(n->left) + subtree_count(n->right);
         }
 
         /**
@@ -1172,51 +1614,69 @@ namespace test_forest
         }
 
         /**
-         * @brief 从某节点开始向上重平衡 / rebalance from a node upwards
+         * @brief 对 n 做一次局部重平衡并返回该位置的新子树根 / rebalance n locally and
+         *        return the new subtree root at its position
          *
-         * @param n 起始节点 / starting node
+         * @param n 高度可能失衡的节点 / node whose balance may be violated
+         * @return 新子树根节点 / new subtree root
          */
-        void rebalance_from(node *n) noexcept
+        node *rebalance_node(node *n) noexcept
         {
-            while (n && n != header_)
-            {
-                update_height(n);
-                int bf = balance_factor(n);
+            update_height(n);
+            int bf = balance_factor(n);
 
-                if (bf > 1)
-                {
-                    if (balance_factor(n->left) < 0)
-                        rotate_left(n->left);
-                    n = rotate_right(n);
-                }
-                else if (bf < -1)
-                {
-                    if (balance_factor(n->right) > 0)
-                        rotate_right(n->right);
-                    n = rotate_left(n);
-                }
+            if (bf > 1)
+            {
+                if (balance_factor(n->left) < 0)
+                    rotate_left(n->left);
+                n = rotate_right(n);
+            }
+            else if (bf < -1)
+            {
+                if (balance_factor(n->right) > 0)
+                    rotate_right(n->right);
+                n = rotate_left(n);
+            }
+            return n;
+        }
 
-                if (n->parent == header_)
-                    break;
-                n = n->parent;
+        /**
+         * @brief 插入后向上回溯；子树高度不变或发生旋转即停止
+         *        / retrace upwards after insertion; stop once a subtree height is unchanged
+         *        or a rotation has absorbed the growth
+         *
+         * @param n 新节点的父节点 / parent of the new node
+         */
+        void retrace_insert(node *n) noexcept
+        {
+            while (n != header_)
+            {
+                int old_height = n->height;
+                node *sub = rebalance_node(n);
+                // 插入后的旋转总能恢复原高度 / a rotation after insertion always restores the old height
+                if (sub != n || sub->height == old_height)
+                    return;
+                n = sub->parent;
             }
-            update_extreme();
         }
 
         /**
-         * @brief 更新 header 的最左和最右指针 / update leftmost & rightmost in header
+         * @brief 删除后向上回溯；子树高度不变即停止（删除时旋转可能继续降低高度）
+         *        / retrace upwards after erasure; stop once a subtree height is unchanged
+         *        (on erasure a rotation may still shrink the height)
+         *
+         * @param n 结构发生变化的最深节点 / deepest node whose subtree changed
          */
-        void update_extreme() noexcept
+        void retrace_erase(node *n) noexcept
         {
-            node *r = root();
-            if (!r)
+            while (n != header_)
             {
-                header_->left = header_;
-                header_->right = header_;
-                return;
+                int old_height = n->height;
+                node *sub = rebalance_node(n);
+                if (sub->height == old_height)
+                    return;
+                n = sub->parent;
             }
-            header_->left = min_node(r);
-            header_->right = max_node(r);
         }
 
         /**
@@ -1230,19 +1690,33 @@ namespace test_forest
         template <class U>
         std::pair<iterator, bool> insert_impl(U &&value)
         {
-            node *r = root();
+            return insert_from(root(), std::forward<U>(value));
+        }
 
-            if (!r)
+        /**
+         * @brief 从 start 开始向下查找插入位置；start 须为根或其子树覆盖 value 的节点
+         *        descend from start to the insertion point; start must be the root or a node
+         *        whose subtree range covers value
+         *
+         * @param start 下降起点（空树时为空）/ starting node (null for an empty tree)
+         * @param value 要插入的值 / value to insert
+         * @return pair(迭代器, 是否插入成功) / pair(iterator, inserted ?)
+         */
+        template <class U>
+        std::pair<iterator, bool> insert_from(node *start, U &&value)
+        {
+            if (!start)
             {
                 node *n = create_node(std::forward<U>(value));
                 set_root(n);
                 header_->left = n;
                 header_->right = n;
                 size_ = 1;
+                finger_ = n;
                 return {iterator(n), true};
             }
 
-            node *cur = r;
+            node *cur = start;
             node *parent = header_;
             bool left_child = false;
 
@@ -1261,18 +1735,30 @@ namespace test_forest
                 }
                 else
                 {
+                    finger_ = cur;
                     return {iterator(cur), false};
                 }
             }
 
+            return {attach_leaf(parent, left_child, std::forward<U>(value)), true};
+        }
+
+        /**
+         * @brief 把新值挂为 parent 的空子位置并回溯 / hang the new value on an empty child slot
+         *        of parent and retrace
+         *
+         * @param parent     父节点 / parent node
+         * @param left_child 是否挂为左子 / whether to attach as the left child
+         * @param value      要插入的值 / value to insert
+         * @return 指向新节点的迭代器 / iterator to the new node
+         */
+        template <class U>
+        iterator attach_leaf(node *parent, bool left_child, U &&value)
+        {
             node *n = create_node(std::forward<U>(value));
             n->parent = parent;
 
-            if (parent == header_)
-            {
-                set_root(n);
-            }
-            else if (left_child)
+            if (left_child)
             {
                 parent->left = n;
             }
@@ -1282,14 +1768,174 @@ namespace test_forest
             }
 
             ++size_;
-            if (header_->left == header_ || comp_(n->value, header_->left->value))
+            // 子树大小须一直更新到根，不受回溯提前停止影响
+            // subtree sizes must be bumped all the way to the root, regardless of the early-stop retrace
+            if constexpr (OrderStatistics)
+            {
+                for (node *p = parent; p != header_; p = p->parent)
+                    ++p->count;
+            }
+            // 挂在最小（最大）节点左（右）侧的新节点即新的最小（最大）值
+            // a new left (right) child of the minimum (maximum) is the new minimum (maximum)
+            if (left_child && parent == header_->left)
                 header_->left = n;
-            if (header_->right == header_ || comp_(header_->right->value, n->value))
+            else if (!left_child && parent == header_->right)
                 header_->right = n;
 
-            rebalance_from(parent);
+            finger_ = n;
+            retrace_insert(parent);
+
+            return iterator(n);
+        }
+
+        /**
+         * @brief 手指查找插入：从 f 向上爬到子树范围覆盖 value 的最低祖先，再向下查找
+         *        finger-search insertion: climb from f to the lowest ancestor whose subtree range
+         *        covers value, then descend
+         *
+         * @param f     手指节点，header 表示最大值 / finger node, header meaning the maximum
+         * @param value 要插入的值 / value to insert
+         * @return pair(迭代器, 是否插入成功) / pair(iterator, inserted ?)
+         *
+         * @note
+         *  - 越过最大（最小）值时直接挂在其右（左）侧，O(1) 加摊还 O(1) 回溯
+         *    beyond the maximum (minimum) the value is hung right (left) of it directly: O(1)
+         *    plus amortized O(1) retracing
+         *  - 否则爬升只在改变范围边界的那一侧比较，代价 O(log d)，d 为到手指的距离
+         *    otherwise the climb only compares at links that move the relevant range bound,
+         *    costing O(log d) for distance d from the finger
+         */
+        template <class U>
+        std::pair<iterator, bool> insert_near(node *f, U &&value)
+        {
+            if (size_ == 0)
+                return insert_from(nullptr, std::forward<U>(value));
+            if (f == header_)
+                f = header_->right;
+
+            node *x = f;
+            if (comp_(f->value, value))
+            {
+                if (f == header_->right)
+                    return {attach_leaf(f, false, std::forward<U>(value)), true};
+                // 只有作为左孩子时上界才会改变 / the upper bound only changes across a left-child link
+                while (x->parent != header_)
+                {
+                    node *p = x->parent;
+                    if (x == p->left)
+                    {
+                        if (comp_(value, p->value))
+                            break;
+                        if (!comp_(p->value, value))
+                        {
+                            finger_ = p;
+                            return {iterator(p), false};
+                        }
+                    }
+                    x = p;
+                }
+            }
+            else if (comp_(value, f->value))
+            {
+                if (f == header_->left)
+                    return {attach_leaf(f, true, std::forward<U>(value)), true};
+                // 只有作为右孩子时下界才会改变 / the lower bound only changes across a right-child link
+                while (x->parent != header_)
+                {
+                    node *p = x->parent;
+                    if (x == p->right)
+                    {
+                        if (comp_(p->value, value))
+                            break;
+                        if (!comp_(value, p->value))
+                        {
+                            finger_ = p;
+                            return {iterator(p), false};
+                        }
+                    }
+                    x = p;
+                }
+            }
+            else
+            {
+                finger_ = f;
+                return {iterator(f), false};
+            }
+            return insert_from(x, std::forward<U>(value));
+        }
+
+        /**
+         * @brief 空树批量建树：把有序前缀（等价元素保留第一个）串成链，再按中位数递归建树
+         *        empty-tree bulk load: chain the sorted prefix (keeping the first of equivalent
+         *        elements) into a list, then build the tree by recursive median
+         *
+         * @return 第一个逆序元素的位置，全部有序时为 last / position of the first out-of-order
+         *         element, or last if the whole range is sorted
+         */
+        template <class InputIt>
+        InputIt bulk_load_prefix(InputIt first, InputIt last)
+        {
+            node *head = nullptr;
+            node *tail = nullptr;
+            size_type count = 0;
+            try
+            {
+                for (; first != last; ++first)
+                {
+                    if (tail)
+                    {
+                        if (comp_(*first, tail->value))
+                            break;
+                        if (!comp_(tail->value, *first))
+                            continue;
+                    }
+                    node *n = create_node(*first);
+                    (tail ? tail->right : head) = n;
+                    tail = n;
+                    ++count;
+                }
+            }
+            catch (...)
+            {
+                while (head)
+                {
+                    node *next = head->right;
+                    destroy_node(head);
+                    head = next;
+                }
+                throw;
+            }
 
-            return {iterator(n), true};
+            if (count != 0)
+            {
+                header_->left = head;
+                header_->right = tail;
+                set_root(build_from_list(head, count));
+                size_ = count;
+            }
+            return first;
+        }
+
+        /**
+         * @brief 按中序消费 right 链上的 n 个节点，建成高度平衡的子树并写好高度与父指针
+         *        consume n nodes of a right-linked list in order, building a height-balanced
+         *        subtree with heights and parent links set
+         *
+         * @param list 链表当前头，返回后指向未消费部分 / current list head, advanced past the
+         *             consumed nodes
+         * @param n    要消费的节点数 / number of nodes to consume
+         * @return 子树根 / subtree root
+         */
+        static node *build_from_list(node *&list, size_type n) noexcept
+        {
+            if (n == 0)
+                return nullptr;
+            size_type left_count = (n - 1) / 2;
+            node *l = build_from_list(list, left_count);
+            node *mid = list;
+            list = list->right;
+            node *r = build_from_list(list, n - 1 - left_count);
+            return link_node(l, mid, r);
         }
 
         /**
@@ -1326,6 +1972,14 @@ namespace test_forest
         {
             node *rebalance_start = nullptr;
 
+            // 删除前用中序前驱 / 后继更新 header 的最左和最右指针，节点本身不会被搬移
+            // update the header extremes from the in-order neighbours before unlinking;
+            // nodes are relinked, never moved, so the neighbours stay valid
+            if (header_->left == z)
+                header_->left = z->right ? min_node(z->right) : z->parent;
+            if (header_->right == z)
+                header_->right = z->left ? max_node(z->left) : z->parent;
+
             if (!z->left)
             {
                 rebalance_start = z->parent;
@@ -1356,22 +2010,352 @@ namespace test_forest
                 y->left = z->left;
                 if (y->left)
                     y->left->parent = y;
-                update_height(y);
+                // y 接替 z 的位置，先继承 z 的旧高度供回溯比较
+                // y takes z's place; inherit z's old height for the retrace comparison
+                y->height = z->height;
             }
 
-            if (header_->left == z)
-                header_->left = (size_ > 1 ? min_node(root()) : header_);
-            if (header_->right == z)
-                header_->right = (size_ > 1 ? max_node(root()) : header_);
-
+            if (finger_ == z)
+                finger_ = nullptr;
             destroy_node(z);
             --size_;
 
-            if (rebalance_start && rebalance_start != header_)
-                rebalance_from(rebalance_start);
+            if constexpr (OrderStatistics)
+            {
+                for (node *p = rebalance_start; p != header_; p = p->parent)
+                    p->count = 1 + subtree_count(p->left) + subtree_count(p->right);
+            }
+
+            retrace_erase(rebalance_start);
+        }
+
+        // ===================== join / split 内部实现 / Join & split internals =====================
+
+        /// @brief split_nodes 的结果：小于键、等于键（可空）、大于键三部分
+        ///        result of split_nodes: less-than part, equal node (may be null), greater part
+        struct split_result
+        {
+            node *left;
+            node *mid;
+            node *right;
+        };
+
+        /// @brief 子问题高度低于此值时不再派生线程 / subproblems shorter than this never fork
+        static constexpr int parallel_grain_height = 12;
+
+        /**
+         * @brief 摘下整棵树交给调用者，本树变为空 / detach the whole tree, leaving this tree empty
+         *
+         * @return 原根节点（parent 已置空）/ former root (parent cleared)
+         */
+        node *release_root() noexcept
+        {
+            node *r = root();
+            if (r)
+            {
+                r->parent = nullptr;
+                header_->parent = nullptr;
+                header_->left = header_;
+                header_->right = header_;
+            }
+            size_ = 0;
+            finger_ = nullptr;
+            return r;
+        }
+
+        /**
+         * @brief 接管以 r 为根的子树并重建 header 最左最右指针 / adopt the subtree rooted at r
+         *        and rebuild the header extremes
+         *
+         * @param r 子树根 / subtree root
+         * @param n 元素个数 / number of elements
+         */
+        void adopt_root(node *r, size_type n) noexcept
+        {
+            set_root(r);
+            header_->left = r ? min_node(r) : header_;
+            header_->right = r ? max_node(r) : header_;
+            size_ = n;
+            finger_ = nullptr;
+        }
+
+        /**
+         * @brief 以 k 连接 l 与 r 并重算高度（不做平衡）/ link l and r under k and recompute the
+         *        height (no balancing)
+         */
+        static node *link_node(node *l, node *k, node *r) noexcept
+        {
+            k->left = l;
+            k->right = r;
+            if (l)
+                l->parent = k;
+            if (r)
+                r->parent = k;
+            int hl = l ? l->height : 0;
+            int hr = r ? r->height : 0;
+            k->height = (hl > hr ? hl : hr) + 1;
+            if constexpr (OrderStatistics)
+                k->count = 1 + subtree_count(l) + subtree_count(r);
+            return k;
+        }
+
+        /// @brief 游离子树上的左旋 / left rotation on a detached subtree
+        static node *detached_rotate_left(node *x) noexcept
+        {
+            node *y = x->right;
+            return link_node(link_node(x->left, x, y->left), y, y->right);
+        }
+
+        /// @brief 游离子树上的右旋 / right rotation on a detached subtree
+        static node *detached_rotate_right(node *y) noexcept
+        {
+            node *x = y->left;
+            return link_node(x->left, x, link_node(x->right, y, y->right));
+        }
+
+        /**
+         * @brief 沿 l 的右脊下降到与 r 等高处连接（h(l) > h(r) + 1）/ descend l's right spine to
+         *        r's height and link there (h(l) > h(r) + 1)
+         */
+        static node *join_right(node *l, node *k, node *r) noexcept
+        {
+            node *ll = l->left;
+            node *c = l->right;
+            int hr = r ? r->height : 0;
+            int hll = ll ? ll->height : 0;
+            bool low = (c ? c->height : 0) <= hr + 1;
+            node *t = low ? link_node(c, k, r) : join_right(c, k, r);
+            if (t->height <= hll + 1)
+                return link_node(ll, l, t);
+            if (low)
+                t = detached_rotate_right(t);
+            return detached_rotate_left(link_node(ll, l, t));
+        }
+
+        /// @brief join_right 的镜像（h(r) > h(l) + 1）/ mirror of join_right (h(r) > h(l) + 1)
+        static node *join_left(node *l, node *k, node *r) noexcept
+        {
+            node *rr = r->right;
+            node *c = r->left;
+            int hl = l ? l->height : 0;
+            int hrr = rr ? rr->height : 0;
+            bool low = (c ? c->height : 0) <= hl + 1;
+            node *t = low ? link_node(l, k, c) : join_left(l, k, c);
+            if (t->height <= hrr + 1)
+                return link_node(t, r, rr);
+            if (low)
+                t = detached_rotate_left(t);
+            return detached_rotate_right(link_node(t, r, rr));
+        }
+
+        /**
+         * @brief AVL join：l < k < r，返回平衡的子树根 / AVL join of l < k < r, returning the
+         *        balanced subtree root
+         */
+        static node *join_nodes(node *l, node *k, node *r) noexcept
+        {
+            int hl = l ? l->height : 0;
+            int hr = r ? r->height : 0;
+            node *t;
+            if (hl > hr + 1)
+                t = join_right(l, k, r);
+            else if (hr > hl + 1)
+                t = join_left(l, k, r);
+            else
+                t = link_node(l, k, r);
+            t->parent = nullptr;
+            return t;
+        }
+
+        /// @brief 摘下子树最大节点，返回（剩余子树，最大节点）/ detach the maximum, returning
+        ///        (remaining subtree, maximum node)
+        static std::pair<node *, node *> split_last(node *t) noexcept
+        {
+            if (!t->right)
+            {
+                if (t->left)
+                    t->left->parent = nullptr;
+                return {t->left, t};
+            }
+            auto rest = split_last(t->right);
+            return {join_nodes(t->left, t, rest.first), rest.second};
+        }
+
+        /// @brief 无分隔键的拼接：l < r / join without a separating key: l < r
+        static node *join2_nodes(node *l, node *r) noexcept
+        {
+            if (!l)
+                return r;
+            auto last = split_last(l);
+            return join_nodes(last.first, last.second, r);
+        }
+
+        /**
+         * @brief 按 key 把子树切成三部分，O(log N) / split a subtree by key into three parts,
+         *        O(log N)
+         */
+        split_result split_nodes(node *t, const key_type &key) const
+        {
+            if (!t)
+                return {nullptr, nullptr, nullptr};
+            node *l = t->left;
+            node *r = t->right;
+            if (comp_(key, t->value))
+            {
+                split_result s = split_nodes(l, key);
+                return {s.left, s.mid, join_nodes(s.right, t, r)};
+            }
+            if (comp_(t->value, key))
+            {
+                split_result s = split_nodes(r, key);
+                return {join_nodes(l, t, s.left), s.mid, s.right};
+            }
+            if (l)
+                l->parent = nullptr;
+            if (r)
+                r->parent = nullptr;
+            return {l, t, r};
+        }
+
+        /**
+         * @brief 递归集合运算的签名：(a, b, 剩余派生深度, 已释放节点数) → 结果根
+         *        signature of a recursive set operation: (a, b, remaining fork depth,
+         *        freed-node counter) -> result root
+         */
+        using set_operation_fn = node *(avl_tree::*)(node *, node *, int, size_type &);
+
+        /**
+         * @brief 在 fork-join 下执行两侧递归：高度足够且仍有派生预算时，左半在新线程中运行
+         *        run the two recursive halves fork-join: the left half gets its own thread when
+         *        the subproblem is tall enough and fork budget remains
+         */
+        void fork_join(set_operation_fn op,
+                       node *a1, node *b1, node *&out1,
+                       node *a2, node *b2, node *&out2,
+                       int fork_depth, size_type &freed)
+        {
+            size_type freed1 = 0;
+            size_type freed2 = 0;
+            int ha = a1 ? a1->height : 0;
+            int hb = b1 ? b1->height : 0;
+            if (fork_depth > 0 && (ha > hb ? ha : hb) >= parallel_grain_height)
+            {
+                auto left_half = std::async(std::launch::async, [&]
+                                            { return (this->*op)(a1, b1, fork_depth - 1, freed1); });
+                out2 = (this->*op)(a2, b2, fork_depth - 1, freed2);
+                out1 = left_half.get();
+            }
             else
-                update_extreme();
+            {
+                out1 = (this->*op)(a1, b1, 0, freed1);
+                out2 = (this->*op)(a2, b2, 0, freed2);
+            }
+            freed += freed1 + freed2;
+        }
+
+        /// @brief 并集递归体 / union recursion
+        node *union_nodes(node *a, node *b, int fork_depth, size_type &freed)
+        {
+            if (!a)
+                return b;
+            if (!b)
+                return a;
+            split_result s = split_nodes(b, a->value);
+            if (s.mid)
+            {
+                destroy_node(s.mid);
+                ++freed;
+            }
+            node *l = nullptr;
+            node *r = nullptr;
+            fork_join(&avl_tree::union_nodes, a->left, s.left, l, a->right, s.right, r, fork_depth, freed);
+            return join_nodes(l, a, r);
         }
+
+        /// @brief 交集递归体 / intersection recursion
+        node *intersection_nodes(node *a, node *b, int fork_depth, size_type &freed)
+        {
+            if (!a || !b)
+            {
+                freed += count_and_destroy(a) + count_and_destroy(b);
+                return nullptr;
+            }
+            split_result s = split_nodes(b, a->value);
+            node *l = nullptr;
+            node *r = nullptr;
+            fork_join(&avl_tree::intersection_nodes, a->left, s.left, l, a->right, s.right, r, fork_depth, freed);
+            if (s.mid)
+            {
+                destroy_node(s.mid);
+                ++freed;
+                return join_nodes(l, a, r);
+            }
+            destroy_node(a);
+            ++freed;
+            return join2_nodes(l, r);
+        }
+
+        /// @brief 差集递归体 / difference recursion
+        node *difference_nodes(node *a, node *b, int fork_depth, size_type &freed)
+        {
+            if (!a || !b)
+            {
+                freed += count_and_destroy(b);
+                return a;
+            }
+            split_result s = split_nodes(a, b->value);
+            node *l = nullptr;
+            node *r = nullptr;
+            fork_join(&avl_tree::difference_nodes, s.left, b->left, l, s.right, b->right, r, fork_depth, freed);
+            destroy_node(b);
+            ++freed;
+            if (s.mid)
+            {
+                destroy_node(s.mid);
+                ++freed;
+            }
+            return join2_nodes(l, r);
+        }
+
+        /// @brief 销毁子树并返回节点数 / destroy a subtree and return its node count
+        size_type count_and_destroy(node *n) noexcept
+        {
+            if (!n)
+                return 0;
+            size_type c = 1 + count_and_destroy(n->left) + count_and_destroy(n->right);
+            destroy_node(n);
+            return c;
+        }
+
+        /**
+         * @brief 集合运算公共流程：取走两树节点、运行递归、按释放数推出结果大小
+         *        shared driver for set operations: take both trees' nodes, run the recursion
+         *        and derive the result size from the number of freed nodes
+         */
+        static avl_tree set_operation(avl_tree a, avl_tree b, unsigned max_threads, set_operation_fn op)
+        {
+            if constexpr (!node_traits::is_always_equal::value)
+            {
+                if (!(a.alloc_ == b.alloc_))
+                    throw std::invalid_argument("avl_tree: set operations require equal allocators");
+            }
+
+            int fork_depth = 0;
+            while ((1u << fork_depth) < max_threads && fork_depth < 16)
+                ++fork_depth;
+
+            avl_tree result(a.comp_, a.get_allocator());
+            size_type total = a.size_ + b.size_;
+            size_type freed = 0;
+            node *ra = a.release_root();
+            node *rb = b.release_root();
+            node *r = (result.*op)(ra, rb, fork_depth, freed);
+            if (r)
+                r->parent = nullptr;
+            result.adopt_root(r, total - freed);
+            return result;
+        }
+
     };
 
 } // namespace test_forest
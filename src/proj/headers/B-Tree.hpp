@@ -295,6 +295,33 @@ namespace test_forest
             traverse_in_order_impl(root_, std::forward<Func>(f));
         }
 
+        /**
+         * @brief 单个节点占用的字节数。Bytes occupied by one node.
+         * @return sizeof(Node)
+         */
+        [[nodiscard]] static constexpr size_type node_size() noexcept
+        {
+            return sizeof(Node);
+        }
+
+        /**
+         * @brief 当前节点个数（遍历整棵树，O(节点数)）。Current number of nodes (walks the tree, O(nodes)).
+         * @return 节点数 / number of nodes.
+         */
+        [[nodiscard]] size_type node_count() const noexcept
+        {
+            return count_nodes(root_);
+        }
+
+        /**
+         * @brief 节点占用的总字节数，每个节点是一次独立分配。Total bytes held by nodes; every node is one allocation.
+         * @return node_count() * node_size()
+         */
+        [[nodiscard]] size_type memory_usage() const noexcept
+        {
+            return node_count() * node_size();
+        }
+
         /**
          * @brief 获取比较器对象。Get the comparator object.
          * @return 当前使用的比较器 / current comparator.
@@ -332,6 +359,28 @@ namespace test_forest
             delete node;
         }
 
+        /**
+         * @brief 统计以 node 为根的子树节点数。Count nodes of the subtree rooted at node.
+         * @param node 子树根节点 / subtree root.
+         * @return 节点数 / number of nodes.
+         */
+        static size_type count_nodes(const Node *node) noexcept
+        {
+            if (!node)
+            {
+                return 0;
+            }
+            size_type total = 1;
+            if (!node->leaf)
+            {
+                for (std::size_t i = 0; i <= node->count; ++i)
+                {
+                    total += count_nodes(node->children[i]);
+                }
+            }
+            return total;
+        }
+
         /**
          * @brief 递归拷贝子树。Recursively clone a subtree.
          * @param node 要拷贝的子树根节点 / root of subtree to clone.
@@ -6,17 +6,56 @@
  * @brief 二叉搜索树容器（模板）声明与实现 / Binary search tree container (template) declaration & implementation.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 #include <type_traits>
+#include <vector>
 #include <functional>
 
 namespace test_forest
 {
 
+    /**
+     * @brief
+     *  缺省再平衡策略：从不重建，插入顺序决定树形。
+     *  Default rebalancing policy: never rebuild, tree shape follows insertion order.
+     */
+    struct no_rebalance_policy
+    {
+        /// @brief 0 表示关闭替罪羊重建 / 0 disables scapegoat rebuilding.
+        static constexpr unsigned alpha_percent = 0;
+    };
+
+    /**
+     * @brief
+     *  替罪羊树（scapegoat）再平衡策略：插入深度超过 h_α(N) = ⌊log_{1/α} N⌋ 时，
+     *  沿插入路径找到第一个 α-重量失衡的祖先并把其子树重建为完全平衡；
+     *  删除后若 N < α·max_N 则重建整棵树。不需要任何逐结点平衡字段。
+     *  Scapegoat rebalancing policy: when an insertion lands deeper than
+     *  h_α(N) = ⌊log_{1/α} N⌋, the first α-weight-unbalanced ancestor on the insertion
+     *  path is rebuilt into a perfectly balanced subtree; after erase, the whole tree is
+     *  rebuilt once N < α·max_N. No per-node balance field is needed.
+     *
+     * @tparam AlphaPercent
+     *  α×100，取值 (50, 100)；越小越平衡、重建越频繁。
+     *  α×100 in (50, 100); smaller means better balance but more frequent rebuilds.
+     */
+    template <unsigned AlphaPercent = 70>
+    struct scapegoat_policy
+    {
+        static_assert(AlphaPercent > 50 && AlphaPercent < 100,
+                      "scapegoat_policy: AlphaPercent must be in (50, 100)");
+
+        /// @brief α×100 / α×100.
+        static constexpr unsigned alpha_percent = AlphaPercent;
+    };
+
     /**
      * @brief
      *  二叉搜索树容器，类似 std::set，按 Compare 顺序存储唯一元素。
@@ -28,10 +67,14 @@ namespace test_forest
      *  比较器类型（缺省为 std::less<T>）/ comparator type (defaults to std::less<T>).
      * @tparam Allocator
      *  分配器类型（缺省为 std::allocator<T>）/ allocator type (defaults to std::allocator<T>).
+     * @tparam Rebalance
+     *  再平衡策略（缺省 no_rebalance_policy，可选 scapegoat_policy<>）。
+     *  rebalancing policy (defaults to no_rebalance_policy; scapegoat_policy<> is available).
      */
     template <class T,
               class Compare = std::less<T>,
-              class Allocator = std::allocator<T>>
+              class Allocator = std::allocator<T>,
+              class Rebalance = no_rebalance_policy>
     class BinaryTree
     {
     private:
@@ -85,6 +128,9 @@ namespace test_forest
         /// @brief 结点分配器 traits / allocator traits for node.
         using node_alloc_traits = std::allocator_traits<node_allocator_type>;
 
+        /// @brief 是否启用替罪羊重建 / whether scapegoat rebuilding is enabled.
+        static constexpr bool scapegoat_enabled = Rebalance::alpha_percent != 0;
+
     public:
         // ============================
         // 迭代器定义 / Iterator definition
@@ -220,7 +266,7 @@ namespace test_forest
 
             const_iterator &operator++() noexcept
             {
-                current_ = BinaryTree::next_node(current_);
+                current_ = BinaryTree::next_node(const_cast<node *>(current_));
                 return *this;
             }
 
@@ -243,7 +289,7 @@ namespace test_forest
                 }
                 else
                 {
-                    current_ = BinaryTree::prev_node(current_);
+                    current_ = BinaryTree::prev_node(const_cast<node *>(current_));
                 }
                 return *this;
             }
@@ -290,6 +336,9 @@ namespace test_forest
         BinaryTree()
             : root_(nullptr),
               size_(0),
+              max_size_(0),
+              rebalance_debt_(0),
+              auto_rebalance_ratio_(0.0),
               comp_(),
               alloc_(),
               node_alloc_(alloc_) {}
@@ -303,6 +352,9 @@ namespace test_forest
                             const Allocator &alloc = Allocator())
             : root_(nullptr),
               size_(0),
+              max_size_(0),
+              rebalance_debt_(0),
+              auto_rebalance_ratio_(0.0),
               comp_(comp),
               alloc_(alloc),
               node_alloc_(alloc_) {}
@@ -315,14 +367,18 @@ namespace test_forest
         explicit BinaryTree(const Allocator &alloc)
             : root_(nullptr),
               size_(0),
+              max_size_(0),
+              rebalance_debt_(0),
+              auto_rebalance_ratio_(0.0),
               comp_(),
               alloc_(alloc),
               node_alloc_(alloc_) {}
 
         /**
          * @brief
-         *  区间构造，从 [first, last) 插入所有元素。
-         *  Range constructor, inserts all elements from [first, last).
+         *  区间构造，从 [first, last) 插入所有元素；有序（或可排序的随机访问）输入 O(N) 建成平衡树。
+         *  Range constructor, inserts all elements from [first, last); sorted (or sortable
+         *  random-access) input is built into a balanced tree in O(N).
          *
          * @tparam InputIt
          *  输入迭代器类型 / input iterator type.
@@ -359,18 +415,16 @@ namespace test_forest
 
         /**
          * @brief
-         *  拷贝构造函数，深拷贝整个树。
-         *  Copy constructor, deep-copy the whole tree.
+         *  拷贝构造函数，按中序批量构建出完全平衡的副本，O(N)。
+         *  Copy constructor, bulk-builds a perfectly balanced copy from the in-order sequence, O(N).
          */
         BinaryTree(const BinaryTree &other)
             : BinaryTree(other.comp_,
                          std::allocator_traits<Allocator>::
                              select_on_container_copy_construction(other.alloc_))
         {
-            for (const auto &v : other)
-            {
-                insert(v);
-            }
+            auto_rebalance_ratio_ = other.auto_rebalance_ratio_;
+            insert(other.begin(), other.end());
         }
 
         /**
@@ -381,12 +435,17 @@ namespace test_forest
         BinaryTree(BinaryTree &&other) noexcept
             : root_(other.root_),
               size_(other.size_),
+              max_size_(other.max_size_),
+              rebalance_debt_(other.rebalance_debt_),
+              auto_rebalance_ratio_(other.auto_rebalance_ratio_),
               comp_(std::move(other.comp_)),
               alloc_(std::move(other.alloc_)),
               node_alloc_(std::move(other.node_alloc_))
         {
             other.root_ = nullptr;
             other.size_ = 0;
+            other.max_size_ = 0;
+            other.rebalance_debt_ = 0;
         }
 
         /**
@@ -454,9 +513,14 @@ namespace test_forest
             comp_ = std::move(other.comp_);
             root_ = other.root_;
             size_ = other.size_;
+            max_size_ = other.max_size_;
+            rebalance_debt_ = other.rebalance_debt_;
+            auto_rebalance_ratio_ = other.auto_rebalance_ratio_;
 
             other.root_ = nullptr;
             other.size_ = 0;
+            other.max_size_ = 0;
+            other.rebalance_debt_ = 0;
             return *this;
         }
 
@@ -496,6 +560,16 @@ namespace test_forest
             return size_;
         }
 
+        /**
+         * @brief
+         *  单个结点占用的字节数（不含分配器自身的簿记开销）。
+         *  Bytes occupied by a single node (excluding the allocator's own bookkeeping).
+         */
+        static constexpr size_type node_size() noexcept
+        {
+            return sizeof(node);
+        }
+
         /**
          * @brief
          *  清空整棵树。
@@ -506,6 +580,8 @@ namespace test_forest
             destroy_subtree(root_);
             root_ = nullptr;
             size_ = 0;
+            max_size_ = 0;
+            rebalance_debt_ = 0;
         }
 
         // ============================
@@ -580,11 +656,33 @@ namespace test_forest
         /**
          * @brief
          *  插入区间 [first, last) 的所有元素。
+         *  空树时走批量构建：有序输入（随机访问的无序输入先排序）按中位数递归建成完全平衡树，O(N)；
+         *  单遍输入在遇到第一个逆序元素前的有序前缀同样批量构建，其余逐个插入。
          *  Insert all elements from range [first, last).
+         *  On an empty tree this bulk-loads: sorted input (unsorted random-access input is sorted
+         *  first) is built into a perfectly balanced tree by recursive median in O(N); for other
+         *  iterators the sorted prefix up to the first out-of-order element is bulk-loaded and
+         *  the rest inserted one by one.
          */
         template <class InputIt>
         void insert(InputIt first, InputIt last)
         {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if (empty() && first != last)
+            {
+                if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>)
+                {
+                    if (!std::is_sorted(first, last, comp_))
+                    {
+                        std::vector<T> sorted(first, last);
+                        std::sort(sorted.begin(), sorted.end(), comp_);
+                        build_sorted_prefix(std::make_move_iterator(sorted.begin()),
+                                            std::make_move_iterator(sorted.end()));
+                        return;
+                    }
+                }
+                first = build_sorted_prefix(first, last);
+            }
             for (; first != last; ++first)
             {
                 insert(*first);
@@ -655,6 +753,59 @@ namespace test_forest
             return 1;
         }
 
+        /**
+         * @brief
+         *  Day–Stout–Warren 整树重平衡：先右旋压平成藤，再逐轮左旋压缩成完全平衡树。
+         *  O(N) 时间、O(1) 额外空间、不分配内存；迭代器保持有效。
+         *  Day–Stout–Warren rebalance: right-rotate the tree into a vine, then compress it
+         *  with rounds of left rotations into a perfectly balanced tree. O(N) time, O(1)
+         *  extra space, no allocation; iterators stay valid.
+         */
+        void rebalance() noexcept
+        {
+            if (size_ > 2)
+            {
+                root_ = tree_to_vine(root_);
+                vine_to_tree(root_, size_);
+                root_->parent = nullptr;
+            }
+            rebalance_debt_ = 0;
+        }
+
+        /**
+         * @brief
+         *  设置自动重平衡阈值：深度超过 ratio·log2(N+1) 的插入累计走过 N 步后自动调用 rebalance()，
+         *  重建代价因此被摊销。适合“批量加载后查询”的场景；单调插入流更适合 scapegoat_policy。
+         *  Set the auto-rebalance threshold: once insertions deeper than ratio·log2(N+1) have
+         *  walked N steps in total, rebalance() runs automatically, so the rebuild cost is
+         *  amortized. Suited to batch-load-then-query jobs; monotonic insertion streams are
+         *  better served by scapegoat_policy.
+         *
+         * @param ratio
+         *  阈值，0 表示关闭，否则须 >= 1 / threshold; 0 disables, otherwise must be >= 1.
+         *
+         * @throws std::invalid_argument
+         *  ratio 为负或位于 (0, 1) / ratio is negative or in (0, 1).
+         */
+        void set_auto_rebalance(double ratio)
+        {
+            if (ratio != 0.0 && !(ratio >= 1.0))
+            {
+                throw std::invalid_argument("BinaryTree: auto-rebalance ratio must be 0 or >= 1");
+            }
+            auto_rebalance_ratio_ = ratio;
+        }
+
+        /**
+         * @brief
+         *  当前自动重平衡阈值（0 表示关闭）。
+         *  Current auto-rebalance threshold (0 means disabled).
+         */
+        double auto_rebalance() const noexcept
+        {
+            return auto_rebalance_ratio_;
+        }
+
         /**
          * @brief
          *  与另一棵树交换内容。
@@ -667,6 +818,9 @@ namespace test_forest
             using std::swap;
             swap(root_, other.root_);
             swap(size_, other.size_);
+            swap(max_size_, other.max_size_);
+            swap(rebalance_debt_, other.rebalance_debt_);
+            swap(auto_rebalance_ratio_, other.auto_rebalance_ratio_);
             swap(comp_, other.comp_);
             if constexpr (node_alloc_traits::propagate_on_container_swap::value)
             {
@@ -741,6 +895,15 @@ namespace test_forest
         node *root_;
         /// @brief 元素个数 / number of elements.
         size_type size_;
+        /// @brief 上次整树重建以来的最大元素个数（仅替罪羊策略使用）
+        ///        / maximum size since the last full rebuild (scapegoat policy only).
+        size_type max_size_;
+        /// @brief 上次整树重平衡以来超阈值插入累计走过的深度
+        ///        / accumulated depth of over-threshold insertions since the last full rebalance.
+        size_type rebalance_debt_;
+        /// @brief 自动重平衡阈值 height / log2(N+1)，0 表示关闭
+        ///        / auto-rebalance threshold height / log2(N+1), 0 disables it.
+        double auto_rebalance_ratio_;
         /// @brief 比较器 / comparator.
         compare_type comp_;
         /// @brief 元素分配器 / allocator for values.
@@ -990,6 +1153,17 @@ namespace test_forest
             }
             destroy_node(z);
             --size_;
+
+            if constexpr (scapegoat_enabled)
+            {
+                // N < α·max_N：整树重建 / N < α·max_N: rebuild the whole tree
+                if (size_ * 100 < Rebalance::alpha_percent * max_size_)
+                {
+                    node *vine = tree_to_vine(root_);
+                    root_ = build_from_vine(vine, size_, nullptr);
+                    max_size_ = size_;
+                }
+            }
         }
 
         /**
@@ -1010,9 +1184,11 @@ namespace test_forest
 
             node *parent = nullptr;
             node *cur = root_;
+            size_type depth = 0;
             while (cur)
             {
                 parent = cur;
+                ++depth;
                 if (comp_(value, cur->value))
                 {
                     cur = cur->left;
@@ -1038,9 +1214,285 @@ namespace test_forest
                 parent->right = n;
             }
             ++size_;
+
+            if constexpr (scapegoat_enabled)
+            {
+                if (size_ > max_size_)
+                {
+                    max_size_ = size_;
+                }
+                if (depth > alpha_height(size_))
+                {
+                    rebuild_scapegoat(n);
+                }
+            }
+
+            // 超阈值的插入把多走的路径记为“债”，债达到 N 时整树重平衡，O(N) 的重建被已付出的下降代价摊销
+            // over-threshold insertions accrue their path length as debt; once the debt reaches N the
+            // whole tree is rebalanced, so the O(N) rebuild is paid for by descent work already spent
+            if (auto_rebalance_ratio_ != 0.0 &&
+                static_cast<double>(depth + 1) >
+                    auto_rebalance_ratio_ * std::log2(static_cast<double>(size_ + 1)))
+            {
+                rebalance_debt_ += depth;
+                if (rebalance_debt_ >= size_)
+                {
+                    rebalance();
+                }
+            }
             return {iterator(n, this), true};
         }
 
+        // ============================
+        // 替罪羊重建 / Scapegoat rebuilding
+        // ============================
+
+        /**
+         * @brief
+         *  h_α(n) = ⌊log_{1/α} n⌋：α-高度平衡树允许的最大深度。
+         *  h_α(n) = ⌊log_{1/α} n⌋: maximum depth allowed in an α-height-balanced tree.
+         */
+        static size_type alpha_height(size_type n) noexcept
+        {
+            static const double inv_log =
+                1.0 / std::log(100.0 / static_cast<double>(Rebalance::alpha_percent));
+            return static_cast<size_type>(std::log(static_cast<double>(n)) * inv_log);
+        }
+
+        /**
+         * @brief
+         *  统计子树结点数（仅在寻找替罪羊时调用，摊还 O(1)）。
+         *  Count nodes of a subtree (only called while searching a scapegoat, amortized O(1)).
+         */
+        static size_type subtree_size(const node *n) noexcept
+        {
+            size_type count = 0;
+            while (n)
+            {
+                count += 1 + subtree_size(n->right);
+                n = n->left;
+            }
+            return count;
+        }
+
+        /**
+         * @brief
+         *  从过深的新结点 x 向上寻找第一个满足 size(child) > α·size(p) 的祖先 p，
+         *  并把以 p 为根的子树重建为完全平衡。
+         *  Walk up from the too-deep new node x to the first ancestor p with
+         *  size(child) > α·size(p) and rebuild the subtree rooted at p into perfect balance.
+         */
+        void rebuild_scapegoat(node *x) noexcept
+        {
+            size_type child_size = 1;
+            node *child = x;
+            node *p = x->parent;
+            while (p)
+            {
+                const node *sibling = (child == p->left) ? p->right : p->left;
+                size_type total = child_size + 1 + subtree_size(sibling);
+                if (child_size * 100 > Rebalance::alpha_percent * total)
+                {
+                    node *pp = p->parent;
+                    node *vine = tree_to_vine(p);
+                    node *rebuilt = build_from_vine(vine, total, pp);
+                    if (!pp)
+                    {
+                        root_ = rebuilt;
+                    }
+                    else if (pp->left == p)
+                    {
+                        pp->left = rebuilt;
+                    }
+                    else
+                    {
+                        pp->right = rebuilt;
+                    }
+                    return;
+                }
+                child_size = total;
+                child = p;
+                p = p->parent;
+            }
+        }
+
+        /**
+         * @brief
+         *  通过右旋把子树压平成沿 right 链接的有序“藤”（vine），O(n) 时间、O(1) 额外空间。
+         *  Flatten a subtree into a sorted vine linked through `right` using right rotations,
+         *  O(n) time and O(1) extra space.
+         *
+         * @return
+         *  藤的头结点（最小元素）/ head of the vine (smallest element).
+         */
+        static node *tree_to_vine(node *root) noexcept
+        {
+            node *head = nullptr;
+            node *tail = nullptr;
+            node **link = &head;
+            node *rest = root;
+            while (rest)
+            {
+                if (rest->left)
+                {
+                    // 右旋 rest / rotate rest to the right
+                    node *l = rest->left;
+                    rest->left = l->right;
+                    l->right = rest;
+                    rest = l;
+                }
+                else
+                {
+                    *link = rest;
+                    rest->parent = tail;
+                    tail = rest;
+                    link = &rest->right;
+                    rest = rest->right;
+                }
+            }
+            return head;
+        }
+
+        /**
+         * @brief
+         *  DSW 压缩：沿藤（或上一轮的右脊）做 count 次左旋，同时维护 parent 指针。
+         *  DSW compression: perform count left rotations along the vine (or the previous
+         *  round's right spine), maintaining parent pointers.
+         */
+        static void compress(node *&head, size_type count) noexcept
+        {
+            node **link = &head;
+            node *scanner = nullptr;
+            for (size_type i = 0; i < count; ++i)
+            {
+                node *child = *link;
+                node *next = child->right;
+                *link = next;
+                next->parent = scanner;
+                child->right = next->left;
+                if (child->right)
+                {
+                    child->right->parent = child;
+                }
+                next->left = child;
+                child->parent = next;
+                scanner = next;
+                link = &next->right;
+            }
+        }
+
+        /**
+         * @brief
+         *  把 n 个结点的藤原地压缩为完全平衡树：先把多出的叶子压下去，再逐轮减半。
+         *  Compress an n-node vine in place into a perfectly balanced tree: first push down
+         *  the surplus leaves, then halve round by round.
+         */
+        static void vine_to_tree(node *&head, size_type n) noexcept
+        {
+            size_type full = 1;
+            while (full <= n + 1)
+            {
+                full <<= 1;
+            }
+            full = (full >> 1) - 1; // 2^⌊log2(n+1)⌋ - 1
+            compress(head, n - full);
+            while (full > 1)
+            {
+                full >>= 1;
+                compress(head, full);
+            }
+        }
+
+        /**
+         * @brief
+         *  空树批量构建：把 [first, last) 的有序前缀（等价元素只保留第一个）串成藤，
+         *  再按中位数递归建成完全平衡树。
+         *  Empty-tree bulk load: chain the sorted prefix of [first, last) (keeping only the first
+         *  of equivalent elements) into a vine, then build a perfectly balanced tree from it by
+         *  recursive median.
+         *
+         * @return
+         *  第一个逆序元素的位置，全部有序时为 last / position of the first out-of-order element,
+         *  or last if the whole range is sorted.
+         */
+        template <class InputIt>
+        InputIt build_sorted_prefix(InputIt first, InputIt last)
+        {
+            node *head = nullptr;
+            node *tail = nullptr;
+            size_type count = 0;
+            try
+            {
+                for (; first != last; ++first)
+                {
+                    if (tail)
+                    {
+                        if (comp_(*first, tail->value))
+                        {
+                            break;
+                        }
+                        if (!comp_(tail->value, *first))
+                        {
+                            continue;
+                        }
+                    }
+                    node *n = create_node(*first, nullptr);
+                    (tail ? tail->right : head) = n;
+                    tail = n;
+                    ++count;
+                }
+            }
+            catch (...)
+            {
+                while (head)
+                {
+                    node *next = head->right;
+                    destroy_node(head);
+                    head = next;
+                }
+                throw;
+            }
+
+            root_ = build_from_vine(head, count, nullptr);
+            size_ = count;
+            max_size_ = count;
+            rebalance_debt_ = 0;
+            return first;
+        }
+
+        /**
+         * @brief
+         *  按中序消费藤上的 n 个结点，构造完全平衡子树并修正 parent 指针。
+         *  Consume n nodes of the vine in order, build a perfectly balanced subtree and fix
+         *  parent pointers.
+         *
+         * @param vine
+         *  藤的当前头结点，返回后指向未消费部分 / current vine head, advanced past consumed nodes.
+         * @param n
+         *  要消费的结点数 / number of nodes to consume.
+         * @param parent
+         *  新子树根的父结点 / parent of the new subtree root.
+         */
+        static node *build_from_vine(node *&vine, size_type n, node *parent) noexcept
+        {
+            if (n == 0)
+            {
+                return nullptr;
+            }
+            size_type left_count = (n - 1) / 2;
+            node *left = build_from_vine(vine, left_count, nullptr);
+            node *mid = vine;
+            vine = vine->right;
+            mid->parent = parent;
+            mid->left = left;
+            if (left)
+            {
+                left->parent = mid;
+            }
+            mid->right = build_from_vine(vine, n - 1 - left_count, mid);
+            return mid;
+        }
+
         /**
          * @brief
          *  供拷贝赋值内部使用的辅助构造函数。
@@ -1051,10 +1503,8 @@ namespace test_forest
                    const Allocator &alloc)
             : BinaryTree(comp, alloc)
         {
-            for (const auto &v : other)
-            {
-                insert(v);
-            }
+            auto_rebalance_ratio_ = other.auto_rebalance_ratio_;
+            insert(other.begin(), other.end());
         }
     };
 
@@ -0,0 +1,1059 @@
+#ifndef _COMPACT_BINARY_TREE_HPP
+#define _COMPACT_BINARY_TREE_HPP
+
+/**
+ * @file Compact-Binary-Tree.hpp
+ * @brief 以 32 位下标链接、结点连续存放的二叉搜索树（模板）/ Binary search tree with contiguous nodes linked by 32-bit indices (template).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <vector>
+
+namespace test_forest
+{
+
+    /**
+     * @brief
+     *  紧凑二叉搜索树：接口与 BinaryTree 一致，但所有结点存放在一个连续的结点池
+     *  （std::vector）中，left/right/parent 以 32 位下标代替 8 字节指针。
+     *  BinaryTree<int> 的结点从 32 字节降为 16 字节，且整棵树可按字节搬移/快照。
+     *  Compact binary search tree with the BinaryTree interface, but every node lives in
+     *  one contiguous pool (std::vector) and left/right/parent are 32-bit indices instead
+     *  of 8-byte pointers. An int node shrinks from 32 to 16 bytes and the whole tree can
+     *  be relocated or snapshotted as plain bytes.
+     *
+     * @tparam T
+     *  元素类型 / element type.
+     * @tparam Compare
+     *  比较器类型（缺省为 std::less<T>）/ comparator type (defaults to std::less<T>).
+     * @tparam Allocator
+     *  分配器类型（缺省为 std::allocator<T>），重绑定到结点池 / allocator type (defaults
+     *  to std::allocator<T>), rebound for the node pool.
+     *
+     * @note
+     *  被删除的槽位立即析构其值、进入空闲链表，并在下次插入时原地构造新值复用；
+     *  迭代器保存下标，结点池扩容不会使其失效。
+     *  Erasing destroys the slot's value at once and puts the slot on a free list; later
+     *  insertions construct a new value in place to reuse it. Iterators hold indices, so
+     *  growing the pool does not invalidate them.
+     */
+    template <class T,
+              class Compare = std::less<T>,
+              class Allocator = std::allocator<T>>
+    class CompactBinaryTree
+    {
+    public:
+        /// @brief 结点下标类型 / node index type.
+        using index_type = std::uint32_t;
+
+    private:
+        /// @brief 空下标（相当于 nullptr）/ null index (the nullptr equivalent).
+        static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+        /// @brief 空闲槽的 parent 标记，槽内没有活对象 / parent mark of a free slot, which holds no live value.
+        static constexpr index_type free_mark = npos - 1;
+
+        // ============================
+        // 内部结点结构 / Internal node
+        // ============================
+
+        /**
+         * @brief
+         *  平凡类型的结点：值直接存放，结点池可按字节搬移。
+         *  Node for trivial types: the value is stored directly and the pool moves as plain bytes.
+         */
+        struct trivial_node
+        {
+            /// @brief 存储的值 / stored value.
+            T value;
+            /// @brief 左子结点下标 / left child index.
+            index_type left;
+            /// @brief 右子结点下标 / right child index.
+            index_type right;
+            /// @brief 父结点下标 / parent index.
+            index_type parent;
+
+            /// @brief 构造函数 / constructor.
+            trivial_node(const T &v, index_type p)
+                : value(v), left(npos), right(npos), parent(p) {}
+
+            /// @brief 移动构造函数 / move constructor.
+            trivial_node(T &&v, index_type p)
+                : value(std::move(v)), left(npos), right(npos), parent(p) {}
+        };
+
+        /**
+         * @brief
+         *  非平凡类型的结点：值放在匿名联合里，空闲槽（parent == free_mark）不含活对象，
+         *  拷贝、移动与析构只处理在用的槽。
+         *  Node for non-trivial types: the value lives in an anonymous union and a free slot
+         *  (parent == free_mark) holds no live object; copy, move and destruction only touch
+         *  slots in use.
+         */
+        struct managed_node
+        {
+            union
+            {
+                /// @brief 存储的值（仅在用的槽）/ stored value (slots in use only).
+                T value;
+            };
+            /// @brief 左子结点下标 / left child index.
+            index_type left;
+            /// @brief 右子结点下标 / right child index.
+            index_type right;
+            /// @brief 父结点下标 / parent index.
+            index_type parent;
+
+            /// @brief 构造函数 / constructor.
+            managed_node(const T &v, index_type p)
+                : value(v), left(npos), right(npos), parent(p) {}
+
+            /// @brief 移动构造函数 / move constructor.
+            managed_node(T &&v, index_type p)
+                : value(std::move(v)), left(npos), right(npos), parent(p) {}
+
+            /// @brief 拷贝结点（结点池拷贝用）/ copy a node (for pool copies).
+            managed_node(const managed_node &other)
+                : left(other.left), right(other.right), parent(other.parent)
+            {
+                if (parent != free_mark)
+                    ::new (static_cast<void *>(std::addressof(value))) T(other.value);
+            }
+
+            /// @brief 移动结点（结点池扩容用）/ move a node (for pool growth).
+            managed_node(managed_node &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+                : left(other.left), right(other.right), parent(other.parent)
+            {
+                if (parent != free_mark)
+                    ::new (static_cast<void *>(std::addressof(value))) T(std::move(other.value));
+            }
+
+            managed_node &operator=(const managed_node &) = delete;
+            managed_node &operator=(managed_node &&) = delete;
+
+            ~managed_node()
+            {
+                if (parent != free_mark)
+                    value.~T();
+            }
+        };
+
+        /// @brief 结点类型 / node type.
+        using node = std::conditional_t<std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                                        trivial_node, managed_node>;
+
+    public:
+        // ============================
+        // 公共类型别名 / Public type aliases
+        // ============================
+        /// @brief 值类型 / value type.
+        using value_type = T;
+        /// @brief 比较器类型 / comparator type.
+        using compare_type = Compare;
+        /// @brief 分配器类型 / allocator type.
+        using allocator_type = Allocator;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+        /// @brief 差值类型 / difference type.
+        using difference_type = std::ptrdiff_t;
+        /// @brief 引用类型 / reference type.
+        using reference = value_type &;
+        /// @brief 常量引用类型 / const reference type.
+        using const_reference = const value_type &;
+
+    private:
+        /// @brief 结点池分配器类型 / allocator type for the node pool.
+        using node_allocator_type =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+
+        /// @brief 结点池类型 / node pool type.
+        using pool_type = std::vector<node, node_allocator_type>;
+
+    public:
+        // ============================
+        // 迭代器定义 / Iterator definition
+        // ============================
+
+        /**
+         * @brief
+         *  双向迭代器，按中序遍历访问元素（保存下标而非指针）。
+         *  Bidirectional in-order iterator (holds an index rather than a pointer).
+         */
+        class iterator
+        {
+        public:
+            /// @brief 迭代器类别 / iterator category.
+            using iterator_category = std::bidirectional_iterator_tag;
+            /// @brief 值类型 / value type.
+            using value_type = T;
+            /// @brief 差值类型 / difference type.
+            using difference_type = std::ptrdiff_t;
+            /// @brief 指针类型 / pointer type.
+            using pointer = T *;
+            /// @brief 引用类型 / reference type.
+            using reference = T &;
+
+            /// @brief 默认构造，指向空 / default constructor, points to null.
+            iterator() noexcept : current_(npos), owner_(nullptr) {}
+
+            /// @brief 解引用 / dereference.
+            reference operator*() const noexcept
+            {
+                return owner_->nodes_[current_].value;
+            }
+
+            /// @brief 指针访问 / pointer access.
+            pointer operator->() const noexcept
+            {
+                return &owner_->nodes_[current_].value;
+            }
+
+            /// @brief 前置++，移动到下一个元素 / pre-increment, move to next element.
+            iterator &operator++() noexcept
+            {
+                current_ = owner_->next_node(current_);
+                return *this;
+            }
+
+            /// @brief 后置++ / post-increment.
+            iterator operator++(int) noexcept
+            {
+                iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            /// @brief 前置--，移动到前一个元素；若当前为 end()，则跳到最大元素。
+            ///        pre-decrement, move to previous element; if at end(), jumps to maximum element.
+            iterator &operator--() noexcept
+            {
+                if (!owner_)
+                {
+                    return *this;
+                }
+                if (current_ == npos)
+                { // end() -> 最大元素 / end() -> max element
+                    current_ = owner_->maximum(owner_->root_);
+                }
+                else
+                {
+                    current_ = owner_->prev_node(current_);
+                }
+                return *this;
+            }
+
+            /// @brief 后置-- / post-decrement.
+            iterator operator--(int) noexcept
+            {
+                iterator tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            /// @brief 相等比较 / equality comparison.
+            friend bool operator==(const iterator &a, const iterator &b) noexcept
+            {
+                return a.current_ == b.current_;
+            }
+
+            /// @brief 不等比较 / inequality comparison.
+            friend bool operator!=(const iterator &a, const iterator &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            index_type current_;
+            CompactBinaryTree *owner_;
+
+            explicit iterator(index_type n, CompactBinaryTree *owner) noexcept
+                : current_(n), owner_(owner) {}
+
+            friend class CompactBinaryTree;
+            friend class const_iterator;
+        };
+
+        /**
+         * @brief
+         *  常量双向迭代器 / const bidirectional iterator.
+         */
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() noexcept : current_(npos), owner_(nullptr) {}
+
+            /// @brief 从非常量迭代器构造 / construct from non-const iterator.
+            const_iterator(const iterator &it) noexcept
+                : current_(it.current_), owner_(it.owner_) {}
+
+            reference operator*() const noexcept
+            {
+                return owner_->nodes_[current_].value;
+            }
+
+            pointer operator->() const noexcept
+            {
+                return &owner_->nodes_[current_].value;
+            }
+
+            const_iterator &operator++() noexcept
+            {
+                current_ = owner_->next_node(current_);
+                return *this;
+            }
+
+            const_iterator operator++(int) noexcept
+            {
+                const_iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            const_iterator &operator--() noexcept
+            {
+                if (!owner_)
+                {
+                    return *this;
+                }
+                if (current_ == npos)
+                {
+                    current_ = owner_->maximum(owner_->root_);
+                }
+                else
+                {
+                    current_ = owner_->prev_node(current_);
+                }
+                return *this;
+            }
+
+            const_iterator operator--(int) noexcept
+            {
+                const_iterator tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator &a,
+                                   const const_iterator &b) noexcept
+            {
+                return a.current_ == b.current_;
+            }
+
+            friend bool operator!=(const const_iterator &a,
+                                   const const_iterator &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            index_type current_;
+            const CompactBinaryTree *owner_;
+
+            explicit const_iterator(index_type n, const CompactBinaryTree *owner) noexcept
+                : current_(n), owner_(owner) {}
+
+            friend class CompactBinaryTree;
+        };
+
+        // ============================
+        // 构造 / 析构 / 赋值
+        // Constructors / destructor / assignment
+        // ============================
+
+        /**
+         * @brief
+         *  默认构造，使用缺省比较器和分配器。
+         *  Default constructor using default comparator and allocator.
+         */
+        CompactBinaryTree()
+            : CompactBinaryTree(Compare()) {}
+
+        /**
+         * @brief
+         *  使用指定比较器和分配器构造。
+         *  Construct with specific comparator and allocator.
+         */
+        explicit CompactBinaryTree(const Compare &comp,
+                                   const Allocator &alloc = Allocator())
+            : nodes_(node_allocator_type(alloc)),
+              root_(npos),
+              free_head_(npos),
+              size_(0),
+              comp_(comp),
+              alloc_(alloc) {}
+
+        /**
+         * @brief
+         *  仅指定分配器构造，比较器使用缺省。
+         *  Construct with allocator only, comparator is default constructed.
+         */
+        explicit CompactBinaryTree(const Allocator &alloc)
+            : CompactBinaryTree(Compare(), alloc) {}
+
+        /**
+         * @brief
+         *  区间构造，从 [first, last) 插入所有元素。
+         *  Range constructor, inserts all elements from [first, last).
+         */
+        template <class InputIt>
+        CompactBinaryTree(InputIt first, InputIt last,
+                          const Compare &comp = Compare(),
+                          const Allocator &alloc = Allocator())
+            : CompactBinaryTree(comp, alloc)
+        {
+            insert(first, last);
+        }
+
+        /**
+         * @brief
+         *  使用初始化列表构造。
+         *  Construct from initializer list.
+         */
+        CompactBinaryTree(std::initializer_list<T> init,
+                          const Compare &comp = Compare(),
+                          const Allocator &alloc = Allocator())
+            : CompactBinaryTree(comp, alloc)
+        {
+            insert(init);
+        }
+
+        /**
+         * @brief
+         *  拷贝构造：下标与位置无关，直接整体复制结点池即得到同形状的树；
+         *  分配器取自副本结点池，与其实际使用的保持一致。
+         *  Copy constructor: indices are position independent, so copying the pool as a
+         *  whole yields a tree of identical shape; the allocator is taken from the copied
+         *  pool so it matches the one the pool actually uses.
+         */
+        CompactBinaryTree(const CompactBinaryTree &other)
+            : nodes_(other.nodes_),
+              root_(other.root_),
+              free_head_(other.free_head_),
+              size_(other.size_),
+              comp_(other.comp_),
+              alloc_(nodes_.get_allocator()) {}
+
+        /// @brief 移动构造 / move constructor.
+        CompactBinaryTree(CompactBinaryTree &&other) noexcept
+            : nodes_(std::move(other.nodes_)),
+              root_(other.root_),
+              free_head_(other.free_head_),
+              size_(other.size_),
+              comp_(std::move(other.comp_)),
+              alloc_(std::move(other.alloc_))
+        {
+            other.nodes_.clear();
+            other.root_ = npos;
+            other.free_head_ = npos;
+            other.size_ = 0;
+        }
+
+        /// @brief 拷贝赋值 / copy assignment.
+        CompactBinaryTree &operator=(const CompactBinaryTree &other)
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+            CompactBinaryTree tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+        /// @brief 移动赋值 / move assignment.
+        CompactBinaryTree &operator=(CompactBinaryTree &&other) noexcept
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+            CompactBinaryTree tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+
+        /// @brief 析构函数 / destructor.
+        ~CompactBinaryTree() = default;
+
+        // ============================
+        // 容量 / Capacity
+        // ============================
+
+        /**
+         * @brief
+         *  是否为空。
+         *  Check if container is empty.
+         */
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        /**
+         * @brief
+         *  返回元素个数。
+         *  Get number of elements.
+         */
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        /**
+         * @brief
+         *  单个结点占用的字节数。
+         *  Bytes occupied by a single node.
+         */
+        static constexpr size_type node_size() noexcept
+        {
+            return sizeof(node);
+        }
+
+        /**
+         * @brief
+         *  结点池当前占用的字节数（按容量计，含空闲槽位）。
+         *  Bytes currently held by the node pool (by capacity, free slots included).
+         */
+        size_type memory_usage() const noexcept
+        {
+            return nodes_.capacity() * sizeof(node);
+        }
+
+        /**
+         * @brief
+         *  为 n 个结点预留结点池容量。
+         *  Reserve node-pool capacity for n nodes.
+         */
+        void reserve(size_type n)
+        {
+            nodes_.reserve(n);
+        }
+
+        /**
+         * @brief
+         *  清空整棵树并释放结点池中的所有元素。
+         *  Clear the whole tree and drop every element of the node pool.
+         */
+        void clear() noexcept
+        {
+            nodes_.clear();
+            root_ = npos;
+            free_head_ = npos;
+            size_ = 0;
+        }
+
+        // ============================
+        // 迭代器 / Iterators
+        // ============================
+
+        /// @brief 返回指向第一个元素的迭代器 / return iterator to first element.
+        iterator begin() noexcept
+        {
+            return iterator(minimum(root_), this);
+        }
+
+        /// @brief 返回指向第一个元素的常量迭代器 / return const iterator to first element.
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(minimum(root_), this);
+        }
+
+        /// @brief 返回指向第一个元素的常量迭代器 / return const iterator to first element.
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        /// @brief 返回尾后迭代器 / return iterator past the last element.
+        iterator end() noexcept
+        {
+            return iterator(npos, this);
+        }
+
+        /// @brief 返回尾后常量迭代器 / return const iterator past the last element.
+        const_iterator end() const noexcept
+        {
+            return const_iterator(npos, this);
+        }
+
+        /// @brief 返回尾后常量迭代器 / return const iterator past the last element.
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        // ============================
+        // 修改器 / Modifiers
+        // ============================
+
+        /**
+         * @brief
+         *  插入一个值（拷贝），若已存在则不插入。
+         *  Insert a value (copy). If already exists, no insertion.
+         *
+         * @return
+         *  pair(迭代器, 是否插入成功) / pair(iterator, bool inserted).
+         *
+         * @throws std::length_error
+         *  结点数超过 32 位下标可表示范围 / node count exceeds the 32-bit index range.
+         */
+        std::pair<iterator, bool> insert(const T &value)
+        {
+            return emplace_internal(value);
+        }
+
+        /**
+         * @brief
+         *  插入一个值（移动），若已存在则不插入。
+         *  Insert a value (move). If already exists, no insertion.
+         */
+        std::pair<iterator, bool> insert(T &&value)
+        {
+            return emplace_internal(std::move(value));
+        }
+
+        /**
+         * @brief
+         *  插入区间 [first, last) 的所有元素。
+         *  Insert all elements from range [first, last).
+         */
+        template <class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+            {
+                insert(*first);
+            }
+        }
+
+        /**
+         * @brief
+         *  插入初始化列表中所有元素。
+         *  Insert all elements from initializer list.
+         */
+        void insert(std::initializer_list<T> init)
+        {
+            insert(init.begin(), init.end());
+        }
+
+        /**
+         * @brief
+         *  删除指定位置的元素，返回指向后一个元素的迭代器。
+         *  Erase element at given position, returns iterator to next element.
+         */
+        iterator erase(iterator pos)
+        {
+            if (pos.current_ == npos)
+            {
+                return end();
+            }
+            index_type n = pos.current_;
+            iterator next_it = ++pos;
+            erase_node(n);
+            return next_it;
+        }
+
+        /**
+         * @brief
+         *  删除指定位置的元素（const 版本）。
+         *  Erase element at given position (const version).
+         */
+        iterator erase(const_iterator pos)
+        {
+            return erase(iterator(pos.current_, this));
+        }
+
+        /**
+         * @brief
+         *  删除等于 key 的元素（此容器中最多 1 个）。
+         *  Erase element equal to key (at most 1 in this container).
+         *
+         * @return
+         *  删除的元素个数（0 或 1）/ number of erased elements (0 or 1).
+         */
+        size_type erase(const T &key)
+        {
+            index_type n = find_node(key);
+            if (n == npos)
+            {
+                return 0;
+            }
+            erase_node(n);
+            return 1;
+        }
+
+        /**
+         * @brief
+         *  与另一棵树交换内容。
+         *  Swap contents with another tree.
+         */
+        void swap(CompactBinaryTree &other) noexcept(
+            std::is_nothrow_swappable<Compare>::value)
+        {
+            using std::swap;
+            nodes_.swap(other.nodes_);
+            swap(root_, other.root_);
+            swap(free_head_, other.free_head_);
+            swap(size_, other.size_);
+            swap(comp_, other.comp_);
+            swap(alloc_, other.alloc_);
+        }
+
+        // ============================
+        // 查找 / Lookup
+        // ============================
+
+        /**
+         * @brief
+         *  查找等于 key 的元素。
+         *  Find element equal to key.
+         */
+        iterator find(const T &key) noexcept
+        {
+            return iterator(find_node(key), this);
+        }
+
+        /**
+         * @brief
+         *  查找等于 key 的元素（常量版本）。
+         *  Find element equal to key (const version).
+         */
+        const_iterator find(const T &key) const noexcept
+        {
+            return const_iterator(find_node(key), this);
+        }
+
+        /**
+         * @brief
+         *  是否包含等于 key 的元素。
+         *  Check if container contains an element equal to key.
+         */
+        bool contains(const T &key) const noexcept
+        {
+            return find_node(key) != npos;
+        }
+
+        // ============================
+        // 访问器 / Observers
+        // ============================
+
+        /**
+         * @brief
+         *  返回比较器对象。
+         *  Get comparator object.
+         */
+        compare_type value_comp() const
+        {
+            return comp_;
+        }
+
+        /**
+         * @brief
+         *  返回分配器。
+         *  Get allocator.
+         */
+        allocator_type get_allocator() const noexcept
+        {
+            return alloc_;
+        }
+
+    private:
+        // ============================
+        // 成员变量 / Data members
+        // ============================
+        /// @brief 结点池 / node pool.
+        pool_type nodes_;
+        /// @brief 根结点下标 / root node index.
+        index_type root_;
+        /// @brief 空闲槽位链表头（经 left 串联）/ head of the free-slot list (chained via left).
+        index_type free_head_;
+        /// @brief 元素个数 / number of elements.
+        size_type size_;
+        /// @brief 比较器 / comparator.
+        compare_type comp_;
+        /// @brief 元素分配器 / allocator for values.
+        allocator_type alloc_;
+
+        // ============================
+        // 结点工具函数 / Node helpers
+        // ============================
+
+        /**
+         * @brief
+         *  在子树中找到最小结点。
+         *  Find minimum node in subtree.
+         */
+        index_type minimum(index_type n) const noexcept
+        {
+            if (n == npos)
+                return npos;
+            while (nodes_[n].left != npos)
+            {
+                n = nodes_[n].left;
+            }
+            return n;
+        }
+
+        /**
+         * @brief
+         *  在子树中找到最大结点。
+         *  Find maximum node in subtree.
+         */
+        index_type maximum(index_type n) const noexcept
+        {
+            if (n == npos)
+                return npos;
+            while (nodes_[n].right != npos)
+            {
+                n = nodes_[n].right;
+            }
+            return n;
+        }
+
+        /**
+         * @brief
+         *  找到中序遍历意义下当前结点的后继。
+         *  Find in-order successor of current node.
+         */
+        index_type next_node(index_type n) const noexcept
+        {
+            if (n == npos)
+                return npos;
+            if (nodes_[n].right != npos)
+            {
+                return minimum(nodes_[n].right);
+            }
+            index_type p = nodes_[n].parent;
+            while (p != npos && n == nodes_[p].right)
+            {
+                n = p;
+                p = nodes_[p].parent;
+            }
+            return p;
+        }
+
+        /**
+         * @brief
+         *  找到中序遍历意义下当前结点的前驱。
+         *  Find in-order predecessor of current node.
+         */
+        index_type prev_node(index_type n) const noexcept
+        {
+            if (n == npos)
+                return npos;
+            if (nodes_[n].left != npos)
+            {
+                return maximum(nodes_[n].left);
+            }
+            index_type p = nodes_[n].parent;
+            while (p != npos && n == nodes_[p].left)
+            {
+                n = p;
+                p = nodes_[p].parent;
+            }
+            return p;
+        }
+
+        /**
+         * @brief
+         *  分配一个结点槽位：优先复用空闲链表（在槽内原地构造值），否则追加到结点池末尾。
+         *  Allocate a node slot: reuse the free list first (constructing the value in place),
+         *  otherwise append to the pool.
+         */
+        template <class U>
+        index_type create_node(U &&value, index_type parent)
+        {
+            if (free_head_ != npos)
+            {
+                index_type n = free_head_;
+                node &slot = nodes_[n];
+                ::new (static_cast<void *>(std::addressof(slot.value))) T(std::forward<U>(value));
+                free_head_ = slot.left;
+                slot.left = npos;
+                slot.right = npos;
+                slot.parent = parent;
+                return n;
+            }
+            if (nodes_.size() >= static_cast<size_type>(free_mark))
+            {
+                throw std::length_error("CompactBinaryTree: 32-bit node index space exhausted");
+            }
+            nodes_.emplace_back(std::forward<U>(value), parent);
+            return static_cast<index_type>(nodes_.size() - 1);
+        }
+
+        /**
+         * @brief
+         *  析构槽位中的值并把槽位归还空闲链表。
+         *  Destroy the slot's value and return the slot to the free list.
+         */
+        void destroy_node(index_type n) noexcept
+        {
+            node &slot = nodes_[n];
+            slot.value.~T();
+            slot.left = free_head_;
+            slot.right = npos;
+            slot.parent = free_mark;
+            free_head_ = n;
+        }
+
+        /**
+         * @brief
+         *  在树中查找等于 key 的结点。
+         *  Find node equal to key in the tree.
+         */
+        index_type find_node(const T &key) const noexcept
+        {
+            const node *base = nodes_.data();
+            index_type cur = root_;
+            while (cur != npos)
+            {
+                const node &n = base[cur];
+                if (comp_(key, n.value))
+                {
+                    cur = n.left;
+                }
+                else if (comp_(n.value, key))
+                {
+                    cur = n.right;
+                }
+                else
+                {
+                    return cur;
+                }
+            }
+            return npos;
+        }
+
+        /**
+         * @brief
+         *  将以 v 为根的子树替换到 u 的位置（不修改 v 的左右子树）。
+         *  Transplant subtree rooted at v to replace u (without touching v's children).
+         */
+        void transplant(index_type u, index_type v) noexcept
+        {
+            index_type p = nodes_[u].parent;
+            if (p == npos)
+            {
+                root_ = v;
+            }
+            else if (u == nodes_[p].left)
+            {
+                nodes_[p].left = v;
+            }
+            else
+            {
+                nodes_[p].right = v;
+            }
+            if (v != npos)
+            {
+                nodes_[v].parent = p;
+            }
+        }
+
+        /**
+         * @brief
+         *  删除指定结点（标准 BST 删除算法）。
+         *  Erase given node (standard BST deletion algorithm).
+         */
+        void erase_node(index_type z) noexcept
+        {
+            if (nodes_[z].left == npos)
+            {
+                transplant(z, nodes_[z].right);
+            }
+            else if (nodes_[z].right == npos)
+            {
+                transplant(z, nodes_[z].left);
+            }
+            else
+            {
+                index_type y = minimum(nodes_[z].right);
+                if (nodes_[y].parent != z)
+                {
+                    transplant(y, nodes_[y].right);
+                    nodes_[y].right = nodes_[z].right;
+                    nodes_[nodes_[y].right].parent = y;
+                }
+                transplant(z, y);
+                nodes_[y].left = nodes_[z].left;
+                nodes_[nodes_[y].left].parent = y;
+            }
+            destroy_node(z);
+            --size_;
+        }
+
+        /**
+         * @brief
+         *  内部 emplace 实现，统一处理左/右插入和重复元素检查。
+         *  Internal emplace implementation, handling left/right insertion and duplicate check.
+         */
+        template <class U>
+        std::pair<iterator, bool> emplace_internal(U &&value)
+        {
+            if (root_ == npos)
+            {
+                root_ = create_node(std::forward<U>(value), npos);
+                ++size_;
+                return {iterator(root_, this), true};
+            }
+
+            index_type parent = npos;
+            index_type cur = root_;
+            bool go_left = false;
+            while (cur != npos)
+            {
+                parent = cur;
+                const node &n = nodes_[cur];
+                if (comp_(value, n.value))
+                {
+                    cur = n.left;
+                    go_left = true;
+                }
+                else if (comp_(n.value, value))
+                {
+                    cur = n.right;
+                    go_left = false;
+                }
+                else
+                {
+                    // 已存在 / already exists
+                    return {iterator(cur, this), false};
+                }
+            }
+
+            // create_node 可能扩容结点池，之后再通过下标回写父结点
+            // create_node may grow the pool, so write back to the parent by index afterwards
+            index_type n = create_node(std::forward<U>(value), parent);
+            if (go_left)
+            {
+                nodes_[parent].left = n;
+            }
+            else
+            {
+                nodes_[parent].right = n;
+            }
+            ++size_;
+            return {iterator(n, this), true};
+        }
+    };
+
+} // namespace test_forest
+
+#endif
@@ -0,0 +1,974 @@
+#ifndef _CONCURRENT_AVL_TREE_HPP
+#define _CONCURRENT_AVL_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace test_forest
+{
+
+    /**
+     * @brief 乐观读、松弛平衡的并发 AVL 集合（Bronson et al. 2010 的 optimistic AVL）
+     *        concurrent AVL set with optimistic readers and relaxed balance
+     *        (the optimistic AVL tree of Bronson et al. 2010)
+     *
+     * @tparam T         键类型 / key type
+     * @tparam Compare   比较器(less) / comparator (less)
+     * @tparam Allocator 分配器(allocator) / allocator
+     *
+     * @note
+     *  - 读者不加锁：逐层读取子指针后校验父节点的版本号（hand-over-hand validation），
+     *    版本变化则从仍然有效的祖先处重试
+     *    readers take no locks: after following a child link they validate the parent's version
+     *    (hand-over-hand validation) and retry from a still-valid ancestor if it changed
+     *  - 写者只锁住局部旋转涉及的节点（父、自身、子、孙，自上而下加锁）
+     *    writers lock only the nodes of a local rotation (parent, node, child, grandchild,
+     *    always top-down)
+     *  - 删除有两个孩子的节点只把它标成路由节点；路由节点在孩子不足两个时被摘除
+     *    erasing a node with two children only turns it into a routing node, which is unlinked
+     *    once it has fewer than two children
+     *  - 平衡是松弛的：高度与旋转由修改者事后沿路修复，期间可能短暂失衡
+     *    balance is relaxed: heights and rotations are repaired by the mutator afterwards, so
+     *    the tree may be briefly out of balance
+     *  - 摘除的节点直到 clear() 或析构才释放（读者可能仍在其上）；不提供迭代器
+     *    unlinked nodes are kept until clear() or destruction (readers may still be on them);
+     *    no iterators are provided
+     *  - 根持有者节点用 T() 构造，T 需可默认构造
+     *    the root holder node is built from T(), so T must be default-constructible
+     */
+    template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class concurrent_avl_tree
+    {
+    private:
+        // ===================== 节点定义 / Node definition =====================
+
+        /**
+         * @brief 并发 AVL 节点 / concurrent AVL node
+         *
+         * @note
+         *  - version：bit0 表示已摘除，bit1 表示正在收缩，其余位为收缩计数
+         *    version: bit 0 marks unlinked, bit 1 marks shrinking, the rest counts shrinks
+         *  - key 不可变，其余字段都是原子量，读者无锁读取
+         *    key is immutable; all other fields are atomics that readers load without locking
+         */
+        struct node
+        {
+            /// @brief 键 / key
+            const T key;
+
+            /// @brief 版本号 / version
+            std::atomic<std::uint64_t> version;
+
+            /// @brief 节点高度 / node height
+            std::atomic<int> height;
+
+            /// @brief 键是否在集合中（否则为路由节点）/ whether the key is in the set (else routing)
+            std::atomic<bool> present;
+
+            /// @brief 父节点指针 / parent pointer
+            std::atomic<node *> parent;
+
+            /// @brief 左子节点指针 / left child pointer
+            std::atomic<node *> left;
+
+            /// @brief 右子节点指针 / right child pointer
+            std::atomic<node *> right;
+
+            /// @brief 写者锁 / writer lock
+            std::mutex lock;
+
+            /**
+             * @brief 构造叶节点 / construct a leaf
+             *
+             * @param k   键 / key
+             * @param p   父节点 / parent
+             */
+            template <class K>
+            node(K &&k, node *p)
+                : key(std::forward<K>(k)), version(0), height(1), present(true),
+                  parent(p), left(nullptr), right(nullptr)
+            {
+            }
+
+            /// @brief 按方向取孩子（dir < 0 为左）/ child by direction (dir < 0 is left)
+            node *child(int dir) const noexcept
+            {
+                return (dir < 0 ? left : right).load(std::memory_order_acquire);
+            }
+
+            /// @brief 按方向设置孩子 / set child by direction
+            void set_child(int dir, node *c) noexcept
+            {
+                (dir < 0 ? left : right).store(c, std::memory_order_release);
+            }
+        };
+
+        // 为 allocator 重新绑定节点类型 / rebind allocator for node
+        using node_allocator_raw = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+        using node_traits = std::allocator_traits<node_allocator_raw>;
+
+        // ===================== 版本位 / Version bits =====================
+
+        /// @brief 已摘除 / unlinked
+        static constexpr std::uint64_t unlinked_bit = 1;
+
+        /// @brief 正在收缩 / shrinking
+        static constexpr std::uint64_t shrinking_bit = 2;
+
+        /// @brief 一次收缩的计数增量 / count increment of one shrink
+        static constexpr std::uint64_t shrink_step = 4;
+
+        /// @brief nodeCondition 的特殊返回值 / special results of node_condition
+        static constexpr int unlink_required = -1;
+        static constexpr int rebalance_required = -2;
+        static constexpr int nothing_required = -3;
+
+        /// @brief 乐观读失败，需从上一层重试 / optimistic read failed, retry one level up
+        enum class attempt
+        {
+            retry,
+            no,
+            yes
+        };
+
+    public:
+        // ===================== 类型别名 / Type aliases =====================
+
+        using key_type = T;
+        using value_type = T;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+        using allocator_type = Allocator;
+
+        // ===================== 构造与析构 / Construction & destruction =====================
+
+        /**
+         * @brief 默认构造 / default constructor
+         *
+         * @param comp  比较器 / comparator
+         * @param alloc 分配器 / allocator
+         */
+        explicit concurrent_avl_tree(const key_compare &comp = key_compare(),
+                                     const allocator_type &alloc = allocator_type())
+            : comp_(comp), node_alloc_(alloc), root_holder_(create_node(T(), nullptr))
+        {
+            root_holder_->present.store(false, std::memory_order_relaxed);
+        }
+
+        concurrent_avl_tree(const concurrent_avl_tree &) = delete;
+        concurrent_avl_tree &operator=(const concurrent_avl_tree &) = delete;
+
+        /**
+         * @brief 析构：释放树中节点、已摘除节点与根持有者
+         *        destructor: free tree nodes, unlinked nodes and the root holder
+         */
+        ~concurrent_avl_tree()
+        {
+            clear();
+            destroy_node(root_holder_);
+        }
+
+        // ===================== 查询 / Lookup =====================
+
+        /**
+         * @brief 是否包含 key（无锁）/ whether key is present (lock-free)
+         */
+        bool contains(const T &key) const
+        {
+            while (true)
+            {
+                node *right = root_holder_->right.load(std::memory_order_acquire);
+                if (!right)
+                    return false;
+                int dir = compare(key, right->key);
+                if (dir == 0)
+                    return right->present.load(std::memory_order_acquire);
+                std::uint64_t ovl = right->version.load(std::memory_order_acquire);
+                if (ovl & (shrinking_bit | unlinked_bit))
+                {
+                    wait_until_shrink_completed(right, ovl);
+                }
+                else if (right == root_holder_->right.load(std::memory_order_acquire))
+                {
+                    attempt r = attempt_contains(key, right, dir, ovl);
+                    if (r != attempt::retry)
+                        return r == attempt::yes;
+                }
+            }
+        }
+
+        /**
+         * @brief 统计 key 的个数（0 或 1）/ count of key (0 or 1)
+         */
+        size_type count(const T &key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        /**
+         * @brief 元素个数：遍历计数，仅在没有并发修改时准确
+         *        number of elements: counted by a walk, exact only without concurrent mutation
+         */
+        size_type size() const
+        {
+            return count_present(root_holder_->right.load(std::memory_order_acquire));
+        }
+
+        /**
+         * @brief 是否为空 / whether empty
+         */
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /**
+         * @brief 树高（根的高度字段）/ tree height (height field of the root)
+         */
+        int height() const noexcept
+        {
+            return height_of(root_holder_->right.load(std::memory_order_acquire));
+        }
+
+        // ===================== 修改 / Modifiers =====================
+
+        /**
+         * @brief 插入 key / insert key
+         *
+         * @return 是否新插入 / whether the key was newly inserted
+         */
+        bool insert(const T &key)
+        {
+            return update(key, true);
+        }
+
+        /**
+         * @brief 删除 key / erase key
+         *
+         * @return 删除的个数（0 或 1）/ number of removed elements (0 or 1)
+         */
+        size_type erase(const T &key)
+        {
+            return update(key, false) ? 1 : 0;
+        }
+
+        /**
+         * @brief 清空并释放全部节点；调用时不得有并发访问
+         *        clear and free every node; must not run concurrently with any access
+         */
+        void clear() noexcept
+        {
+            destroy_subtree(root_holder_->right.load(std::memory_order_relaxed));
+            root_holder_->right.store(nullptr, std::memory_order_relaxed);
+            root_holder_->height.store(1, std::memory_order_relaxed);
+            for (node *n : retired_)
+                destroy_node(n);
+            retired_.clear();
+        }
+
+    private:
+        // ===================== 内部工具 / Internal helpers =====================
+
+        /// @brief 三路比较 / three-way comparison
+        int compare(const T &a, const T &b) const
+        {
+            if (comp_(a, b))
+                return -1;
+            if (comp_(b, a))
+                return 1;
+            return 0;
+        }
+
+        /// @brief 节点高度，空为 0 / node height, 0 for null
+        static int height_of(const node *n) noexcept
+        {
+            return n ? n->height.load(std::memory_order_acquire) : 0;
+        }
+
+        /// @brief 版本是否显示收缩中或已摘除 / whether the version shows shrinking or unlinked
+        static bool shrinking_or_unlinked(std::uint64_t ovl) noexcept
+        {
+            return (ovl & (shrinking_bit | unlinked_bit)) != 0;
+        }
+
+        /// @brief 节点是否已摘除 / whether the node is unlinked
+        static bool is_unlinked(const node *n) noexcept
+        {
+            return (n->version.load(std::memory_order_acquire) & unlinked_bit) != 0;
+        }
+
+        /**
+         * @brief 等待正在进行的收缩结束：先自旋，再让出，最后借锁等待（收缩在持锁时进行）
+         *        wait for an in-progress shrink: spin, then yield, then block on the node lock
+         *        (shrinks happen while it is held)
+         */
+        static void wait_until_shrink_completed(node *n, std::uint64_t ovl)
+        {
+            if (!(ovl & shrinking_bit))
+                return;
+            for (int i = 0; i < 100; ++i)
+            {
+                if (n->version.load(std::memory_order_acquire) != ovl)
+                    return;
+            }
+            for (int i = 0; i < 10; ++i)
+            {
+                std::this_thread::yield();
+                if (n->version.load(std::memory_order_acquire) != ovl)
+                    return;
+            }
+            std::lock_guard<std::mutex> guard(n->lock);
+        }
+
+        /**
+         * @brief 从已校验的 n（版本 ovl）沿 dir 方向继续乐观查找
+         *        continue an optimistic lookup from validated n (version ovl) towards dir
+         */
+        attempt attempt_contains(const T &key, node *n, int dir, std::uint64_t ovl) const
+        {
+            while (true)
+            {
+                node *c = n->child(dir);
+                if (!c)
+                {
+                    if (n->version.load(std::memory_order_acquire) != ovl)
+                        return attempt::retry;
+                    return attempt::no;
+                }
+                int child_dir = compare(key, c->key);
+                if (child_dir == 0)
+                    return c->present.load(std::memory_order_acquire) ? attempt::yes : attempt::no;
+
+                std::uint64_t child_ovl = c->version.load(std::memory_order_acquire);
+                if (shrinking_or_unlinked(child_ovl))
+                {
+                    wait_until_shrink_completed(c, child_ovl);
+                    if (n->version.load(std::memory_order_acquire) != ovl)
+                        return attempt::retry;
+                }
+                else if (c != n->child(dir))
+                {
+                    if (n->version.load(std::memory_order_acquire) != ovl)
+                        return attempt::retry;
+                }
+                else
+                {
+                    if (n->version.load(std::memory_order_acquire) != ovl)
+                        return attempt::retry;
+                    attempt r = attempt_contains(key, c, child_dir, child_ovl);
+                    if (r != attempt::retry)
+                        return r;
+                }
+            }
+        }
+
+        /**
+         * @brief 插入（present = true）或删除（present = false）
+         *        insert (present = true) or erase (present = false)
+         *
+         * @return 集合是否改变 / whether the set changed
+         */
+        bool update(const T &key, bool present)
+        {
+            while (true)
+            {
+                node *right = root_holder_->right.load(std::memory_order_acquire);
+                if (!right)
+                {
+                    if (!present)
+                        return false;
+                    std::lock_guard<std::mutex> guard(root_holder_->lock);
+                    if (!root_holder_->right.load(std::memory_order_relaxed))
+                    {
+                        root_holder_->right.store(create_node(key, root_holder_),
+                                                  std::memory_order_release);
+                        root_holder_->height.store(2, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else
+                {
+                    std::uint64_t ovl = right->version.load(std::memory_order_acquire);
+                    if (shrinking_or_unlinked(ovl))
+                    {
+                        wait_until_shrink_completed(right, ovl);
+                    }
+                    else if (right == root_holder_->right.load(std::memory_order_acquire))
+                    {
+                        attempt r = attempt_update(key, present, root_holder_, right, ovl);
+                        if (r != attempt::retry)
+                            return r == attempt::yes;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief 从已校验的 n（版本 ovl，父为 parent）乐观下降并修改
+         *        descend optimistically from validated n (version ovl, parent parent) and update
+         */
+        attempt attempt_update(const T &key, bool present, node *parent, node *n, std::uint64_t ovl)
+        {
+            int dir = compare(key, n->key);
+            if (dir == 0)
+                return attempt_node_update(present, parent, n);
+
+            while (true)
+            {
+                node *c = n->child(dir);
+                if (n->version.load(std::memory_order_acquire) != ovl)
+                    return attempt::retry;
+
+                if (!c)
+                {
+                    if (!present)
+                        return attempt::no;
+
+                    node *damaged = nullptr;
+                    bool inserted = false;
+                    {
+                        std::lock_guard<std::mutex> guard(n->lock);
+                        // 持锁后不会再有旋转 / no further rotation can happen with the lock held
+                        if (n->version.load(std::memory_order_acquire) != ovl)
+                            return attempt::retry;
+                        if (!n->child(dir))
+                        {
+                            n->set_child(dir, create_node(key, n));
+                            damaged = fix_height_nl(n);
+                            inserted = true;
+                        }
+                    }
+                    if (inserted)
+                    {
+                        fix_height_and_rebalance(damaged);
+                        return attempt::yes;
+                    }
+                    // 输给了并发插入，重读孩子 / lost a race with a concurrent insert, re-read the child
+                }
+                else
+                {
+                    std::uint64_t child_ovl = c->version.load(std::memory_order_acquire);
+                    if (shrinking_or_unlinked(child_ovl))
+                    {
+                        wait_until_shrink_completed(c, child_ovl);
+                    }
+                    else if (c == n->child(dir))
+                    {
+                        if (n->version.load(std::memory_order_acquire) != ovl)
+                            return attempt::retry;
+                        attempt r = attempt_update(key, present, n, c, child_ovl);
+                        if (r != attempt::retry)
+                            return r;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief 在键相等的节点 n 上插入或删除 / insert or erase at n, whose key matches
+         */
+        attempt attempt_node_update(bool present, node *parent, node *n)
+        {
+            if (!present)
+            {
+                if (!n->present.load(std::memory_order_acquire))
+                    return attempt::no;
+
+                if (!n->left.load(std::memory_order_acquire) || !n->right.load(std::memory_order_acquire))
+                {
+                    // 可能直接摘除，先锁父节点 / may unlink directly, lock the parent first
+                    {
+                        std::lock_guard<std::mutex> parent_guard(parent->lock);
+                        if (is_unlinked(parent) || n->parent.load(std::memory_order_acquire) != parent)
+                            return attempt::retry;
+                        std::lock_guard<std::mutex> guard(n->lock);
+                        if (!n->present.load(std::memory_order_acquire))
+                            return attempt::no;
+                        n->present.store(false, std::memory_order_release);
+                        if (!attempt_unlink_nl(parent, n))
+                        {
+                            // 孩子又变成两个：保留为路由节点 / two children again: keep it as routing
+                            return attempt::yes;
+                        }
+                    }
+                    fix_height_and_rebalance(parent);
+                    return attempt::yes;
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(n->lock);
+            if (is_unlinked(n))
+                return attempt::retry;
+            if (n->present.load(std::memory_order_acquire) == present)
+                return attempt::no;
+            // 孩子已不足两个时应走摘除路径 / with fewer than two children now, take the unlink path
+            if (!present &&
+                (!n->left.load(std::memory_order_acquire) || !n->right.load(std::memory_order_acquire)))
+                return attempt::retry;
+            n->present.store(present, std::memory_order_release);
+            return attempt::yes;
+        }
+
+        /**
+         * @brief 在持有 parent 与 n 的锁时摘除至多一个孩子的 n
+         *        with parent and n locked, unlink n if it has at most one child
+         *
+         * @return 是否摘除 / whether n was unlinked
+         */
+        bool attempt_unlink_nl(node *parent, node *n)
+        {
+            node *parent_left = parent->left.load(std::memory_order_relaxed);
+            if (parent_left != n && parent->right.load(std::memory_order_relaxed) != n)
+                return false;
+            node *l = n->left.load(std::memory_order_relaxed);
+            node *r = n->right.load(std::memory_order_relaxed);
+            if (l && r)
+                return false;
+
+            node *splice = l ? l : r;
+            (parent_left == n ? parent->left : parent->right).store(splice, std::memory_order_release);
+            if (splice)
+                splice->parent.store(parent, std::memory_order_release);
+            n->version.store(unlinked_bit, std::memory_order_release);
+            n->present.store(false, std::memory_order_release);
+
+            std::lock_guard<std::mutex> guard(retired_lock_);
+            retired_.push_back(n);
+            return true;
+        }
+
+        // ===================== 松弛平衡 / Relaxed balance =====================
+
+        /**
+         * @brief 判断 n 需要的修复：摘除、旋转、新高度，或什么都不需要
+         *        what repair n needs: unlink, rotation, a new height, or nothing
+         *
+         * @note 读取不原子，但任何修改者都会负责修复自己造成的损伤
+         *       the reads are not atomic, but every mutator repairs the damage it causes
+         */
+        static int node_condition(node *n) noexcept
+        {
+            node *l = n->left.load(std::memory_order_acquire);
+            node *r = n->right.load(std::memory_order_acquire);
+            if ((!l || !r) && !n->present.load(std::memory_order_acquire))
+                return unlink_required;
+
+            int h = n->height.load(std::memory_order_acquire);
+            int hl = height_of(l);
+            int hr = height_of(r);
+            int bal = hl - hr;
+            if (bal < -1 || bal > 1)
+                return rebalance_required;
+            int h_repl = 1 + (hl > hr ? hl : hr);
+            return h != h_repl ? h_repl : nothing_required;
+        }
+
+        /**
+         * @brief 从 n 开始沿父链修复高度、摘除路由节点并旋转
+         *        starting at n, fix heights, unlink routing nodes and rotate along the parent chain
+         */
+        void fix_height_and_rebalance(node *n)
+        {
+            while (n && n->parent.load(std::memory_order_acquire))
+            {
+                int condition = node_condition(n);
+                if (condition == nothing_required || is_unlinked(n))
+                    return;
+
+                if (condition != unlink_required && condition != rebalance_required)
+                {
+                    std::lock_guard<std::mutex> guard(n->lock);
+                    n = fix_height_nl(n);
+                }
+                else
+                {
+                    node *parent = n->parent.load(std::memory_order_acquire);
+                    std::lock_guard<std::mutex> parent_guard(parent->lock);
+                    if (!is_unlinked(parent) && n->parent.load(std::memory_order_acquire) == parent)
+                    {
+                        std::lock_guard<std::mutex> guard(n->lock);
+                        n = rebalance_nl(parent, n);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief 持锁修复 n 的高度 / fix the height of locked n
+         *
+         * @return 下一个需要修复的节点（可能为 n 本身），无则为空
+         *         the next node needing repair (possibly n itself), or null
+         */
+        static node *fix_height_nl(node *n) noexcept
+        {
+            int c = node_condition(n);
+            switch (c)
+            {
+            case rebalance_required:
+            case unlink_required:
+                return n;
+            case nothing_required:
+                return nullptr;
+            default:
+                n->height.store(c, std::memory_order_release);
+                return n->parent.load(std::memory_order_acquire);
+            }
+        }
+
+        /**
+         * @brief 持有 parent 与 n 的锁时修复 n / repair n with parent and n locked
+         */
+        node *rebalance_nl(node *parent, node *n)
+        {
+            node *l = n->left.load(std::memory_order_relaxed);
+            node *r = n->right.load(std::memory_order_relaxed);
+            if ((!l || !r) && !n->present.load(std::memory_order_relaxed))
+                return attempt_unlink_nl(parent, n) ? fix_height_nl(parent) : n;
+
+            int h = n->height.load(std::memory_order_relaxed);
+            int hl = height_of(l);
+            int hr = height_of(r);
+            int h_repl = 1 + (hl > hr ? hl : hr);
+            int bal = hl - hr;
+            if (bal > 1)
+                return rebalance_to_right_nl(parent, n, l, hr);
+            if (bal < -1)
+                return rebalance_to_left_nl(parent, n, r, hl);
+            if (h_repl != h)
+            {
+                n->height.store(h_repl, std::memory_order_release);
+                return fix_height_nl(parent);
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief 左子树过高：右旋（必要时先左旋左孩子）
+         *        left subtree too tall: rotate right (first rotating the left child left if needed)
+         */
+        node *rebalance_to_right_nl(node *parent, node *n, node *l, int hr0)
+        {
+            std::lock_guard<std::mutex> left_guard(l->lock);
+            int hl = l->height.load(std::memory_order_relaxed);
+            if (hl - hr0 <= 1)
+                return n;
+
+            node *lr = l->right.load(std::memory_order_relaxed);
+            int hll0 = height_of(l->left.load(std::memory_order_relaxed));
+            int hlr0 = height_of(lr);
+            if (hll0 >= hlr0)
+                return rotate_right_nl(parent, n, l, hr0, hll0, lr, hlr0);
+
+            {
+                std::lock_guard<std::mutex> lr_guard(lr->lock);
+                int hlr = lr->height.load(std::memory_order_relaxed);
+                if (hll0 >= hlr)
+                    return rotate_right_nl(parent, n, l, hr0, hll0, lr, hlr);
+
+                // 双旋后 l 仍平衡才合并成一次双旋 / double-rotate only if l stays balanced
+                int hlrl = height_of(lr->left.load(std::memory_order_relaxed));
+                int b = hll0 - hlrl;
+                if (b >= -1 && b <= 1 &&
+                    !((hll0 == 0 || hlrl == 0) && !l->present.load(std::memory_order_relaxed)))
+                    return rotate_right_over_left_nl(parent, n, l, hr0, hll0, lr, hlrl);
+            }
+            // 先单独修复 l，n 稍后再平衡 / fix l on its own first, n is balanced later
+            return rebalance_to_left_nl(n, l, lr, hll0);
+        }
+
+        /**
+         * @brief 右子树过高：左旋（必要时先右旋右孩子）
+         *        right subtree too tall: rotate left (first rotating the right child right if needed)
+         */
+        node *rebalance_to_left_nl(node *parent, node *n, node *r, int hl0)
+        {
+            std::lock_guard<std::mutex> right_guard(r->lock);
+            int hr = r->height.load(std::memory_order_relaxed);
+            if (hl0 - hr >= -1)
+                return n;
+
+            node *rl = r->left.load(std::memory_order_relaxed);
+            int hrl0 = height_of(rl);
+            int hrr0 = height_of(r->right.load(std::memory_order_relaxed));
+            if (hrr0 >= hrl0)
+                return rotate_left_nl(parent, n, hl0, r, rl, hrl0, hrr0);
+
+            {
+                std::lock_guard<std::mutex> rl_guard(rl->lock);
+                int hrl = rl->height.load(std::memory_order_relaxed);
+                if (hrr0 >= hrl)
+                    return rotate_left_nl(parent, n, hl0, r, rl, hrl, hrr0);
+
+                int hrlr = height_of(rl->right.load(std::memory_order_relaxed));
+                int b = hrr0 - hrlr;
+                if (b >= -1 && b <= 1 &&
+                    !((hrr0 == 0 || hrlr == 0) && !r->present.load(std::memory_order_relaxed)))
+                    return rotate_left_over_right_nl(parent, n, hl0, r, rl, hrr0, hrlr);
+            }
+            return rebalance_to_right_nl(n, r, rl, hrr0);
+        }
+
+        /// @brief 用 c 替换 parent 下的 n / replace n under parent with c
+        static void replace_child_nl(node *parent, node *n, node *c) noexcept
+        {
+            if (parent->left.load(std::memory_order_relaxed) == n)
+                parent->left.store(c, std::memory_order_release);
+            else
+                parent->right.store(c, std::memory_order_release);
+            c->parent.store(parent, std::memory_order_release);
+        }
+
+        /// @brief 标记收缩开始，返回原版本 / mark a shrink as started, returning the old version
+        static std::uint64_t begin_shrink(node *n) noexcept
+        {
+            std::uint64_t ovl = n->version.load(std::memory_order_relaxed);
+            n->version.store(ovl | shrinking_bit, std::memory_order_release);
+            return ovl;
+        }
+
+        /// @brief 标记收缩结束 / mark a shrink as finished
+        static void end_shrink(node *n, std::uint64_t ovl) noexcept
+        {
+            n->version.store(ovl + shrink_step, std::memory_order_release);
+        }
+
+        /**
+         * @brief 单右旋，n 收缩、l 上升 / single right rotation, n shrinks and l rises
+         *
+         * @return 仍需修复的最深节点 / deepest node still needing repair
+         */
+        node *rotate_right_nl(node *parent, node *n, node *l, int hr, int hll, node *lr, int hlr)
+        {
+            std::uint64_t ovl = begin_shrink(n);
+
+            n->left.store(lr, std::memory_order_release);
+            if (lr)
+                lr->parent.store(n, std::memory_order_release);
+            l->right.store(n, std::memory_order_release);
+            n->parent.store(l, std::memory_order_release);
+            replace_child_nl(parent, n, l);
+
+            int hn = 1 + (hlr > hr ? hlr : hr);
+            n->height.store(hn, std::memory_order_release);
+            l->height.store(1 + (hll > hn ? hll : hn), std::memory_order_release);
+
+            end_shrink(n, ovl);
+
+            int bal_n = hlr - hr;
+            if (bal_n < -1 || bal_n > 1)
+                return n;
+            if ((!lr || hr == 0) && !n->present.load(std::memory_order_relaxed))
+                return n;
+            int bal_l = hll - hn;
+            if (bal_l < -1 || bal_l > 1)
+                return l;
+            if (hll == 0 && !l->present.load(std::memory_order_relaxed))
+                return l;
+            return fix_height_nl(parent);
+        }
+
+        /**
+         * @brief 单左旋，n 收缩、r 上升 / single left rotation, n shrinks and r rises
+         */
+        node *rotate_left_nl(node *parent, node *n, int hl, node *r, node *rl, int hrl, int hrr)
+        {
+            std::uint64_t ovl = begin_shrink(n);
+
+            n->right.store(rl, std::memory_order_release);
+            if (rl)
+                rl->parent.store(n, std::memory_order_release);
+            r->left.store(n, std::memory_order_release);
+            n->parent.store(r, std::memory_order_release);
+            replace_child_nl(parent, n, r);
+
+            int hn = 1 + (hl > hrl ? hl : hrl);
+            n->height.store(hn, std::memory_order_release);
+            r->height.store(1 + (hn > hrr ? hn : hrr), std::memory_order_release);
+
+            end_shrink(n, ovl);
+
+            int bal_n = hrl - hl;
+            if (bal_n < -1 || bal_n > 1)
+                return n;
+            if ((!rl || hl == 0) && !n->present.load(std::memory_order_relaxed))
+                return n;
+            int bal_r = hrr - hn;
+            if (bal_r < -1 || bal_r > 1)
+                return r;
+            if (hrr == 0 && !r->present.load(std::memory_order_relaxed))
+                return r;
+            return fix_height_nl(parent);
+        }
+
+        /**
+         * @brief 左右双旋：n 与 l 收缩，lr 上升为子树根
+         *        left-right double rotation: n and l shrink, lr rises to the subtree root
+         */
+        node *rotate_right_over_left_nl(node *parent, node *n, node *l, int hr, int hll,
+                                        node *lr, int hlrl)
+        {
+            node *lrl = lr->left.load(std::memory_order_relaxed);
+            node *lrr = lr->right.load(std::memory_order_relaxed);
+            int hlrr = height_of(lrr);
+
+            std::uint64_t ovl = begin_shrink(n);
+            std::uint64_t left_ovl = begin_shrink(l);
+
+            n->left.store(lrr, std::memory_order_release);
+            if (lrr)
+                lrr->parent.store(n, std::memory_order_release);
+            l->right.store(lrl, std::memory_order_release);
+            if (lrl)
+                lrl->parent.store(l, std::memory_order_release);
+            lr->left.store(l, std::memory_order_release);
+            l->parent.store(lr, std::memory_order_release);
+            lr->right.store(n, std::memory_order_release);
+            n->parent.store(lr, std::memory_order_release);
+            replace_child_nl(parent, n, lr);
+
+            int hn = 1 + (hlrr > hr ? hlrr : hr);
+            n->height.store(hn, std::memory_order_release);
+            int hl = 1 + (hll > hlrl ? hll : hlrl);
+            l->height.store(hl, std::memory_order_release);
+            lr->height.store(1 + (hl > hn ? hl : hn), std::memory_order_release);
+
+            end_shrink(n, ovl);
+            end_shrink(l, left_ovl);
+
+            int bal_n = hlrr - hr;
+            if (bal_n < -1 || bal_n > 1)
+                return n;
+            if ((!lrr || hr == 0) && !n->present.load(std::memory_order_relaxed))
+                return n;
+            int bal_lr = hl - hn;
+            if (bal_lr < -1 || bal_lr > 1)
+                return lr;
+            return fix_height_nl(parent);
+        }
+
+        /**
+         * @brief 右左双旋：n 与 r 收缩，rl 上升为子树根
+         *        right-left double rotation: n and r shrink, rl rises to the subtree root
+         */
+        node *rotate_left_over_right_nl(node *parent, node *n, int hl, node *r, node *rl,
+                                        int hrr, int hrlr)
+        {
+            node *rll = rl->left.load(std::memory_order_relaxed);
+            node *rlr = rl->right.load(std::memory_order_relaxed);
+            int hrll = height_of(rll);
+
+            std::uint64_t ovl = begin_shrink(n);
+            std::uint64_t right_ovl = begin_shrink(r);
+
+            n->right.store(rll, std::memory_order_release);
+            if (rll)
+                rll->parent.store(n, std::memory_order_release);
+            r->left.store(rlr, std::memory_order_release);
+            if (rlr)
+                rlr->parent.store(r, std::memory_order_release);
+            rl->right.store(r, std::memory_order_release);
+            r->parent.store(rl, std::memory_order_release);
+            rl->left.store(n, std::memory_order_release);
+            n->parent.store(rl, std::memory_order_release);
+            replace_child_nl(parent, n, rl);
+
+            int hn = 1 + (hl > hrll ? hl : hrll);
+            n->height.store(hn, std::memory_order_release);
+            int hr = 1 + (hrlr > hrr ? hrlr : hrr);
+            r->height.store(hr, std::memory_order_release);
+            rl->height.store(1 + (hn > hr ? hn : hr), std::memory_order_release);
+
+            end_shrink(n, ovl);
+            end_shrink(r, right_ovl);
+
+            int bal_n = hrll - hl;
+            if (bal_n < -1 || bal_n > 1)
+                return n;
+            if ((!rll || hl == 0) && !n->present.load(std::memory_order_relaxed))
+                return n;
+            int bal_rl = hr - hn;
+            if (bal_rl < -1 || bal_rl > 1)
+                return rl;
+            return fix_height_nl(parent);
+        }
+
+        // ===================== 节点分配与释放 / Node allocation =====================
+
+        /// @brief 分配并构造节点 / allocate and construct a node
+        template <class K>
+        node *create_node(K &&key, node *parent)
+        {
+            node *p = node_traits::allocate(node_alloc_, 1);
+            try
+            {
+                node_traits::construct(node_alloc_, p, std::forward<K>(key), parent);
+            }
+            catch (...)
+            {
+                node_traits::deallocate(node_alloc_, p, 1);
+                throw;
+            }
+            return p;
+        }
+
+        /// @brief 析构并释放节点 / destroy and deallocate a node
+        void destroy_node(node *p) noexcept
+        {
+            node_traits::destroy(node_alloc_, p);
+            node_traits::deallocate(node_alloc_, p, 1);
+        }
+
+        /// @brief 释放子树 / free a subtree
+        void destroy_subtree(node *n) noexcept
+        {
+            while (n)
+            {
+                destroy_subtree(n->right.load(std::memory_order_relaxed));
+                node *l = n->left.load(std::memory_order_relaxed);
+                destroy_node(n);
+                n = l;
+            }
+        }
+
+        /// @brief 统计子树中在集合内的键 / count keys of a subtree that are in the set
+        static size_type count_present(const node *n) noexcept
+        {
+            size_type c = 0;
+            while (n)
+            {
+                c += count_present(n->right.load(std::memory_order_acquire));
+                if (n->present.load(std::memory_order_acquire))
+                    ++c;
+                n = n->left.load(std::memory_order_acquire);
+            }
+            return c;
+        }
+
+    private:
+        /// @brief 比较器 / comparator
+        key_compare comp_;
+
+        /// @brief 节点分配器 / node allocator
+        node_allocator_raw node_alloc_;
+
+        /// @brief 根持有者：根挂在其右孩子上，parent 为空 / root holder: the root hangs off its
+        ///        right child; its parent is null
+        node *root_holder_;
+
+        /// @brief 保护 retired_ 的锁 / lock guarding retired_
+        std::mutex retired_lock_;
+
+        /// @brief 已摘除、待释放的节点 / unlinked nodes awaiting reclamation
+        std::vector<node *> retired_;
+    };
+
+} // namespace test_forest
+
+#endif // _CONCURRENT_AVL_TREE_HPP
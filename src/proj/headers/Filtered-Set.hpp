@@ -0,0 +1,289 @@
+#ifndef _FILTERED_SET_HPP
+#define _FILTERED_SET_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Set-Traits.hpp"
+
+namespace test_forest
+{
+
+    /**
+     * @brief
+     *  带分块 Bloom 过滤器的集合包装：过滤器判定「一定不存在」的查找不进树，直接返回 false。
+     *  Set wrapper with a blocked Bloom filter: lookups the filter rules out never descend
+     *  into the tree and return false at once.
+     *
+     * @tparam Tree 被包装的树（avl_tree、RedBlackTree、BTreeSet、BinaryTree 等）
+     *              / wrapped tree (avl_tree, RedBlackTree, BTreeSet, BinaryTree, ...)
+     * @tparam Hash 键的哈希函数（结果会再经一次 64 位混合）/ key hash (its result is mixed once more to 64 bits)
+     *
+     * @note
+     *  每个键的 k 个位落在同一个 64 字节块内，一次查找只碰一条缓存行。Bloom 过滤器不能删位：
+     *  erase 只记账，陈旧位累计到容量的一半时从树重建；元素数超过容量时按 2 倍当前规模重建。
+     *  两种重建的代价都摊到触发它的插入 / 删除上，摊还 O(1)。
+     *  The k bits of a key all land in one 64-byte block, so a lookup touches a single cache
+     *  line. A Bloom filter cannot clear bits: erase only counts stale keys, and once they
+     *  reach half the capacity the filter is rebuilt from the tree; when the size exceeds
+     *  the capacity it is rebuilt for twice the current size. Both rebuilds are amortized
+     *  over the inserts / erases that trigger them, O(1) each.
+     */
+    template <class Tree, class Hash = std::hash<typename set_traits::key_of<Tree>::type>>
+    class FilteredSet
+    {
+    public:
+        /// @brief 键类型 / key type.
+        using key_type = typename set_traits::key_of<Tree>::type;
+        /// @brief 值类型 / value type.
+        using value_type = key_type;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+        /// @brief 被包装的树 / wrapped tree.
+        using tree_type = Tree;
+        /// @brief 哈希函数类型 / hasher type.
+        using hasher = Hash;
+
+        /// @brief 过滤器的最小容量（键数）/ minimum filter capacity in keys.
+        static constexpr size_type min_capacity = 1024;
+
+        /**
+         * @brief 构造空集合 / Construct an empty set.
+         *
+         * @param false_positive_rate 目标误判率，取值 (0, 1)，缺省 1% / target false-positive rate in (0, 1), default 1%.
+         * @param expected_size       预计键数，用于预留过滤器 / expected number of keys, used to presize the filter.
+         * @param hash                哈希函数对象 / hash function object.
+         */
+        explicit FilteredSet(double false_positive_rate = 0.01, size_type expected_size = 0, const Hash &hash = Hash())
+            : tree_(), hash_(hash), fp_rate_(std::clamp(false_positive_rate, 1e-9, 0.5))
+        {
+            // 从经典 Bloom 过滤器的最优位数 m/n = -ln p / ln²2 出发（哈希数 k = (m/n)·ln 2），
+            // 逐步加位直到分块布局的误判率也不超过 p：各块的键数有波动，满块拖高了误判率
+            // start from the classic optimum m/n = -ln p / ln²2 bits per key (k = (m/n)·ln 2 hashes)
+            // and add bits until the blocked layout meets p as well: per-block load varies and
+            // the fuller blocks raise the false-positive rate
+            const double ln2 = std::log(2.0);
+            bits_per_key_ = -std::log(fp_rate_) / (ln2 * ln2);
+            for (;;)
+            {
+                hashes_ = static_cast<unsigned>(std::clamp(std::lround(bits_per_key_ * ln2), 1L, 16L));
+                if (bits_per_key_ >= max_bits_per_key || blocked_rate(bits_per_key_, hashes_) <= fp_rate_)
+                    break;
+                bits_per_key_ += 0.5;
+            }
+            reset_filter(std::max(min_capacity, expected_size));
+        }
+
+        /**
+         * @brief 插入键 / Insert a key.
+         * @return 是否新插入 / whether the key was newly inserted.
+         */
+        bool insert(const key_type &key)
+        {
+            if (!set_traits::inserted(tree_.insert(key)))
+                return false;
+            if (tree_.size() > capacity_)
+                rebuild();
+            else
+                add(key);
+            return true;
+        }
+
+        /**
+         * @brief 删除键 / Erase a key.
+         * @return 删除的个数（0 或 1）/ number of erased keys (0 or 1).
+         */
+        size_type erase(const key_type &key)
+        {
+            // 过滤器说不在就一定不在 / if the filter says absent, it is absent
+            if (!may_contain(key))
+                return 0;
+            size_type erased = static_cast<size_type>(tree_.erase(key));
+            if (erased != 0 && ++stale_ >= capacity_ / 2)
+                rebuild();
+            return erased;
+        }
+
+        /**
+         * @brief 是否包含键；过滤器排除的键不访问树 / Whether the key is present; keys the filter rules out skip the tree.
+         */
+        bool contains(const key_type &key) const
+        {
+            return may_contain(key) && set_traits::contains(tree_, key);
+        }
+
+        /**
+         * @brief 过滤器是否认为键可能存在（false 表示一定不存在）/ Whether the filter considers the key possibly present (false means definitely absent).
+         */
+        bool may_contain(const key_type &key) const noexcept
+        {
+            const std::uint64_t h = mix(hash_(key));
+            const Block &block = blocks_[block_index(h)];
+            std::uint32_t probe = static_cast<std::uint32_t>(h);
+            for (unsigned i = 0; i < hashes_; ++i)
+            {
+                const std::uint32_t bit = next_bit(probe);
+                if (!(block.words[bit >> 6] & (std::uint64_t(1) << (bit & 63))))
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief 清空集合与过滤器 / Clear the set and the filter.
+         */
+        void clear()
+        {
+            tree_.clear();
+            reset_filter(min_capacity);
+        }
+
+        /**
+         * @brief 元素个数 / Number of keys.
+         */
+        size_type size() const noexcept { return tree_.size(); }
+
+        /**
+         * @brief 是否为空 / Whether empty.
+         */
+        bool empty() const noexcept { return tree_.size() == 0; }
+
+        /**
+         * @brief 只读访问底层树（有序遍历等）/ Read-only access to the underlying tree (ordered traversal and so on).
+         */
+        const Tree &tree() const noexcept { return tree_; }
+
+        /**
+         * @brief 目标误判率 / Target false-positive rate.
+         */
+        double false_positive_rate() const noexcept { return fp_rate_; }
+
+        /**
+         * @brief 每个键的哈希位数 / Hash bits set per key.
+         */
+        unsigned hash_count() const noexcept { return hashes_; }
+
+        /**
+         * @brief 过滤器占用的字节数 / Bytes held by the filter.
+         */
+        size_type filter_bytes() const noexcept { return blocks_.size() * sizeof(Block); }
+
+    private:
+        /// @brief 每块位数（一条 64 字节缓存行）/ bits per block (one 64-byte cache line).
+        static constexpr std::uint32_t block_bits = 512;
+        /// @brief log2(block_bits) / log2(block_bits).
+        static constexpr unsigned block_shift = 9;
+
+        /// @brief 过滤器块 / filter block.
+        struct alignas(64) Block
+        {
+            std::uint64_t words[block_bits / 64];
+        };
+
+        /// @brief 每键位数的上限 / upper bound on bits per key.
+        static constexpr double max_bits_per_key = 64.0;
+
+        /**
+         * @brief 分块过滤器在满载时的预期误判率 / Expected false-positive rate of the blocked filter at full load.
+         *
+         * @note 每块的键数近似服从均值 block_bits / c 的泊松分布；对每种块载荷 x 累加
+         *       单块误判率 (1 - (1 - 1/block_bits)^{k·x})^k。
+         *       The keys per block are roughly Poisson with mean block_bits / c; the per-block
+         *       rate (1 - (1 - 1/block_bits)^{k·x})^k is summed over block loads x.
+         */
+        static double blocked_rate(double bits_per_key, unsigned hashes) noexcept
+        {
+            const double lambda = static_cast<double>(block_bits) / bits_per_key;
+            const double miss = 1.0 - 1.0 / static_cast<double>(block_bits);
+            const std::size_t last = static_cast<std::size_t>(lambda + 10.0 * std::sqrt(lambda) + 20.0);
+            double pmf = std::exp(-lambda);
+            double rate = 0.0;
+            for (std::size_t x = 0; x <= last; ++x)
+            {
+                rate += pmf * std::pow(1.0 - std::pow(miss, static_cast<double>(hashes * x)), static_cast<double>(hashes));
+                pmf *= lambda / static_cast<double>(x + 1);
+            }
+            return rate;
+        }
+
+        /// @brief 64 位混合（splitmix64 终结步），把 std::hash<int> 这类恒等哈希打散
+        ///        / 64-bit mix (splitmix64 finalizer) that spreads identity hashes like std::hash<int>.
+        static std::uint64_t mix(std::uint64_t x) noexcept
+        {
+            x += 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        size_type block_index(std::uint64_t h) const noexcept
+        {
+            // 乘法取高位代替取模 / multiply-high instead of modulo
+            return static_cast<size_type>(((h >> 32) * static_cast<std::uint64_t>(blocks_.size())) >> 32);
+        }
+
+        /**
+         * @brief 块内的下一个探测位 / Next probe bit inside the block.
+         *
+         * @note 块由哈希的高 32 位选出，块内探测只用低 32 位：每步乘以黄金比例常数再取最高 9 位，
+         *       两者不共用任何位，过滤器再大，同一块内的键也有完整的探测序列。
+         *       The block is chosen from the high 32 hash bits and in-block probes use only the
+         *       low 32: each step multiplies by the golden-ratio constant and takes the top 9
+         *       bits. The two never share bits, so however large the filter grows, keys in the
+         *       same block keep their full range of probe sequences.
+         */
+        static std::uint32_t next_bit(std::uint32_t &probe) noexcept
+        {
+            probe *= 0x9e3779b9u;
+            return probe >> (32 - block_shift);
+        }
+
+        void add(const key_type &key) noexcept
+        {
+            const std::uint64_t h = mix(hash_(key));
+            Block &block = blocks_[block_index(h)];
+            std::uint32_t probe = static_cast<std::uint32_t>(h);
+            for (unsigned i = 0; i < hashes_; ++i)
+            {
+                const std::uint32_t bit = next_bit(probe);
+                block.words[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+            }
+        }
+
+        /// @brief 按 capacity 个键重新分配并清零过滤器 / reallocate and zero the filter for capacity keys.
+        void reset_filter(size_type capacity)
+        {
+            capacity_ = capacity;
+            stale_ = 0;
+            const double bits = bits_per_key_ * static_cast<double>(capacity);
+            const size_type blocks = std::max<size_type>(1, static_cast<size_type>(std::ceil(bits / block_bits)));
+            blocks_.assign(blocks, Block{});
+        }
+
+        /// @brief 按当前规模的 2 倍重建过滤器 / rebuild the filter for twice the current size.
+        void rebuild()
+        {
+            reset_filter(std::max(min_capacity, 2 * tree_.size()));
+            set_traits::for_each_key(tree_, [this](const key_type &key)
+                                     { add(key); });
+        }
+
+        Tree tree_;
+        Hash hash_;
+        double fp_rate_;
+        double bits_per_key_ = 0.0;
+        unsigned hashes_ = 1;
+        size_type capacity_ = 0;
+        size_type stale_ = 0;
+        std::vector<Block> blocks_;
+    }; // class FilteredSet
+
+} // namespace test_forest
+
+#endif
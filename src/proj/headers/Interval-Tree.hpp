@@ -0,0 +1,297 @@
+#ifndef _INTERVAL_TREE_HPP
+#define _INTERVAL_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "Red-Black-Tree.hpp"
+
+namespace test_forest
+{
+
+    /**
+     * @brief 闭区间 [low, high] / Closed interval [low, high].
+     */
+    template <typename T>
+    struct interval
+    {
+        /// @brief 左端点 / Lower endpoint.
+        T low;
+        /// @brief 右端点 / Upper endpoint.
+        T high;
+
+        friend bool operator==(const interval &a, const interval &b)
+        {
+            return !(a.low < b.low) && !(b.low < a.low) && !(a.high < b.high) && !(b.high < a.high);
+        }
+
+        friend bool operator!=(const interval &a, const interval &b)
+        {
+            return !(a == b);
+        }
+    };
+
+    /**
+     * @brief 按 (low, high) 字典序比较区间 / Order intervals lexicographically by (low, high).
+     */
+    template <typename T>
+    struct interval_less
+    {
+        bool operator()(const interval<T> &a, const interval<T> &b) const
+        {
+            if (a.low < b.low)
+                return true;
+            if (b.low < a.low)
+                return false;
+            return a.high < b.high;
+        }
+    };
+
+    /**
+     * @brief 子树最大右端点幺半群 / Subtree max-endpoint monoid.
+     */
+    template <typename T>
+    struct interval_max_end
+    {
+        using value_type = T;
+        static value_type identity() { return std::numeric_limits<T>::lowest(); }
+        static value_type lift(const interval<T> &iv) { return iv.high; }
+        static value_type combine(const value_type &a, const value_type &b) { return a < b ? b : a; }
+    };
+
+    /**
+     * @brief 区间树：以红黑树按左端点排序，并维护子树最大右端点
+     *        / Interval tree: a red-black tree ordered by lower endpoint that maintains the
+     *        subtree max endpoint.
+     *
+     * @tparam T         端点类型 / endpoint type
+     * @tparam Allocator 分配器（缺省为 std::allocator<interval<T>>）
+     *                   / allocator (default std::allocator<interval<T>>)
+     *
+     * @note 节点、旋转与修复全部复用 RedBlackTree，最大右端点经其 Aggregate 策略维护；
+     *       重叠查询跳过最大右端点 < a 的子树，并在左端点 > b 处停止，O(log N + k)。
+     *       Nodes, rotations and fixups all come from RedBlackTree, and the max endpoint is
+     *       maintained through its Aggregate policy; overlap queries skip subtrees whose max
+     *       endpoint is < a and stop at lower endpoints > b, O(log N + k).
+     */
+    template <typename T, typename Allocator = std::allocator<interval<T>>>
+    class interval_tree
+        : private RedBlackTree<interval<T>, interval_less<T>, Allocator, false, interval_max_end<T>>
+    {
+    private:
+        /// @brief 底层红黑树 / underlying red-black tree.
+        using base = RedBlackTree<interval<T>, interval_less<T>, Allocator, false, interval_max_end<T>>;
+        /// @brief 底层节点 / underlying node.
+        using Node = typename base::Node;
+
+    public:
+        /// @brief 端点类型 / endpoint type.
+        using endpoint_type = T;
+        /// @brief 值类型 / value type.
+        using value_type = interval<T>;
+        /// @brief 大小类型 / size type.
+        using size_type = typename base::size_type;
+        /// @brief 分配器类型 / allocator type.
+        using allocator_type = Allocator;
+        /// @brief 常量迭代器（按 (low, high) 升序）/ const iterator (ascending by (low, high)).
+        using const_iterator = typename base::const_iterator;
+        /// @brief 迭代器类型（与 const_iterator 相同）/ iterator type (same as const_iterator).
+        using iterator = typename base::iterator;
+
+        using base::begin;
+        using base::cbegin;
+        using base::cend;
+        using base::clear;
+        using base::empty;
+        using base::end;
+        using base::get_allocator;
+        using base::size;
+
+        /**
+         * @brief 默认构造空树 / Default constructor, create an empty tree.
+         */
+        interval_tree()
+            : base()
+        {
+        }
+
+        /**
+         * @brief 使用分配器构造 / Construct with allocator.
+         */
+        explicit interval_tree(const Allocator &alloc)
+            : base(interval_less<T>(), alloc)
+        {
+        }
+
+        /**
+         * @brief 使用区间序列构造（经排序后 O(N) 批量建树）
+         *        / Construct from a range of intervals (sorted, then bulk-built in O(N)).
+         *
+         * @throws std::invalid_argument 若有 low > high 的区间 / if some interval has low > high.
+         */
+        template <typename InputIt>
+        interval_tree(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+            : base(interval_less<T>(), alloc)
+        {
+            std::vector<value_type> items(first, last);
+            for (const value_type &iv : items)
+                check(iv);
+            base::insert(items.begin(), items.end());
+        }
+
+        /**
+         * @brief 使用初始化列表构造 / Construct from initializer_list.
+         */
+        interval_tree(std::initializer_list<value_type> init, const Allocator &alloc = Allocator())
+            : interval_tree(init.begin(), init.end(), alloc)
+        {
+        }
+
+        /**
+         * @brief 插入区间 / Insert an interval.
+         *
+         * @return 是否插入成功（相同区间只存一份）/ whether inserted (equal intervals are stored once).
+         * @throws std::invalid_argument 若 low > high / if low > high.
+         */
+        bool insert(const value_type &iv)
+        {
+            check(iv);
+            return base::insert(iv).second;
+        }
+
+        /**
+         * @brief 插入区间 [low, high] / Insert interval [low, high].
+         */
+        bool insert(const T &low, const T &high)
+        {
+            return insert(value_type{low, high});
+        }
+
+        /**
+         * @brief 删除区间 / Erase an interval.
+         *
+         * @return 删除的个数（0 或 1）/ number of erased intervals (0 or 1).
+         */
+        size_type erase(const value_type &iv)
+        {
+            return base::erase(iv);
+        }
+
+        /**
+         * @brief 删除区间 [low, high] / Erase interval [low, high].
+         */
+        size_type erase(const T &low, const T &high)
+        {
+            return base::erase(value_type{low, high});
+        }
+
+        /**
+         * @brief 是否包含该区间 / Whether the interval is stored.
+         */
+        bool contains(const value_type &iv) const
+        {
+            return base::count(iv) != 0;
+        }
+
+        /**
+         * @brief 对每个与 [a, b] 相交的区间按 (low, high) 升序调用 callback，O(log N + k)
+         *        / Call callback on every interval overlapping [a, b], ascending by
+         *        (low, high), O(log N + k).
+         */
+        template <typename F>
+        void overlaps(const T &a, const T &b, F callback) const
+        {
+            overlaps_from(this->root_, a, b, callback);
+        }
+
+        /**
+         * @brief 返回与 [a, b] 相交的全部区间 / Return all intervals overlapping [a, b].
+         */
+        std::vector<value_type> overlaps(const T &a, const T &b) const
+        {
+            std::vector<value_type> out;
+            overlaps(a, b, [&out](const value_type &iv)
+                     { out.push_back(iv); });
+            return out;
+        }
+
+        /**
+         * @brief 批量重叠查询：所有查询共用一次树遍历，对每个命中调用 callback(查询下标, 区间)
+         *        / Batched overlap queries: all queries share one tree traversal, calling
+         *        callback(query index, interval) on every hit.
+         *
+         * @note 每个节点只访问一次，仍活跃的查询在一段下标缓冲里原地划分；
+         *       同一查询的命中按 (low, high) 升序报告。
+         *       Each node is visited once and the still-active queries are partitioned in
+         *       place in one index buffer; hits of one query are reported ascending by
+         *       (low, high).
+         */
+        template <typename F>
+        void overlaps_batch(const std::vector<value_type> &queries, F callback) const
+        {
+            std::vector<std::size_t> active(queries.size());
+            std::iota(active.begin(), active.end(), std::size_t(0));
+            batch_from(this->root_, queries, active.data(), active.data() + active.size(), callback);
+        }
+
+    private:
+        /// @brief 校验端点顺序 / validate endpoint order.
+        static void check(const value_type &iv)
+        {
+            if (iv.high < iv.low)
+                throw std::invalid_argument("interval_tree: interval requires low <= high");
+        }
+
+        /// @brief 单个查询的剪枝遍历 / pruned traversal for one query.
+        template <typename F>
+        void overlaps_from(const Node *x, const T &a, const T &b, F &callback) const
+        {
+            while (x != this->nil_ && !(x->aggregate_ < a))
+            {
+                overlaps_from(x->left, a, b, callback);
+                if (b < x->value.low)
+                    return;
+                if (!(x->value.high < a))
+                    callback(x->value);
+                x = x->right;
+            }
+        }
+
+        /// @brief 批量查询的共享遍历 / shared traversal for batched queries.
+        template <typename F>
+        void batch_from(const Node *x, const std::vector<value_type> &queries,
+                        std::size_t *first, std::size_t *last, F &callback) const
+        {
+            while (x != this->nil_ && first != last)
+            {
+                // 子树最大右端点不够大的查询到此为止
+                // queries beyond the subtree's max endpoint stop here
+                last = std::partition(first, last, [&](std::size_t q)
+                                      { return !(x->aggregate_ < queries[q].low); });
+                if (first == last)
+                    return;
+                batch_from(x->left, queries, first, last, callback);
+
+                // 右子树与本节点左端点都 >= x->value.low
+                // the right subtree and this node all start at >= x->value.low
+                last = std::partition(first, last, [&](std::size_t q)
+                                      { return !(queries[q].high < x->value.low); });
+                for (std::size_t *q = first; q != last; ++q)
+                {
+                    if (!(x->value.high < queries[*q].low))
+                        callback(*q, x->value);
+                }
+                x = x->right;
+            }
+        }
+    }; // class interval_tree
+
+} // namespace test_forest
+
+#endif
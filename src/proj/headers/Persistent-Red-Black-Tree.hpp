@@ -0,0 +1,683 @@
+#ifndef _PERSISTENT_RED_BLACK_TREE_HPP
+#define _PERSISTENT_RED_BLACK_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace test_forest
+{
+
+    /**
+     * @brief 持久化（不可变）红黑树：每次更新返回共享未改动节点的新版本
+     *        / Persistent (immutable) red-black tree: every update returns a new version
+     *        that shares all unchanged nodes.
+     *
+     * @tparam Key       关键字类型 / key type
+     * @tparam Compare   比较器（缺省为 std::less<Key>）/ comparator (default std::less<Key>)
+     * @tparam Allocator 分配器（缺省为 std::allocator<Key>）/ allocator (default std::allocator<Key>)
+     *
+     * @note 以路径复制实现左倾红黑树（LLRB）：insert / erase 只新建 O(log N) 个节点，
+     *       版本之间共享其余节点；节点带原子引用计数，最后一个版本释放时回收。
+     *       Left-leaning red-black tree (LLRB) with path copying: insert / erase create only
+     *       O(log N) new nodes and share the rest between versions; nodes carry an atomic
+     *       reference count and are freed with the last version that uses them.
+     * @note 版本对象本身不可变，拷贝为 O(1)；不同线程可各自持有、读取并派生版本而互不阻塞，
+     *       内存随修改量而非「版本数 × N」增长。
+     *       Version objects are immutable and copy in O(1); threads may hold, read and derive
+     *       versions independently without blocking each other, and memory grows with the
+     *       change volume instead of versions × N.
+     * @note 引用计数为 1 的节点只被当前路径持有，可原地修改，因此对右值版本的更新不复制节点。
+     *       Nodes with a reference count of 1 are held only by the current path and are
+     *       updated in place, so updating an rvalue version copies no nodes.
+     */
+    template <typename Key,
+              typename Compare = std::less<Key>,
+              typename Allocator = std::allocator<Key>>
+    class persistent_red_black_tree
+    {
+    private:
+        /**
+         * @brief 节点 / Node.
+         */
+        struct Node
+        {
+            /// @brief 左子节点指针 / Left child pointer.
+            Node *left;
+            /// @brief 右子节点指针 / Right child pointer.
+            Node *right;
+            /// @brief 存储的键值 / Stored key value.
+            Key value;
+            /// @brief 引用计数（父节点或版本）/ Reference count (parents or versions).
+            std::atomic<std::uint32_t> refs;
+            /// @brief 是否为红色 / Whether the node is red.
+            bool red;
+
+            /**
+             * @brief 构造引用计数为 1 的红色叶子 / Construct a red leaf with one reference.
+             */
+            explicit Node(const Key &v)
+                : left(nullptr), right(nullptr), value(v), refs(1), red(true)
+            {
+            }
+        };
+
+    public:
+        /// @brief 键类型 / key type.
+        using key_type = Key;
+        /// @brief 值类型（与 key_type 相同）/ value type (same as key_type).
+        using value_type = Key;
+        /// @brief 比较器类型 / key comparator type.
+        using key_compare = Compare;
+        /// @brief 分配器类型 / allocator type.
+        using allocator_type = Allocator;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+        /// @brief 差值类型 / difference type.
+        using difference_type = std::ptrdiff_t;
+        /// @brief 常量引用类型 / const reference type.
+        using const_reference = const value_type &;
+
+    private:
+        /// @brief 节点分配器类型 / node allocator type.
+        using node_allocator_type =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        /// @brief 节点分配器 traits / node allocator traits.
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+
+    public:
+        /**
+         * @brief 中序常量迭代器（栈式遍历，节点无 parent 指针）
+         *        / In-order const iterator (stack-based, nodes have no parent pointer).
+         *
+         * @note 迭代器只借用节点，使用期间须保持其版本存活。
+         *       The iterator borrows nodes; keep its version alive while using it.
+         */
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Key;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Key *;
+            using reference = const Key &;
+
+            /**
+             * @brief 构造 end 迭代器 / Construct the end iterator.
+             */
+            const_iterator() = default;
+
+            reference operator*() const { return path_.back()->value; }
+            pointer operator->() const { return &path_.back()->value; }
+
+            const_iterator &operator++()
+            {
+                const Node *n = path_.back();
+                path_.pop_back();
+                push_left(n->right);
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator &a, const const_iterator &b)
+            {
+                if (a.path_.empty() || b.path_.empty())
+                    return a.path_.empty() == b.path_.empty();
+                return a.path_.back() == b.path_.back();
+            }
+
+            friend bool operator!=(const const_iterator &a, const const_iterator &b)
+            {
+                return !(a == b);
+            }
+
+        private:
+            friend class persistent_red_black_tree;
+
+            /// @brief 沿左链压栈 / push the left spine.
+            void push_left(const Node *n)
+            {
+                while (n)
+                {
+                    path_.push_back(n);
+                    n = n->left;
+                }
+            }
+
+            /// @brief 从根到当前节点的待访问祖先 / pending ancestors from root to current.
+            std::vector<const Node *> path_;
+        };
+
+        /// @brief 迭代器类型（与常量迭代器相同）/ iterator type (same as const_iterator).
+        using iterator = const_iterator;
+
+        // ======================== 构造与析构 / Construction ========================
+
+        /**
+         * @brief 默认构造空版本 / Default constructor, create an empty version.
+         */
+        persistent_red_black_tree()
+            : persistent_red_black_tree(Compare())
+        {
+        }
+
+        /**
+         * @brief 使用比较器和分配器构造空版本 / Construct an empty version with comparator and allocator.
+         *
+         * @param comp [in] 比较器 / comparator
+         * @param alloc [in] 分配器 / allocator
+         */
+        explicit persistent_red_black_tree(const Compare &comp,
+                                           const Allocator &alloc = Allocator())
+            : root_(nullptr), size_(0), comp_(comp), node_alloc_(alloc)
+        {
+        }
+
+        /**
+         * @brief 初始化列表构造 / Construct from initializer list.
+         */
+        persistent_red_black_tree(std::initializer_list<value_type> init,
+                                  const Compare &comp = Compare(),
+                                  const Allocator &alloc = Allocator())
+            : persistent_red_black_tree(comp, alloc)
+        {
+            for (const value_type &v : init)
+                *this = std::move(*this).insert(v);
+        }
+
+        /**
+         * @brief 拷贝构造：O(1)，共享全部节点 / Copy constructor: O(1), shares every node.
+         *
+         * @note 分配器直接拷贝而不经 select_on_container_copy_construction：共享的节点可能由任一版本释放，
+         *       所有版本必须使用相等的分配器。
+         *       The allocator is copied as is rather than through select_on_container_copy_construction:
+         *       shared nodes may be freed by any version, so every version must use an equal allocator.
+         */
+        persistent_red_black_tree(const persistent_red_black_tree &other)
+            : root_(retain(other.root_)), size_(other.size_), comp_(other.comp_),
+              node_alloc_(other.node_alloc_)
+        {
+        }
+
+        /**
+         * @brief 移动构造 / Move constructor.
+         */
+        persistent_red_black_tree(persistent_red_black_tree &&other) noexcept
+            : root_(other.root_), size_(other.size_), comp_(std::move(other.comp_)),
+              node_alloc_(std::move(other.node_alloc_))
+        {
+            other.root_ = nullptr;
+            other.size_ = 0;
+        }
+
+        /**
+         * @brief 拷贝赋值（copy-and-swap）/ Copy assignment (copy-and-swap).
+         */
+        persistent_red_black_tree &operator=(const persistent_red_black_tree &other)
+        {
+            if (this != &other)
+            {
+                persistent_red_black_tree tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief 移动赋值 / Move assignment.
+         */
+        persistent_red_black_tree &operator=(persistent_red_black_tree &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release(root_);
+                root_ = other.root_;
+                size_ = other.size_;
+                comp_ = std::move(other.comp_);
+                node_alloc_ = std::move(other.node_alloc_);
+                other.root_ = nullptr;
+                other.size_ = 0;
+            }
+            return *this;
+        }
+
+        /**
+         * @brief 析构：释放本版本对节点的引用 / Destructor: drop this version's node references.
+         */
+        ~persistent_red_black_tree()
+        {
+            release(root_);
+        }
+
+        // ======================== 迭代器 / Iterators ========================
+
+        const_iterator begin() const
+        {
+            const_iterator it;
+            it.push_left(root_);
+            return it;
+        }
+        const_iterator end() const { return const_iterator(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // ======================== 容量 / Capacity ========================
+
+        bool empty() const noexcept { return size_ == 0; }
+        size_type size() const noexcept { return size_; }
+
+        // ======================== 查找 / Lookup ========================
+
+        /**
+         * @brief 是否包含 key / Whether key is present.
+         */
+        bool contains(const key_type &key) const
+        {
+            return find_node(key) != nullptr;
+        }
+
+        /**
+         * @brief 返回等于给定键的元素个数（0 或 1）/ Count elements with a given key (0 or 1).
+         */
+        size_type count(const key_type &key) const
+        {
+            return contains(key) ? 1u : 0u;
+        }
+
+        /**
+         * @brief 查找 key / Find key.
+         */
+        const_iterator find(const key_type &key) const
+        {
+            const_iterator it;
+            const Node *cur = root_;
+            while (cur)
+            {
+                if (comp_(key, cur->value))
+                {
+                    it.path_.push_back(cur);
+                    cur = cur->left;
+                }
+                else if (comp_(cur->value, key))
+                {
+                    cur = cur->right;
+                }
+                else
+                {
+                    it.path_.push_back(cur);
+                    return it;
+                }
+            }
+            return end();
+        }
+
+        // ======================== 派生新版本 / Deriving versions ========================
+
+        /**
+         * @brief 返回插入 value 后的新版本，本版本不变
+         *        / Return a new version with value inserted; this version is unchanged.
+         */
+        persistent_red_black_tree insert(const value_type &value) const &
+        {
+            persistent_red_black_tree next(*this);
+            next.insert_in_place(value);
+            return next;
+        }
+
+        /**
+         * @brief 对右值版本插入：独占的节点原地修改 / Insert into an rvalue version: unshared nodes are updated in place.
+         */
+        persistent_red_black_tree insert(const value_type &value) &&
+        {
+            return std::move(insert_in_place(value));
+        }
+
+        /**
+         * @brief 返回删除 key 后的新版本，本版本不变
+         *        / Return a new version with key erased; this version is unchanged.
+         */
+        persistent_red_black_tree erase(const key_type &key) const &
+        {
+            persistent_red_black_tree next(*this);
+            next.erase_in_place(key);
+            return next;
+        }
+
+        /**
+         * @brief 对右值版本删除：独占的节点原地修改 / Erase from an rvalue version: unshared nodes are updated in place.
+         */
+        persistent_red_black_tree erase(const key_type &key) &&
+        {
+            return std::move(erase_in_place(key));
+        }
+
+        /**
+         * @brief 交换两个版本 / Swap two versions.
+         */
+        void swap(persistent_red_black_tree &other) noexcept
+        {
+            using std::swap;
+            swap(root_, other.root_);
+            swap(size_, other.size_);
+            swap(comp_, other.comp_);
+            swap(node_alloc_, other.node_alloc_);
+        }
+
+        /**
+         * @brief 返回比较器 / Return key comparator.
+         */
+        key_compare key_comp() const { return comp_; }
+
+        /**
+         * @brief 返回节点字节数 / Return the size of one node in bytes.
+         */
+        static constexpr size_type node_size() noexcept { return sizeof(Node); }
+
+    private:
+        /// @brief 根节点（本版本持有一个引用）/ root node (this version holds one reference).
+        Node *root_;
+        /// @brief 元素个数 / number of elements.
+        size_type size_;
+        /// @brief 键比较器 / key comparator.
+        key_compare comp_;
+        /// @brief 节点分配器 / allocator for nodes.
+        node_allocator_type node_alloc_;
+
+        /// @brief 在本对象上插入（本对象须未被共享为他人视图）/ insert into this object.
+        persistent_red_black_tree &insert_in_place(const value_type &value)
+        {
+            if (!contains(value))
+            {
+                root_ = insert_node(root_, value);
+                root_->red = false;
+                ++size_;
+            }
+            return *this;
+        }
+
+        /// @brief 在本对象上删除 / erase from this object.
+        persistent_red_black_tree &erase_in_place(const key_type &key)
+        {
+            if (contains(key))
+            {
+                root_ = own(root_);
+                if (!is_red(root_->left) && !is_red(root_->right))
+                    root_->red = true;
+                root_ = erase_node(root_, key);
+                if (root_)
+                    root_->red = false;
+                --size_;
+            }
+            return *this;
+        }
+
+        // ======================== 引用计数 / Reference counting ========================
+
+        /// @brief 增加引用 / add a reference.
+        static Node *retain(Node *n) noexcept
+        {
+            if (n)
+                n->refs.fetch_add(1, std::memory_order_relaxed);
+            return n;
+        }
+
+        /// @brief 释放引用，归零时递归释放孩子 / drop a reference, freeing children recursively at zero.
+        void release(Node *n) noexcept
+        {
+            while (n && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                release(n->left);
+                Node *r = n->right;
+                destroy_node(n);
+                n = r;
+            }
+        }
+
+        /**
+         * @brief 取得可原地修改的 n（调用者把持有的一个引用交给本函数）
+         *        / Get a modifiable n (the caller hands over the one reference it holds).
+         *
+         * @note 独占时原样返回；否则复制节点、孩子引用加一，并放掉对原节点的引用。
+         *       Returns n itself when unshared; otherwise copies it, retains its children and
+         *       drops the reference to the original.
+         */
+        Node *own(Node *n)
+        {
+            if (n->refs.load(std::memory_order_acquire) == 1)
+                return n;
+            Node *c = create_node(n->value);
+            c->left = retain(n->left);
+            c->right = retain(n->right);
+            c->red = n->red;
+            release(n);
+            return c;
+        }
+
+        /// @brief 是否为红色（空为黑）/ whether red (null is black).
+        static bool is_red(const Node *n) noexcept
+        {
+            return n && n->red;
+        }
+
+        /// @brief 左旋，h 已可修改 / rotate left, h already modifiable.
+        Node *rotate_left(Node *h)
+        {
+            Node *x = own(h->right);
+            h->right = x->left;
+            x->left = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        /// @brief 右旋，h 已可修改 / rotate right, h already modifiable.
+        Node *rotate_right(Node *h)
+        {
+            Node *x = own(h->left);
+            h->left = x->right;
+            x->right = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        /// @brief 翻转 h 及其两个孩子的颜色 / flip the colors of h and its two children.
+        void flip_colors(Node *h)
+        {
+            h->red = !h->red;
+            if (h->left)
+            {
+                h->left = own(h->left);
+                h->left->red = !h->left->red;
+            }
+            if (h->right)
+            {
+                h->right = own(h->right);
+                h->right->red = !h->right->red;
+            }
+        }
+
+        /// @brief 回溯时恢复左倾不变式 / restore the left-leaning invariants on the way up.
+        Node *balance(Node *h)
+        {
+            if (is_red(h->right) && !is_red(h->left))
+                h = rotate_left(h);
+            if (is_red(h->left) && is_red(h->left->left))
+                h = rotate_right(h);
+            if (is_red(h->left) && is_red(h->right))
+                flip_colors(h);
+            return h;
+        }
+
+        /// @brief 向左借红 / move a red link to the left.
+        Node *move_red_left(Node *h)
+        {
+            flip_colors(h);
+            if (is_red(h->right->left))
+            {
+                h->right = rotate_right(h->right);
+                h = rotate_left(h);
+                flip_colors(h);
+            }
+            return h;
+        }
+
+        /// @brief 向右借红 / move a red link to the right.
+        Node *move_red_right(Node *h)
+        {
+            flip_colors(h);
+            if (is_red(h->left->left))
+            {
+                h = rotate_right(h);
+                flip_colors(h);
+            }
+            return h;
+        }
+
+        /**
+         * @brief 路径复制插入（调用者已确认 key 不存在），h 的引用交给本函数
+         *        / Path-copying insert (the caller has checked that key is absent); the
+         *        reference to h is handed over.
+         */
+        Node *insert_node(Node *h, const value_type &value)
+        {
+            if (!h)
+                return create_node(value);
+            h = own(h);
+            if (comp_(value, h->value))
+                h->left = insert_node(h->left, value);
+            else
+                h->right = insert_node(h->right, value);
+            return balance(h);
+        }
+
+        /**
+         * @brief 路径复制删除最小节点，h 已可修改
+         *        / Path-copying erase of the minimum, h already modifiable.
+         */
+        Node *erase_min(Node *h)
+        {
+            if (!h->left)
+            {
+                release(h);
+                return nullptr;
+            }
+            if (!is_red(h->left) && !is_red(h->left->left))
+                h = move_red_left(h);
+            h->left = erase_min(own(h->left));
+            return balance(h);
+        }
+
+        /**
+         * @brief 路径复制删除（调用者已确认 key 存在），h 已可修改
+         *        / Path-copying erase (the caller has checked that key is present), h already
+         *        modifiable.
+         */
+        Node *erase_node(Node *h, const key_type &key)
+        {
+            if (comp_(key, h->value))
+            {
+                if (!is_red(h->left) && !is_red(h->left->left))
+                    h = move_red_left(h);
+                h->left = erase_node(own(h->left), key);
+            }
+            else
+            {
+                if (is_red(h->left))
+                    h = rotate_right(h);
+                if (key_equal(key, h->value) && !h->right)
+                {
+                    release(h);
+                    return nullptr;
+                }
+                if (!is_red(h->right) && !is_red(h->right->left))
+                    h = move_red_right(h);
+                if (key_equal(key, h->value))
+                {
+                    const Node *m = h->right;
+                    while (m->left)
+                        m = m->left;
+                    h->value = m->value;
+                    h->right = erase_min(own(h->right));
+                }
+                else
+                {
+                    h->right = erase_node(own(h->right), key);
+                }
+            }
+            return balance(h);
+        }
+
+        // ======================== 内部工具函数 / Internal helpers ========================
+
+        /// @brief 判断两个键是否等价 / check whether two keys are equivalent.
+        bool key_equal(const key_type &a, const key_type &b) const
+        {
+            return !comp_(a, b) && !comp_(b, a);
+        }
+
+        /// @brief 查找节点 / find a node.
+        const Node *find_node(const key_type &key) const
+        {
+            const Node *cur = root_;
+            while (cur)
+            {
+                if (comp_(key, cur->value))
+                    cur = cur->left;
+                else if (comp_(cur->value, key))
+                    cur = cur->right;
+                else
+                    return cur;
+            }
+            return nullptr;
+        }
+
+        /// @brief 创建引用计数为 1 的节点 / create a node holding one reference.
+        Node *create_node(const value_type &value)
+        {
+            Node *n = node_alloc_traits::allocate(node_alloc_, 1);
+            try
+            {
+                node_alloc_traits::construct(node_alloc_, n, value);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(node_alloc_, n, 1);
+                throw;
+            }
+            return n;
+        }
+
+        /// @brief 销毁节点 / destroy a node.
+        void destroy_node(Node *node) noexcept
+        {
+            node_alloc_traits::destroy(node_alloc_, node);
+            node_alloc_traits::deallocate(node_alloc_, node, 1);
+        }
+    }; // class persistent_red_black_tree
+
+    /**
+     * @brief 非成员 swap / Non-member swap.
+     */
+    template <typename Key, typename Compare, typename Allocator>
+    void swap(persistent_red_black_tree<Key, Compare, Allocator> &a,
+              persistent_red_black_tree<Key, Compare, Allocator> &b) noexcept
+    {
+        a.swap(b);
+    }
+
+} // namespace test_forest
+
+#endif
@@ -0,0 +1,697 @@
+#ifndef _RCU_RED_BLACK_TREE_HPP
+#define _RCU_RED_BLACK_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace test_forest
+{
+
+    /**
+     * @brief 读者无锁、写者串行的 RCU 风格红黑树（std::set 风格的查找子集）
+     *        / RCU-style red-black tree with lock-free readers and serialized writers
+     *        (lookup subset of the std::set interface).
+     *
+     * @tparam Key       关键字类型 / key type
+     * @tparam Compare   比较器（缺省为 std::less<Key>）/ comparator (default std::less<Key>)
+     * @tparam Allocator 分配器（缺省为 std::allocator<Key>）/ allocator (default std::allocator<Key>)
+     *
+     * @note 写者持有内部互斥锁，以路径复制修改左倾红黑树（LLRB）：已发布的节点从不原地修改，
+     *       新根以 release 语义一次性发布。
+     *       Writers hold an internal mutex and modify a left-leaning red-black tree (LLRB) by
+     *       path copying: published nodes are never changed in place, and the new root is
+     *       published in one release store.
+     * @note 读者不加锁：在自己的读者槽登记当前纪元后以 acquire 载入根，遍历的是一个不可变快照；
+     *       读者槽按线程分散在不同缓存行上，读者之间不写共享缓存行。
+     *       Readers take no lock: they register the current epoch in their reader slot, load
+     *       the root with acquire and walk an immutable snapshot; slots are spread per thread
+     *       over separate cache lines, so readers write no shared cache line.
+     * @note 被替换的节点按纪元退休，纪元前进两次（期间旧纪元的读者都已离开）后释放。
+     *       Replaced nodes are retired by epoch and freed once the epoch has advanced twice,
+     *       by which time every reader of the old epoch has left.
+     */
+    template <typename Key,
+              typename Compare = std::less<Key>,
+              typename Allocator = std::allocator<Key>>
+    class rcu_red_black_tree
+    {
+    private:
+        /**
+         * @brief 节点 / Node.
+         *
+         * @note 发布后只读；fresh 标记本次写事务新建、尚未发布、可原地修改的节点。
+         *       Read-only once published; fresh marks nodes created by the current write
+         *       transaction, not yet published and safe to modify in place.
+         */
+        struct Node
+        {
+            /// @brief 左子节点指针 / Left child pointer.
+            Node *left;
+            /// @brief 右子节点指针 / Right child pointer.
+            Node *right;
+            /// @brief 存储的键值 / Stored key value.
+            Key value;
+            /// @brief 是否为红色 / Whether the node is red.
+            bool red;
+            /// @brief 是否为本事务新建 / Whether created by the current transaction.
+            bool fresh;
+
+            /**
+             * @brief 构造本事务新建的红色叶子 / Construct a fresh red leaf.
+             */
+            explicit Node(const Key &v)
+                : left(nullptr), right(nullptr), value(v), red(true), fresh(true)
+            {
+            }
+        };
+
+        /**
+         * @brief 读者槽：按纪元奇偶分别计数的活跃读者，独占一条缓存行
+         *        / Reader slot: active readers counted per epoch parity, on its own cache line.
+         */
+        struct alignas(64) reader_slot
+        {
+            std::atomic<std::uint64_t> active[2] = {};
+        };
+
+        /// @brief 读者槽个数 / Number of reader slots.
+        static constexpr std::size_t slot_count = 64;
+
+    public:
+        /// @brief 键类型 / key type.
+        using key_type = Key;
+        /// @brief 值类型（与 key_type 相同）/ value type (same as key_type).
+        using value_type = Key;
+        /// @brief 比较器类型 / key comparator type.
+        using key_compare = Compare;
+        /// @brief 分配器类型 / allocator type.
+        using allocator_type = Allocator;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+
+    private:
+        /// @brief 节点分配器类型 / node allocator type.
+        using node_allocator_type =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        /// @brief 节点分配器 traits / node allocator traits.
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+
+        /**
+         * @brief 读临界区守卫：构造时登记，析构时注销
+         *        / Read-side critical section guard: registers on construction, leaves on
+         *        destruction.
+         */
+        class read_guard
+        {
+        public:
+            explicit read_guard(const rcu_red_black_tree &tree) noexcept
+                : slot_(tree.slots_[slot_index()])
+            {
+                parity_ = static_cast<std::size_t>(tree.epoch_.load(std::memory_order_seq_cst) & 1);
+                slot_.active[parity_].fetch_add(1, std::memory_order_seq_cst);
+            }
+
+            ~read_guard()
+            {
+                slot_.active[parity_].fetch_sub(1, std::memory_order_release);
+            }
+
+            read_guard(const read_guard &) = delete;
+            read_guard &operator=(const read_guard &) = delete;
+
+        private:
+            /// @brief 所用读者槽 / reader slot in use.
+            reader_slot &slot_;
+            /// @brief 登记时纪元的奇偶 / epoch parity at registration.
+            std::size_t parity_;
+        };
+
+        /**
+         * @brief 写事务守卫：未提交就析构时回滚，已发布的树保持原样
+         *        / Write transaction guard: rolls back when destroyed without a commit, leaving
+         *        the published tree untouched.
+         *
+         * @note 比较器、键的拷贝或分配器在路径复制中途抛出时，fresh_ 里的副本尚未被任何读者看到，
+         *       retired_ 里的原节点仍挂在已发布的树上：前者直接销毁，后者只是清空而不回收。
+         *       When the comparator, a key copy or the allocator throws halfway through path
+         *       copying, the copies in fresh_ have never been seen by a reader while the
+         *       originals in retired_ still hang off the published tree: the former are
+         *       destroyed, the latter merely forgotten rather than reclaimed.
+         */
+        class write_transaction
+        {
+        public:
+            explicit write_transaction(rcu_red_black_tree &tree) noexcept
+                : tree_(tree)
+            {
+            }
+
+            ~write_transaction()
+            {
+                if (!committed_)
+                    tree_.rollback();
+            }
+
+            write_transaction(const write_transaction &) = delete;
+            write_transaction &operator=(const write_transaction &) = delete;
+
+            /// @brief 发布新根并提交 / publish the new root and commit.
+            void commit(Node *root)
+            {
+                tree_.publish(root);
+                committed_ = true;
+            }
+
+        private:
+            /// @brief 所属的树 / owning tree.
+            rcu_red_black_tree &tree_;
+            /// @brief 是否已提交 / whether committed.
+            bool committed_ = false;
+        };
+
+    public:
+        /**
+         * @brief 默认构造空树 / Default constructor, create an empty tree.
+         */
+        rcu_red_black_tree()
+            : rcu_red_black_tree(Compare())
+        {
+        }
+
+        /**
+         * @brief 使用比较器和分配器构造 / Construct with comparator and allocator.
+         *
+         * @param comp [in] 比较器 / comparator
+         * @param alloc [in] 分配器 / allocator
+         */
+        explicit rcu_red_black_tree(const Compare &comp,
+                                    const Allocator &alloc = Allocator())
+            : root_(nullptr), size_(0), epoch_(0), comp_(comp), node_alloc_(alloc)
+        {
+        }
+
+        rcu_red_black_tree(const rcu_red_black_tree &) = delete;
+        rcu_red_black_tree &operator=(const rcu_red_black_tree &) = delete;
+
+        /**
+         * @brief 析构函数：此时不得再有读者 / Destructor: no reader may remain.
+         */
+        ~rcu_red_black_tree()
+        {
+            destroy_subtree(root_.load(std::memory_order_relaxed));
+            for (auto &batch : limbo_)
+            {
+                for (Node *n : batch.second)
+                    destroy_node(n);
+            }
+        }
+
+        // ======================== 读者接口 / Reader interface ========================
+
+        /**
+         * @brief 是否包含 key（无锁）/ Whether key is present (lock-free).
+         */
+        bool contains(const key_type &key) const
+        {
+            read_guard guard(*this);
+            const Node *cur = root_.load(std::memory_order_seq_cst);
+            while (cur)
+            {
+                if (comp_(key, cur->value))
+                    cur = cur->left;
+                else if (comp_(cur->value, key))
+                    cur = cur->right;
+                else
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief 返回等于给定键的元素个数（0 或 1）/ Count elements with a given key (0 or 1).
+         */
+        size_type count(const key_type &key) const
+        {
+            return contains(key) ? 1u : 0u;
+        }
+
+        /**
+         * @brief 在同一快照上按中序对每个元素调用 f（无锁）
+         *        / Call f on every element in order, all from one snapshot (lock-free).
+         */
+        template <typename F>
+        void for_each(F f) const
+        {
+            read_guard guard(*this);
+            visit(root_.load(std::memory_order_seq_cst), f);
+        }
+
+        /**
+         * @brief 返回元素个数 / Return number of elements.
+         */
+        size_type size() const noexcept
+        {
+            return size_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 是否为空 / Check whether container is empty.
+         */
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        // ======================== 写者接口 / Writer interface ========================
+
+        /**
+         * @brief 插入一个元素（写者之间互斥）/ Insert one element (writers are serialized).
+         *
+         * @return 是否插入成功 / whether inserted.
+         */
+        bool insert(const value_type &value)
+        {
+            std::lock_guard<std::mutex> lock(write_lock_);
+            Node *root = root_.load(std::memory_order_relaxed);
+            if (find_node(root, value))
+                return false;
+
+            write_transaction txn(*this);
+            root = insert_node(root, value);
+            root->red = false;
+            txn.commit(root);
+            size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief 按键值删除元素（写者之间互斥）/ Erase element with given key (writers are serialized).
+         *
+         * @return 删除的元素个数（0 或 1）/ number of erased elements (0 or 1).
+         */
+        size_type erase(const key_type &key)
+        {
+            std::lock_guard<std::mutex> lock(write_lock_);
+            Node *root = root_.load(std::memory_order_relaxed);
+            if (!find_node(root, key))
+                return 0;
+
+            write_transaction txn(*this);
+            root = own(root);
+            if (!is_red(root->left) && !is_red(root->right))
+                root->red = true;
+            root = erase_node(root, key);
+            if (root)
+                root->red = false;
+            txn.commit(root);
+            size_.store(size_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            return 1;
+        }
+
+        /**
+         * @brief 清空容器，旧节点按纪元回收 / Clear the container; old nodes are reclaimed by epoch.
+         */
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(write_lock_);
+            write_transaction txn(*this);
+            collect_subtree(root_.load(std::memory_order_relaxed));
+            txn.commit(nullptr);
+            size_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        /// @brief 当前根（发布点）/ current root (publication point).
+        std::atomic<Node *> root_;
+        /// @brief 元素个数 / number of elements.
+        std::atomic<size_type> size_;
+        /// @brief 全局纪元 / global epoch.
+        std::atomic<std::uint64_t> epoch_;
+        /// @brief 读者槽 / reader slots.
+        mutable reader_slot slots_[slot_count];
+        /// @brief 键比较器 / key comparator.
+        key_compare comp_;
+        /// @brief 节点分配器 / allocator for nodes.
+        node_allocator_type node_alloc_;
+        /// @brief 写者互斥锁 / writer mutex.
+        std::mutex write_lock_;
+        /// @brief 本事务新建的节点 / nodes created by the current transaction.
+        std::vector<Node *> fresh_;
+        /// @brief 本事务退休的节点 / nodes retired by the current transaction.
+        std::vector<Node *> retired_;
+        /// @brief 待回收批次（退休时纪元, 节点）/ batches awaiting reclamation (epoch, nodes).
+        std::deque<std::pair<std::uint64_t, std::vector<Node *>>> limbo_;
+
+        // ======================== 纪元回收 / Epoch reclamation ========================
+
+        /**
+         * @brief 本线程使用的读者槽下标 / Reader slot index of the calling thread.
+         */
+        static std::size_t slot_index() noexcept
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % slot_count;
+            return index;
+        }
+
+        /**
+         * @brief 发布新根，退休本事务替换下的节点并尝试回收
+         *        / Publish the new root, retire the nodes it replaced and try to reclaim.
+         *
+         * @note 唯一可能抛出的一步（为退休批次占位）放在发布之前，抛出时由写事务回滚。
+         *       The only step that may throw (making room for the retired batch) comes before
+         *       the root is published, so a throw is rolled back by the write transaction.
+         */
+        void publish(Node *root)
+        {
+            if (!retired_.empty())
+                limbo_.emplace_back(epoch_.load(std::memory_order_relaxed), std::vector<Node *>());
+
+            // 发布前清掉 fresh 标记：发布后节点只读
+            // clear fresh marks before publishing: nodes are read-only afterwards
+            for (Node *n : fresh_)
+                n->fresh = false;
+            fresh_.clear();
+
+            root_.store(root, std::memory_order_seq_cst);
+
+            if (!retired_.empty())
+            {
+                limbo_.back().second.swap(retired_);
+                retired_.clear();
+            }
+            try_advance();
+            try_advance();
+
+            std::uint64_t e = epoch_.load(std::memory_order_relaxed);
+            while (!limbo_.empty() && limbo_.front().first + 2 <= e)
+            {
+                for (Node *n : limbo_.front().second)
+                    destroy_node(n);
+                limbo_.pop_front();
+            }
+        }
+
+        /**
+         * @brief 上一纪元的读者全部离开时把纪元加一
+         *        / Advance the epoch by one once every reader of the previous epoch has left.
+         *
+         * @note 在纪元 e 退休的节点，纪元到达 e + 2 时两种奇偶的旧读者都已排空。
+         *       For nodes retired in epoch e, old readers of both parities have drained by the
+         *       time the epoch reaches e + 2.
+         */
+        void try_advance() noexcept
+        {
+            std::uint64_t e = epoch_.load(std::memory_order_relaxed);
+            std::size_t previous = static_cast<std::size_t>((e + 1) & 1);
+            for (const reader_slot &slot : slots_)
+            {
+                if (slot.active[previous].load(std::memory_order_seq_cst) != 0)
+                    return;
+            }
+            epoch_.store(e + 1, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief 撤销未发布的写事务：销毁本事务新建的节点，忘掉尚未生效的退休记录
+         *        / Undo an unpublished write transaction: destroy the nodes it created and
+         *        forget the retirements that never took effect.
+         */
+        void rollback() noexcept
+        {
+            for (Node *n : fresh_)
+                destroy_node(n);
+            fresh_.clear();
+            retired_.clear();
+        }
+
+        // ======================== 路径复制 / Path copying ========================
+
+        /**
+         * @brief 取得可原地修改的 n：本事务新建的直接返回，否则复制并退休原节点
+         *        / Get a modifiable n: fresh nodes are returned as is, others are copied and
+         *        the original is retired.
+         */
+        Node *own(Node *n)
+        {
+            if (n->fresh)
+                return n;
+            Node *c = create_node(n->value);
+            c->left = n->left;
+            c->right = n->right;
+            c->red = n->red;
+            retired_.push_back(n);
+            return c;
+        }
+
+        /// @brief 是否为红色（空为黑）/ whether red (null is black).
+        static bool is_red(const Node *n) noexcept
+        {
+            return n && n->red;
+        }
+
+        /// @brief 左旋，h 已可修改 / rotate left, h already modifiable.
+        Node *rotate_left(Node *h)
+        {
+            Node *x = own(h->right);
+            h->right = x->left;
+            x->left = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        /// @brief 右旋，h 已可修改 / rotate right, h already modifiable.
+        Node *rotate_right(Node *h)
+        {
+            Node *x = own(h->left);
+            h->left = x->right;
+            x->right = h;
+            x->red = h->red;
+            h->red = true;
+            return x;
+        }
+
+        /// @brief 翻转 h 及其两个孩子的颜色 / flip the colors of h and its two children.
+        void flip_colors(Node *h)
+        {
+            h->red = !h->red;
+            if (h->left)
+            {
+                h->left = own(h->left);
+                h->left->red = !h->left->red;
+            }
+            if (h->right)
+            {
+                h->right = own(h->right);
+                h->right->red = !h->right->red;
+            }
+        }
+
+        /// @brief 回溯时恢复左倾不变式 / restore the left-leaning invariants on the way up.
+        Node *balance(Node *h)
+        {
+            if (is_red(h->right) && !is_red(h->left))
+                h = rotate_left(h);
+            if (is_red(h->left) && is_red(h->left->left))
+                h = rotate_right(h);
+            if (is_red(h->left) && is_red(h->right))
+                flip_colors(h);
+            return h;
+        }
+
+        /// @brief 向左借红 / move a red link to the left.
+        Node *move_red_left(Node *h)
+        {
+            flip_colors(h);
+            if (is_red(h->right->left))
+            {
+                h->right = rotate_right(h->right);
+                h = rotate_left(h);
+                flip_colors(h);
+            }
+            return h;
+        }
+
+        /// @brief 向右借红 / move a red link to the right.
+        Node *move_red_right(Node *h)
+        {
+            flip_colors(h);
+            if (is_red(h->left->left))
+            {
+                h = rotate_right(h);
+                flip_colors(h);
+            }
+            return h;
+        }
+
+        /**
+         * @brief 路径复制插入（调用者已确认 key 不存在）
+         *        / Path-copying insert (the caller has checked that key is absent).
+         */
+        Node *insert_node(Node *h, const value_type &value)
+        {
+            if (!h)
+                return create_node(value);
+            h = own(h);
+            if (comp_(value, h->value))
+                h->left = insert_node(h->left, value);
+            else
+                h->right = insert_node(h->right, value);
+            return balance(h);
+        }
+
+        /**
+         * @brief 路径复制删除最小节点，h 已可修改
+         *        / Path-copying erase of the minimum, h already modifiable.
+         */
+        Node *erase_min(Node *h)
+        {
+            if (!h->left)
+            {
+                retired_.push_back(h);
+                return nullptr;
+            }
+            if (!is_red(h->left) && !is_red(h->left->left))
+                h = move_red_left(h);
+            h->left = erase_min(own(h->left));
+            return balance(h);
+        }
+
+        /**
+         * @brief 路径复制删除（调用者已确认 key 存在），h 已可修改
+         *        / Path-copying erase (the caller has checked that key is present), h already
+         *        modifiable.
+         */
+        Node *erase_node(Node *h, const key_type &key)
+        {
+            if (comp_(key, h->value))
+            {
+                if (!is_red(h->left) && !is_red(h->left->left))
+                    h = move_red_left(h);
+                h->left = erase_node(own(h->left), key);
+            }
+            else
+            {
+                if (is_red(h->left))
+                    h = rotate_right(h);
+                if (key_equal(key, h->value) && !h->right)
+                {
+                    retired_.push_back(h);
+                    return nullptr;
+                }
+                if (!is_red(h->right) && !is_red(h->right->left))
+                    h = move_red_right(h);
+                if (key_equal(key, h->value))
+                {
+                    const Node *m = h->right;
+                    while (m->left)
+                        m = m->left;
+                    h->value = m->value;
+                    h->right = erase_min(own(h->right));
+                }
+                else
+                {
+                    h->right = erase_node(own(h->right), key);
+                }
+            }
+            return balance(h);
+        }
+
+        // ======================== 内部工具函数 / Internal helpers ========================
+
+        /// @brief 判断两个键是否等价 / check whether two keys are equivalent.
+        bool key_equal(const key_type &a, const key_type &b) const
+        {
+            return !comp_(a, b) && !comp_(b, a);
+        }
+
+        /// @brief 在子树中查找 / find in a subtree.
+        const Node *find_node(const Node *cur, const key_type &key) const
+        {
+            while (cur)
+            {
+                if (comp_(key, cur->value))
+                    cur = cur->left;
+                else if (comp_(cur->value, key))
+                    cur = cur->right;
+                else
+                    return cur;
+            }
+            return nullptr;
+        }
+
+        /// @brief 中序访问子树 / visit a subtree in order.
+        template <typename F>
+        static void visit(const Node *n, F &f)
+        {
+            while (n)
+            {
+                visit(n->left, f);
+                f(n->value);
+                n = n->right;
+            }
+        }
+
+        /// @brief 创建本事务新建的节点 / create a node of the current transaction.
+        Node *create_node(const value_type &value)
+        {
+            // 先留好 fresh_ 的位置，节点建好后登记不会再抛出
+            // reserve the fresh_ slot first so registering the finished node cannot throw
+            if (fresh_.size() == fresh_.capacity())
+                fresh_.reserve(fresh_.empty() ? 16 : 2 * fresh_.size());
+            Node *n = node_alloc_traits::allocate(node_alloc_, 1);
+            try
+            {
+                node_alloc_traits::construct(node_alloc_, n, value);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(node_alloc_, n, 1);
+                throw;
+            }
+            fresh_.push_back(n);
+            return n;
+        }
+
+        /// @brief 销毁节点 / destroy a node.
+        void destroy_node(Node *node) noexcept
+        {
+            node_alloc_traits::destroy(node_alloc_, node);
+            node_alloc_traits::deallocate(node_alloc_, node, 1);
+        }
+
+        /// @brief 立即销毁子树 / destroy a subtree immediately.
+        void destroy_subtree(Node *node) noexcept
+        {
+            while (node)
+            {
+                destroy_subtree(node->left);
+                Node *r = node->right;
+                destroy_node(node);
+                node = r;
+            }
+        }
+
+        /// @brief 把子树全部退休 / retire a whole subtree.
+        void collect_subtree(Node *node)
+        {
+            while (node)
+            {
+                collect_subtree(node->left);
+                retired_.push_back(node);
+                node = node->right;
+            }
+        }
+    }; // class rcu_red_black_tree
+
+} // namespace test_forest
+
+#endif
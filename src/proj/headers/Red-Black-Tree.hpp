@@ -1,15 +1,163 @@
 #ifndef _RED_BLACK_TREE_HPP
 #define _RED_BLACK_TREE_HPP
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <iterator>
+#include <limits>
 
 namespace test_forest
 {
 
+    /**
+     * @brief 红黑树节点颜色 / Node color of red-black tree.
+     */
+    enum class rb_color : unsigned char
+    {
+        Red,
+        Black
+    };
+
+    /**
+     * @brief 红黑树节点的父指针与颜色，分开存放（缺省）
+     *        / Parent pointer and color of a red-black node, stored separately (default).
+     *
+     * @tparam NodeT   节点类型 / node type
+     * @tparam Packed  是否把颜色打包进父指针 / whether the color is packed into the parent pointer
+     */
+    template <typename NodeT, bool Packed>
+    struct rb_parent_color
+    {
+        /// @brief 父节点指针 / Parent pointer.
+        NodeT *parent_ = nullptr;
+        /// @brief 节点颜色 / Node color.
+        rb_color color_ = rb_color::Black;
+
+        NodeT *parent() const noexcept { return parent_; }
+        void set_parent(NodeT *p) noexcept { parent_ = p; }
+        rb_color color() const noexcept { return color_; }
+        void set_color(rb_color c) noexcept { color_ = c; }
+    };
+
+    /**
+     * @brief 颜色存于父指针最低位（1 为黑），省去颜色字段及其填充
+     *        / Color kept in the lowest bit of the parent pointer (1 = black), saving the color
+     *        field and its padding.
+     */
+    template <typename NodeT>
+    struct rb_parent_color<NodeT, true>
+    {
+        /// @brief 父指针 | 颜色位 / Parent pointer | color bit.
+        std::uintptr_t parent_color_ = 1;
+
+        NodeT *parent() const noexcept
+        {
+            return reinterpret_cast<NodeT *>(parent_color_ & ~std::uintptr_t(1));
+        }
+        void set_parent(NodeT *p) noexcept
+        {
+            parent_color_ = reinterpret_cast<std::uintptr_t>(p) | (parent_color_ & 1);
+        }
+        rb_color color() const noexcept
+        {
+            return (parent_color_ & 1) ? rb_color::Black : rb_color::Red;
+        }
+        void set_color(rb_color c) noexcept
+        {
+            parent_color_ = (parent_color_ & ~std::uintptr_t(1)) |
+                            (c == rb_color::Black ? std::uintptr_t(1) : std::uintptr_t(0));
+        }
+    };
+
+    /**
+     * @brief 缺省的空聚合策略：节点不带聚合字段，维护代码全部编译期消去
+     *        / Default empty aggregate policy: nodes carry no aggregate field and all
+     *        maintenance code is compiled out.
+     */
+    struct rb_no_aggregate
+    {
+    };
+
+    /**
+     * @brief 计数幺半群 / Count monoid.
+     *
+     * @note 聚合策略须提供 value_type、identity()、lift(key) 与满足结合律的 combine(a, b)；
+     *       combine 不必可交换，结果按中序组合。
+     *       An aggregate policy provides value_type, identity(), lift(key) and an associative
+     *       combine(a, b); combine need not commute, results are combined in key order.
+     */
+    struct rb_count_monoid
+    {
+        using value_type = std::size_t;
+        static value_type identity() noexcept { return 0; }
+        template <typename Key>
+        static value_type lift(const Key &) noexcept { return 1; }
+        static value_type combine(value_type a, value_type b) noexcept { return a + b; }
+    };
+
+    /**
+     * @brief 求和幺半群 / Sum monoid.
+     *
+     * @tparam Acc 累加类型 / accumulator type
+     */
+    template <typename Acc = long long>
+    struct rb_sum_monoid
+    {
+        using value_type = Acc;
+        static value_type identity() { return Acc(); }
+        template <typename Key>
+        static value_type lift(const Key &key) { return static_cast<Acc>(key); }
+        static value_type combine(const value_type &a, const value_type &b) { return a + b; }
+    };
+
+    /**
+     * @brief 最小值幺半群（单位元为该类型最大值）/ Min monoid (identity is the type's maximum).
+     */
+    template <typename T>
+    struct rb_min_monoid
+    {
+        using value_type = T;
+        static value_type identity() { return std::numeric_limits<T>::max(); }
+        static value_type lift(const T &key) { return key; }
+        static value_type combine(const value_type &a, const value_type &b) { return b < a ? b : a; }
+    };
+
+    /**
+     * @brief 最大值幺半群（单位元为该类型最小值）/ Max monoid (identity is the type's lowest value).
+     */
+    template <typename T>
+    struct rb_max_monoid
+    {
+        using value_type = T;
+        static value_type identity() { return std::numeric_limits<T>::lowest(); }
+        static value_type lift(const T &key) { return key; }
+        static value_type combine(const value_type &a, const value_type &b) { return a < b ? b : a; }
+    };
+
+    /**
+     * @brief 节点的子树聚合字段 / Subtree aggregate field of a node.
+     */
+    template <typename Aggregate>
+    struct rb_aggregate_field
+    {
+        /// @brief 子树聚合值 / Subtree aggregate.
+        typename Aggregate::value_type aggregate_ = Aggregate::identity();
+    };
+
+    /**
+     * @brief 空聚合策略不占空间 / The empty aggregate policy takes no space.
+     */
+    template <>
+    struct rb_aggregate_field<rb_no_aggregate>
+    {
+    };
+
     /**
      * @brief 红黑树（std::set 风格有序集合）/ Red-black tree (std::set-style ordered set).
      *
@@ -19,21 +167,26 @@ namespace test_forest
      * @tparam Key      关键字类型 / key type
      * @tparam Compare  比较器（缺省为 std::less<Key>）/ comparator (default std::less<Key>)
      * @tparam Allocator 分配器（缺省为 std::allocator<Key>）/ allocator (default std::allocator<Key>)
+     * @tparam PackedColor 是否把颜色存进父指针最低位（int 键节点由 40 字节降为 32 字节）
+     *                     / whether the color lives in the lowest bit of the parent pointer
+     *                     (an int node shrinks from 40 to 32 bytes)
+     * @tparam Aggregate   子树聚合幺半群，维护后 aggregate(lo, hi) 为 O(log N)；缺省无开销
+     *                     / subtree aggregate monoid, maintained so that aggregate(lo, hi) is
+     *                     O(log N); the default costs nothing
      */
     template <typename Key,
               typename Compare = std::less<Key>,
-              typename Allocator = std::allocator<Key>>
+              typename Allocator = std::allocator<Key>,
+              bool PackedColor = false,
+              typename Aggregate = rb_no_aggregate>
     class RedBlackTree
     {
-    private:
-        /**
-         * @brief 节点颜色 / Node color.
-         */
-        enum class Color : unsigned char
-        {
-            Red,
-            Black
-        };
+    protected:
+        // 节点结构与内部工具对派生容器（如 interval_tree）开放
+        // Node layout and internal helpers are open to derived containers (e.g. interval_tree)
+
+        /// @brief 节点颜色 / Node color.
+        using Color = rb_color;
 
         /**
          * @brief 红黑树节点结构 / Node structure of red-black tree.
@@ -41,25 +194,25 @@ namespace test_forest
          * @note 这里所有空指针都被统一为哨兵节点 nil_，用来消除特殊情况。
          *       All "null" children are represented by the sentinel node nil_
          *       to eliminate special cases.
+         * @note 父指针与颜色经 parent()/set_parent()/color()/set_color() 访问，
+         *       存储方式由 PackedColor 决定。
+         *       Parent and color are accessed through parent()/set_parent()/color()/set_color();
+         *       PackedColor decides how they are stored.
          */
-        struct Node
+        struct Node : rb_parent_color<Node, PackedColor>, rb_aggregate_field<Aggregate>
         {
-            /// @brief 父节点指针 / Parent pointer.
-            Node *parent;
             /// @brief 左子节点指针 / Left child pointer.
             Node *left;
             /// @brief 右子节点指针 / Right child pointer.
             Node *right;
-            /// @brief 节点颜色 / Node color.
-            Color color;
             /// @brief 存储的键值 / Stored key value.
             Key value;
 
             /**
-             * @brief 默认构造节点 / Default constructor.
+             * @brief 默认构造节点（黑色）/ Default constructor (black).
              */
             Node()
-                : parent(nullptr), left(nullptr), right(nullptr), color(Color::Black), value()
+                : left(nullptr), right(nullptr), value()
             {
             }
 
@@ -71,11 +224,19 @@ namespace test_forest
              * @param nil  [in] 哨兵节点指针，用于初始化子指针 / sentinel pointer to init children
              */
             Node(const Key &v, Color c, Node *nil)
-                : parent(nil), left(nil), right(nil), color(c), value(v)
+                : left(nil), right(nil), value(v)
             {
+                this->set_parent(nil);
+                this->set_color(c);
             }
         };
 
+        static_assert(!PackedColor || alignof(Node) >= 2,
+                      "RedBlackTree needs a free pointer bit to pack the color");
+
+        /// @brief 是否维护子树聚合 / whether subtree aggregates are maintained.
+        static constexpr bool has_aggregate = !std::is_same_v<Aggregate, rb_no_aggregate>;
+
     public:
         /// @brief 键类型 / key type.
         using key_type = Key;
@@ -248,11 +409,11 @@ namespace test_forest
                     return;
                 }
 
-                Node *parent = node_->parent;
+                Node *parent = node_->parent();
                 while (parent != nil_ && node_ == parent->right)
                 {
                     node_ = parent;
-                    parent = parent->parent;
+                    parent = parent->parent();
                 }
                 node_ = parent;
             }
@@ -286,11 +447,11 @@ namespace test_forest
                     return;
                 }
 
-                Node *parent = node_->parent;
+                Node *parent = node_->parent();
                 while (parent != nil_ && node_ == parent->left)
                 {
                     node_ = parent;
-                    parent = parent->parent;
+                    parent = parent->parent();
                 }
                 node_ = parent;
             }
@@ -589,6 +750,14 @@ namespace test_forest
             return node_alloc_traits::max_size(node_alloc_);
         }
 
+        /**
+         * @brief 单个节点占用的字节数 / Bytes occupied by one node.
+         */
+        static constexpr size_type node_size() noexcept
+        {
+            return sizeof(Node);
+        }
+
         // ======================== 修改器 / Modifiers ========================
 
         /**
@@ -603,7 +772,7 @@ namespace test_forest
                 return;
             destroy_subtree(root_);
             root_ = nil_;
-            nil_->parent = nullptr;
+            nil_->set_parent(nullptr);
             nil_->left = nil_;
             nil_->right = nil_;
             size_ = 0;
@@ -640,7 +809,7 @@ namespace test_forest
             }
 
             Node *z = create_node(value);
-            z->parent = y;
+            z->set_parent(y);
 
             if (y == nil_)
             {
@@ -702,7 +871,7 @@ namespace test_forest
                     if (max->right == nil_)
                     {
                         Node *z = create_node(value);
-                        z->parent = max;
+                        z->set_parent(max);
                         max->right = z;
                         insert_fixup(z);
                         ++size_;
@@ -738,7 +907,7 @@ namespace test_forest
                         if (h->left == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = h;
+                            z->set_parent(h);
                             h->left = z;
                             insert_fixup(z);
                             ++size_;
@@ -763,7 +932,7 @@ namespace test_forest
                         if (prev->right == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = prev;
+                            z->set_parent(prev);
                             prev->right = z;
                             insert_fixup(z);
                             ++size_;
@@ -773,7 +942,7 @@ namespace test_forest
                         else if (h->left == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = h;
+                            z->set_parent(h);
                             h->left = z;
                             insert_fixup(z);
                             ++size_;
@@ -801,7 +970,7 @@ namespace test_forest
                         if (h->right == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = h;
+                            z->set_parent(h);
                             h->right = z;
                             insert_fixup(z);
                             ++size_;
@@ -822,7 +991,7 @@ namespace test_forest
                         if (h->right == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = h;
+                            z->set_parent(h);
                             h->right = z;
                             insert_fixup(z);
                             ++size_;
@@ -832,7 +1001,7 @@ namespace test_forest
                         else if (next->left == nil_)
                         {
                             Node *z = create_node(value);
-                            z->parent = next;
+                            z->set_parent(next);
                             next->left = z;
                             insert_fixup(z);
                             ++size_;
@@ -854,16 +1023,62 @@ namespace test_forest
          * @tparam InputIt 输入迭代器类型 / input iterator type
          * @param first [in] 起始迭代器 / first
          * @param last  [in] 终止迭代器（开区间）/ last (one past end)
+         *
+         * @note 空树时批量建树：有序输入（随机访问的无序输入先排序）按中位数递归建成完全树，
+         *       只把不满的最底层染红，O(N)；其它迭代器只批量处理首个逆序元素之前的有序前缀，
+         *       其余元素逐个插入。
+         *       On an empty tree this bulk-loads: sorted input (unsorted random-access input is
+         *       sorted first) is built by recursive median into a complete tree with only the
+         *       incomplete bottom level red, O(N); other iterators bulk-load the sorted prefix
+         *       up to the first out-of-order element and insert the rest one by one.
          */
         template <typename InputIt>
         void insert(InputIt first, InputIt last)
         {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if (size_ == 0 && first != last)
+            {
+                if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>)
+                {
+                    if (!std::is_sorted(first, last, comp_))
+                    {
+                        std::vector<value_type> sorted(first, last);
+                        std::sort(sorted.begin(), sorted.end(), comp_);
+                        bulk_load_prefix(sorted.begin(), sorted.end());
+                        return;
+                    }
+                }
+                first = bulk_load_prefix(first, last);
+            }
             for (; first != last; ++first)
             {
                 insert(*first);
             }
         }
 
+        /**
+         * @brief 由升序区间 O(N) 建树（等价元素只保留第一个）
+         *        / Build a tree from an ascending range in O(N) (keeps the first of equivalent
+         *        elements).
+         *
+         * @note 区间若并非升序，逆序之后的元素逐个插入，结果仍然正确。
+         *       If the range is not ascending, elements after the first inversion are inserted
+         *       one by one, so the result is still correct.
+         */
+        template <typename InputIt>
+        static RedBlackTree from_sorted(InputIt first, InputIt last,
+                                        const Compare &comp = Compare(),
+                                        const Allocator &alloc = Allocator())
+        {
+            RedBlackTree tree(comp, alloc);
+            first = tree.bulk_load_prefix(first, last);
+            for (; first != last; ++first)
+            {
+                tree.insert(*first);
+            }
+            return tree;
+        }
+
         /**
          * @brief 初始化列表插入 / Insert from initializer_list.
          *
@@ -913,13 +1128,66 @@ namespace test_forest
          *
          * @param first [in] 起始迭代器 / first
          * @param last  [in] 终止迭代器（开区间）/ last
+         *
+         * @note 短区间逐个删除；长区间在 *first 与 *last 处切分、把两端 join 回去，
+         *       中间子树一次遍历释放。切分时黑高随递归传递，每次 join 只花 O(黑高差)，
+         *       各次之差逐层抵消，总代价 O(log N + k)，不做逐元素的删除修复。
+         *       Short ranges are erased one by one; long ranges are split at *first and
+         *       *last, the outer pieces joined back and the middle subtree released in one
+         *       traversal. Black heights are carried down the split, so each join costs
+         *       O(black-height difference); the differences telescope, for O(log N + k) in
+         *       total with no per-element erase fixup.
          */
         iterator erase(iterator first, iterator last)
         {
-            while (first != last)
+            if (first == last)
+                return last;
+            if (first == begin() && last == end())
+            {
+                clear();
+                return end();
+            }
+
+            // 区间很短时 split + join 不划算 / split + join does not pay off for short ranges
+            iterator probe(first);
+            for (size_type k = 0; k < range_erase_cutoff && probe != last; ++k)
+                ++probe;
+            if (probe == last)
+            {
+                while (first != last)
+                    first = erase(first);
+                return last;
+            }
+
+            Node *left = nil_;
+            Node *first_node = nil_;
+            Node *middle = nil_;
+            Node *last_node = nil_;
+            Node *right = nil_;
+            size_type h_left = 0;
+            size_type h_middle = 0;
+            size_type h_right = 0;
+            split_node(root_, black_height(root_), first.node_->value, left, h_left, first_node, middle, h_middle);
+            if (last.node_ != nil_)
             {
-                first = erase(first);
+                Node *rest = middle;
+                split_node(rest, h_middle, last.node_->value, middle, h_middle, last_node, right, h_right);
             }
+
+            size_ -= release_subtree(middle) + 1;
+            destroy_node(first_node);
+
+            if (last_node != nil_)
+            {
+                size_type h_joined = 0;
+                root_ = join_node(left, h_left, last_node, right, h_right, h_joined);
+            }
+            else
+            {
+                root_ = left;
+                root_->set_color(Color::Black);
+            }
+            update_nil_extremes();
             return last;
         }
 
@@ -1027,6 +1295,80 @@ namespace test_forest
             return {lower_bound(key), upper_bound(key)};
         }
 
+        // ======================== 区间聚合 / Range aggregates ========================
+
+        /**
+         * @brief 全部元素的聚合值，O(1) / Aggregate of all elements, O(1).
+         */
+        template <typename A = Aggregate>
+        typename A::value_type aggregate() const
+        {
+            static_assert(has_aggregate, "aggregate() needs a non-empty Aggregate policy");
+            return aggregate_of(root_);
+        }
+
+        /**
+         * @brief 键落在闭区间 [lo, hi] 内元素的聚合值，O(log N)
+         *        / Aggregate of the elements whose keys lie in the closed range [lo, hi], O(log N).
+         *
+         * @note 先找到 lo 与 hi 的搜索路径分叉处，再沿两条边界收集整棵子树的聚合值，按中序组合。
+         *       Finds where the search paths of lo and hi fork, then collects whole-subtree
+         *       aggregates along the two boundaries and combines them in key order.
+         */
+        template <typename A = Aggregate>
+        typename A::value_type aggregate(const key_type &lo, const key_type &hi) const
+        {
+            static_assert(has_aggregate, "aggregate() needs a non-empty Aggregate policy");
+            using value_t = typename A::value_type;
+
+            Node *fork = root_;
+            while (fork != nil_)
+            {
+                if (comp_(fork->value, lo))
+                    fork = fork->right;
+                else if (comp_(hi, fork->value))
+                    fork = fork->left;
+                else
+                    break;
+            }
+            if (fork == nil_)
+                return A::identity();
+
+            // 左边界：>= lo 的节点连同其右子树，越往下越小，往前拼
+            // left boundary: nodes >= lo with their right subtrees, smaller as we descend, so prepend
+            value_t left = A::identity();
+            for (Node *c = fork->left; c != nil_;)
+            {
+                if (!comp_(c->value, lo))
+                {
+                    left = A::combine(A::combine(A::lift(c->value), aggregate_of(c->right)), left);
+                    c = c->left;
+                }
+                else
+                {
+                    c = c->right;
+                }
+            }
+
+            // 右边界：<= hi 的节点连同其左子树，越往下越大，往后拼
+            // right boundary: nodes <= hi with their left subtrees, larger as we descend, so append
+            value_t right = A::identity();
+            for (Node *c = fork->right; c != nil_;)
+            {
+                if (!comp_(hi, c->value))
+                {
+                    right = A::combine(right, A::combine(aggregate_of(c->left), A::lift(c->value)));
+                    c = c->right;
+                }
+                else
+                {
+                    c = c->left;
+                }
+            }
+
+            return A::combine(A::combine(left, A::lift(fork->value)), right);
+        }
+
         // ======================== 观察器 / Observers ========================
 
         /**
@@ -1046,7 +1388,10 @@ namespace test_forest
             return comp_;
         }
 
-    private:
+    protected:
+        /// @brief 区间删除改用 split + join 的最短长度 / shortest range erased by split + join.
+        static constexpr size_type range_erase_cutoff = 32;
+
         /// @brief 根节点指针 / root node pointer.
         Node *root_;
         /// @brief 哨兵 nil 节点指针 / sentinel nil node pointer.
@@ -1069,8 +1414,8 @@ namespace test_forest
         {
             nil_ = node_alloc_traits::allocate(node_alloc_, 1);
             node_alloc_traits::construct(node_alloc_, nil_);
-            nil_->color = Color::Black;
-            nil_->parent = nullptr;
+            nil_->set_color(Color::Black);
+            nil_->set_parent(nullptr);
             nil_->left = nil_;
             nil_->right = nil_;
             root_ = nil_;
@@ -1131,6 +1476,40 @@ namespace test_forest
             destroy_node(node);
         }
 
+        /**
+         * @brief 子树聚合值，nil 为单位元 / Subtree aggregate, identity for nil.
+         */
+        template <typename A = Aggregate>
+        typename A::value_type aggregate_of(const Node *node) const
+        {
+            return node == nil_ ? A::identity() : node->aggregate_;
+        }
+
+        /**
+         * @brief 由孩子重算节点的聚合值 / Recompute a node's aggregate from its children.
+         */
+        void pull(Node *node)
+        {
+            if constexpr (has_aggregate)
+            {
+                node->aggregate_ = Aggregate::combine(
+                    Aggregate::combine(aggregate_of(node->left), Aggregate::lift(node->value)),
+                    aggregate_of(node->right));
+            }
+        }
+
+        /**
+         * @brief 从 node 到根逐个重算聚合值 / Recompute aggregates from node up to the root.
+         */
+        void pull_path(Node *node)
+        {
+            if constexpr (has_aggregate)
+            {
+                for (; node != nil_; node = node->parent())
+                    pull(node);
+            }
+        }
+
         /**
          * @brief 左旋转操作 / Left rotation.
          *
@@ -1143,26 +1522,28 @@ namespace test_forest
 
             if (y->left != nil_)
             {
-                y->left->parent = x;
+                y->left->set_parent(x);
             }
 
-            y->parent = x->parent;
+            y->set_parent(x->parent());
 
-            if (x->parent == nil_)
+            if (x->parent() == nil_)
             {
                 root_ = y;
             }
-            else if (x == x->parent->left)
+            else if (x == x->parent()->left)
             {
-                x->parent->left = y;
+                x->parent()->left = y;
             }
             else
             {
-                x->parent->right = y;
+                x->parent()->right = y;
             }
 
             y->left = x;
-            x->parent = y;
+            x->set_parent(y);
+            pull(x);
+            pull(y);
         }
 
         /**
@@ -1177,82 +1558,92 @@ namespace test_forest
 
             if (y->right != nil_)
             {
-                y->right->parent = x;
+                y->right->set_parent(x);
             }
 
-            y->parent = x->parent;
+            y->set_parent(x->parent());
 
-            if (x->parent == nil_)
+            if (x->parent() == nil_)
             {
                 root_ = y;
             }
-            else if (x == x->parent->right)
+            else if (x == x->parent()->right)
             {
-                x->parent->right = y;
+                x->parent()->right = y;
             }
             else
             {
-                x->parent->left = y;
+                x->parent()->left = y;
             }
 
             y->right = x;
-            x->parent = y;
+            x->set_parent(y);
+            pull(x);
+            pull(y);
         }
 
         /**
          * @brief 插入修复：保持红黑树性质
          *        / Insert fixup: restore red-black properties after insertion.
+         *
+         * @note 先沿 z 到根刷新聚合值，之后的旋转各自维护。
+         *       Aggregates are refreshed from z up to the root first; rotations keep them after.
+         *
+         * @return 红色是否一路上推到根、使黑高加一 / whether red propagated to the root, growing the black height by one.
          */
-        void insert_fixup(Node *z)
+        bool insert_fixup(Node *z)
         {
-            while (z->parent->color == Color::Red)
+            pull_path(z);
+            while (z->parent()->color() == Color::Red)
             {
-                if (z->parent == z->parent->parent->left)
+                if (z->parent() == z->parent()->parent()->left)
                 {
-                    Node *y = z->parent->parent->right; // 叔叔 / uncle
-                    if (y->color == Color::Red)
+                    Node *y = z->parent()->parent()->right; // 叔叔 / uncle
+                    if (y->color() == Color::Red)
                     {
-                        z->parent->color = Color::Black;
-                        y->color = Color::Black;
-                        z->parent->parent->color = Color::Red;
-                        z = z->parent->parent;
+                        z->parent()->set_color(Color::Black);
+                        y->set_color(Color::Black);
+                        z->parent()->parent()->set_color(Color::Red);
+                        z = z->parent()->parent();
                     }
                     else
                     {
-                        if (z == z->parent->right)
+                        if (z == z->parent()->right)
                         {
-                            z = z->parent;
+                            z = z->parent();
                             rotate_left(z);
                         }
-                        z->parent->color = Color::Black;
-                        z->parent->parent->color = Color::Red;
-                        rotate_right(z->parent->parent);
+                        z->parent()->set_color(Color::Black);
+                        z->parent()->parent()->set_color(Color::Red);
+                        rotate_right(z->parent()->parent());
                     }
                 }
                 else
                 {
-                    Node *y = z->parent->parent->left;
-                    if (y->color == Color::Red)
+                    Node *y = z->parent()->parent()->left;
+                    if (y->color() == Color::Red)
                     {
-                        z->parent->color = Color::Black;
-                        y->color = Color::Black;
-                        z->parent->parent->color = Color::Red;
-                        z = z->parent->parent;
+                        z->parent()->set_color(Color::Black);
+                        y->set_color(Color::Black);
+                        z->parent()->parent()->set_color(Color::Red);
+                        z = z->parent()->parent();
                     }
                     else
                     {
-                        if (z == z->parent->left)
+                        if (z == z->parent()->left)
                         {
-                            z = z->parent;
+                            z = z->parent();
                             rotate_right(z);
                         }
-                        z->parent->color = Color::Black;
-                        z->parent->parent->color = Color::Red;
-                        rotate_left(z->parent->parent);
+                        z->parent()->set_color(Color::Black);
+                        z->parent()->parent()->set_color(Color::Red);
+                        rotate_left(z->parent()->parent());
                     }
                 }
             }
-            root_->color = Color::Black;
+            bool grew = root_->color() == Color::Red;
+            root_->set_color(Color::Black);
+            return grew;
         }
 
         /**
@@ -1261,19 +1652,19 @@ namespace test_forest
          */
         void transplant(Node *u, Node *v)
         {
-            if (u->parent == nil_)
+            if (u->parent() == nil_)
             {
                 root_ = v;
             }
-            else if (u == u->parent->left)
+            else if (u == u->parent()->left)
             {
-                u->parent->left = v;
+                u->parent()->left = v;
             }
             else
             {
-                u->parent->right = v;
+                u->parent()->right = v;
             }
-            v->parent = u->parent;
+            v->set_parent(u->parent());
         }
 
         /**
@@ -1286,7 +1677,7 @@ namespace test_forest
         {
             Node *y = z;
             Node *x = nullptr;
-            Color y_original_color = y->color;
+            Color y_original_color = y->color();
 
             if (z->left == nil_)
             {
@@ -1301,26 +1692,27 @@ namespace test_forest
             else
             {
                 y = minimum_node(z->right);
-                y_original_color = y->color;
+                y_original_color = y->color();
                 x = y->right;
 
-                if (y->parent == z)
+                if (y->parent() == z)
                 {
-                    x->parent = y;
+                    x->set_parent(y);
                 }
                 else
                 {
                     transplant(y, y->right);
                     y->right = z->right;
-                    y->right->parent = y;
+                    y->right->set_parent(y);
                 }
 
                 transplant(z, y);
                 y->left = z->left;
-                y->left->parent = y;
-                y->color = z->color;
+                y->left->set_parent(y);
+                y->set_color(z->color());
             }
 
+            pull_path(x->parent());
             destroy_node(z);
             --size_;
 
@@ -1338,74 +1730,342 @@ namespace test_forest
          */
         void erase_fixup(Node *x)
         {
-            while (x != root_ && x->color == Color::Black)
+            while (x != root_ && x->color() == Color::Black)
             {
-                if (x == x->parent->left)
+                if (x == x->parent()->left)
                 {
-                    Node *w = x->parent->right;
-                    if (w->color == Color::Red)
+                    Node *w = x->parent()->right;
+                    if (w->color() == Color::Red)
                     {
-                        w->color = Color::Black;
-                        x->parent->color = Color::Red;
-                        rotate_left(x->parent);
-                        w = x->parent->right;
+                        w->set_color(Color::Black);
+                        x->parent()->set_color(Color::Red);
+                        rotate_left(x->parent());
+                        w = x->parent()->right;
                     }
-                    if (w->left->color == Color::Black &&
-                        w->right->color == Color::Black)
+                    if (w->left->color() == Color::Black &&
+                        w->right->color() == Color::Black)
                     {
-                        w->color = Color::Red;
-                        x = x->parent;
+                        w->set_color(Color::Red);
+                        x = x->parent();
                     }
                     else
                     {
-                        if (w->right->color == Color::Black)
+                        if (w->right->color() == Color::Black)
                         {
-                            w->left->color = Color::Black;
-                            w->color = Color::Red;
+                            w->left->set_color(Color::Black);
+                            w->set_color(Color::Red);
                             rotate_right(w);
-                            w = x->parent->right;
+                            w = x->parent()->right;
                         }
-                        w->color = x->parent->color;
-                        x->parent->color = Color::Black;
-                        w->right->color = Color::Black;
-                        rotate_left(x->parent);
+                        w->set_color(x->parent()->color());
+                        x->parent()->set_color(Color::Black);
+                        w->right->set_color(Color::Black);
+                        rotate_left(x->parent());
                         x = root_;
                     }
                 }
                 else
                 {
-                    Node *w = x->parent->left;
-                    if (w->color == Color::Red)
+                    Node *w = x->parent()->left;
+                    if (w->color() == Color::Red)
                     {
-                        w->color = Color::Black;
-                        x->parent->color = Color::Red;
-                        rotate_right(x->parent);
-                        w = x->parent->left;
+                        w->set_color(Color::Black);
+                        x->parent()->set_color(Color::Red);
+                        rotate_right(x->parent());
+                        w = x->parent()->left;
                     }
-                    if (w->right->color == Color::Black &&
-                        w->left->color == Color::Black)
+                    if (w->right->color() == Color::Black &&
+                        w->left->color() == Color::Black)
                     {
-                        w->color = Color::Red;
-                        x = x->parent;
+                        w->set_color(Color::Red);
+                        x = x->parent();
                     }
                     else
                     {
-                        if (w->left->color == Color::Black)
+                        if (w->left->color() == Color::Black)
                         {
-                            w->right->color = Color::Black;
-                            w->color = Color::Red;
+                            w->right->set_color(Color::Black);
+                            w->set_color(Color::Red);
                             rotate_left(w);
-                            w = x->parent->left;
+                            w = x->parent()->left;
                         }
-                        w->color = x->parent->color;
-                        x->parent->color = Color::Black;
-                        w->left->color = Color::Black;
-                        rotate_right(x->parent);
+                        w->set_color(x->parent()->color());
+                        x->parent()->set_color(Color::Black);
+                        w->left->set_color(Color::Black);
+                        rotate_right(x->parent());
                         x = root_;
                     }
                 }
             }
-            x->color = Color::Black;
+            x->set_color(Color::Black);
+        }
+
+        /**
+         * @brief 空树批量建树：把有序前缀（等价元素保留第一个）串成 right 链，再按中位数递归建树
+         *        / Empty-tree bulk load: chain the sorted prefix (keeping the first of equivalent
+         *        elements) through right links, then build the tree by recursive median.
+         *
+         * @return 第一个逆序元素的位置，全部有序时为 last / position of the first out-of-order
+         *         element, or last if the whole range is sorted.
+         */
+        template <typename InputIt>
+        InputIt bulk_load_prefix(InputIt first, InputIt last)
+        {
+            Node *head = nil_;
+            Node *tail = nil_;
+            size_type count = 0;
+            try
+            {
+                for (; first != last; ++first)
+                {
+                    if (tail != nil_)
+                    {
+                        if (comp_(*first, tail->value))
+                            break;
+                        if (!comp_(tail->value, *first))
+                            continue;
+                    }
+                    Node *n = create_node(*first);
+                    (tail != nil_ ? tail->right : head) = n;
+                    tail = n;
+                    ++count;
+                }
+            }
+            catch (...)
+            {
+                while (head != nil_)
+                {
+                    Node *next = head->right;
+                    destroy_node(head);
+                    head = next;
+                }
+                throw;
+            }
+
+            if (count != 0)
+            {
+                // 完全树的叶子深度为 floor(log2 N) 或其减一；最底层不满时把它染红，
+                // 每条路径的黑节点数就都相同。
+                // Leaves of the complete tree sit at depth floor(log2 N) or one above; when
+                // that bottom level is incomplete, coloring it red equalizes black heights.
+                size_type bottom = 0;
+                while ((size_type(2) << bottom) <= count)
+                    ++bottom;
+                bool perfect = ((count + 1) & count) == 0;
+                size_type red_depth = perfect ? count : bottom;
+
+                root_ = build_from_list(head, count, 0, red_depth);
+                root_->set_parent(nil_);
+                size_ = count;
+                update_nil_extremes();
+            }
+            return first;
+        }
+
+        /**
+         * @brief 按中序消费 right 链上的 n 个节点，建成完全子树并写好父指针与颜色
+         *        / Consume n nodes of a right-linked list in order, building a complete
+         *        subtree with parent links and colors set.
+         *
+         * @param list      [in,out] 链表当前头，返回后指向未消费部分 / current list head,
+         *                  advanced past the consumed nodes
+         * @param n         [in] 要消费的节点数 / number of nodes to consume
+         * @param depth     [in] 子树根的深度 / depth of the subtree root
+         * @param red_depth [in] 染红的深度 / depth colored red
+         * @return 子树根 / subtree root
+         */
+        Node *build_from_list(Node *&list, size_type n, size_type depth, size_type red_depth) noexcept
+        {
+            if (n == 0)
+                return nil_;
+            size_type left_count = (n - 1) / 2;
+            Node *l = build_from_list(list, left_count, depth + 1, red_depth);
+            Node *mid = list;
+            list = list->right;
+            Node *r = build_from_list(list, n - 1 - left_count, depth + 1, red_depth);
+
+            mid->left = l;
+            mid->right = r;
+            if (l != nil_)
+                l->set_parent(mid);
+            if (r != nil_)
+                r->set_parent(mid);
+            mid->set_color(depth == red_depth ? Color::Red : Color::Black);
+            pull(mid);
+            return mid;
+        }
+
+        /**
+         * @brief 子树的黑高（不计 nil）/ Black height of a subtree (nil not counted).
+         */
+        size_type black_height(Node *node) const noexcept
+        {
+            size_type h = 0;
+            for (; node != nil_; node = node->left)
+            {
+                if (node->color() == Color::Black)
+                    ++h;
+            }
+            return h;
+        }
+
+        /**
+         * @brief 以 k 为分隔键连接两棵独立子树（l < k < r），返回新根
+         *        / Join two detached subtrees around pivot k (l < k < r), return the new root.
+         *
+         * @param hl [in] l 的黑高（按 l 根的当前颜色）/ black height of l (with its root's current color)
+         * @param hr [in] r 的黑高 / black height of r
+         * @param h  [out] 结果的黑高 / black height of the result
+         *
+         * @note 沿较高一侧的右（左）脊下降到黑高相同的黑节点，挂上红色的 k 后复用
+         *       insert_fixup，代价 O(|hl - hr| + 1)；过程中 root_ 被用作暂存。
+         *       Descends the right (left) spine of the taller side to a black node of equal
+         *       black height, hangs a red k there and reuses insert_fixup, in O(|hl - hr| + 1);
+         *       root_ is used as scratch meanwhile.
+         */
+        Node *join_node(Node *l, size_type hl, Node *k, Node *r, size_type hr, size_type &h)
+        {
+            if (l != nil_ && l->color() == Color::Red)
+            {
+                l->set_color(Color::Black);
+                ++hl;
+            }
+            if (r != nil_ && r->color() == Color::Red)
+            {
+                r->set_color(Color::Black);
+                ++hr;
+            }
+
+            k->set_color(Color::Red);
+            if (hl == hr)
+            {
+                h = hl + 1;
+                k->left = l;
+                k->right = r;
+                k->set_parent(nil_);
+                k->set_color(Color::Black);
+                if (l != nil_)
+                    l->set_parent(k);
+                if (r != nil_)
+                    r->set_parent(k);
+                pull(k);
+                return k;
+            }
+
+            h = std::max(hl, hr);
+            Node *parent = nil_;
+            if (hl > hr)
+            {
+                Node *c = l;
+                while (c->color() == Color::Red || hl > hr)
+                {
+                    if (c->color() == Color::Black)
+                        --hl;
+                    parent = c;
+                    c = c->right;
+                }
+                parent->right = k;
+                k->left = c;
+                k->right = r;
+                root_ = l;
+            }
+            else
+            {
+                Node *c = r;
+                while (c->color() == Color::Red || hr > hl)
+                {
+                    if (c->color() == Color::Black)
+                        --hr;
+                    parent = c;
+                    c = c->left;
+                }
+                parent->left = k;
+                k->left = l;
+                k->right = c;
+                root_ = r;
+            }
+            k->set_parent(parent);
+            if (k->left != nil_)
+                k->left->set_parent(k);
+            if (k->right != nil_)
+                k->right->set_parent(k);
+            if (insert_fixup(k))
+                ++h;
+            return root_;
+        }
+
+        /**
+         * @brief 按 key 把独立子树 t 切成 (< key, 等于 key 的节点或 nil, > key)
+         *        / Split detached subtree t by key into (< key, node equal to key or nil, > key).
+         *
+         * @param h [in] t 的黑高，子树黑高由它逐层推出，无需重新沿脊计算
+         *             / black height of t; subtree heights are derived from it level by level
+         *             instead of walking a spine again.
+         * @param h_less    [out] less 的黑高 / black height of less
+         * @param h_greater [out] greater 的黑高 / black height of greater
+         */
+        void split_node(Node *t, size_type h, const key_type &key,
+                        Node *&less, size_type &h_less, Node *&equal,
+                        Node *&greater, size_type &h_greater)
+        {
+            if (t == nil_)
+            {
+                less = nil_;
+                equal = nil_;
+                greater = nil_;
+                h_less = 0;
+                h_greater = 0;
+                return;
+            }
+
+            Node *a = t->left;
+            Node *b = t->right;
+            if (a != nil_)
+                a->set_parent(nil_);
+            if (b != nil_)
+                b->set_parent(nil_);
+            size_type h_child = t->color() == Color::Black ? h - 1 : h;
+
+            if (comp_(key, t->value))
+            {
+                Node *mid = nil_;
+                size_type h_mid = 0;
+                split_node(a, h_child, key, less, h_less, equal, mid, h_mid);
+                greater = join_node(mid, h_mid, t, b, h_child, h_greater);
+            }
+            else if (comp_(t->value, key))
+            {
+                Node *mid = nil_;
+                size_type h_mid = 0;
+                split_node(b, h_child, key, mid, h_mid, equal, greater, h_greater);
+                less = join_node(a, h_child, t, mid, h_mid, h_less);
+            }
+            else
+            {
+                less = a;
+                equal = t;
+                greater = b;
+                h_less = h_child;
+                h_greater = h_child;
+            }
+        }
+
+        /**
+         * @brief 一次遍历释放子树并返回节点数
+         *        / Release a subtree in one traversal and return its node count.
+         */
+        size_type release_subtree(Node *node)
+        {
+            size_type n = 0;
+            while (node != nil_)
+            {
+                n += release_subtree(node->left);
+                Node *r = node->right;
+                destroy_node(node);
+                ++n;
+                node = r;
+            }
+            return n;
         }
 
         /**
@@ -0,0 +1,91 @@
+#ifndef _SET_TRAITS_HPP
+#define _SET_TRAITS_HPP
+
+#include <type_traits>
+#include <utility>
+
+namespace test_forest
+{
+
+    /**
+     * @brief
+     *  包装任意树容器时用到的接口适配：各棵树的键类型名、insert 返回值与遍历方式并不统一。
+     *  Interface adapters for wrappers over arbitrary trees: the trees differ in how they name
+     *  the key type, what insert returns and how they are traversed.
+     */
+    namespace set_traits
+    {
+        /// @brief 树的键类型：优先 key_type，否则 value_type / key type of a tree: key_type if present, else value_type.
+        template <class Tree, class = void>
+        struct key_of
+        {
+            using type = typename Tree::value_type;
+        };
+
+        template <class Tree>
+        struct key_of<Tree, std::void_t<typename Tree::key_type>>
+        {
+            using type = typename Tree::key_type;
+        };
+
+        template <class Tree>
+        using key_of_t = typename key_of<Tree>::type;
+
+        /// @brief 是否有 contains(key) / whether the tree has contains(key).
+        template <class Tree, class Key, class = void>
+        struct has_contains : std::false_type
+        {
+        };
+
+        template <class Tree, class Key>
+        struct has_contains<Tree, Key, std::void_t<decltype(std::declval<const Tree &>().contains(std::declval<const Key &>()))>>
+            : std::true_type
+        {
+        };
+
+        /// @brief 是否有 traverse_in_order(f)（BTreeSet 无迭代器）/ whether the tree has traverse_in_order(f) (BTreeSet has no iterators).
+        template <class Tree, class Key, class = void>
+        struct has_traverse : std::false_type
+        {
+        };
+
+        template <class Tree, class Key>
+        struct has_traverse<Tree, Key, std::void_t<decltype(std::declval<const Tree &>().traverse_in_order(std::declval<void (*)(const Key &)>()))>>
+            : std::true_type
+        {
+        };
+
+        /// @brief insert 的返回值归一为 bool / normalize the result of insert to bool.
+        template <class It>
+        bool inserted(const std::pair<It, bool> &result) noexcept { return result.second; }
+        inline bool inserted(bool result) noexcept { return result; }
+
+        /// @brief 查找：优先 contains，否则 find / lookup: contains if available, else find.
+        template <class Tree>
+        bool contains(const Tree &tree, const key_of_t<Tree> &key)
+        {
+            if constexpr (has_contains<Tree, key_of_t<Tree>>::value)
+                return tree.contains(key);
+            else
+                return tree.find(key) != tree.end();
+        }
+
+        /// @brief 按升序对每个键调用 f / call f on every key in ascending order.
+        template <class Tree, class F>
+        void for_each_key(const Tree &tree, F &&f)
+        {
+            if constexpr (has_traverse<Tree, key_of_t<Tree>>::value)
+            {
+                tree.traverse_in_order(std::forward<F>(f));
+            }
+            else
+            {
+                for (const auto &key : tree)
+                    f(key);
+            }
+        }
+    } // namespace set_traits
+
+} // namespace test_forest
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef _SHARDED_SET_HPP
+#define _SHARDED_SET_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "Set-Traits.hpp"
+
+namespace test_forest
+{
+
+    /**
+     * @brief 按哈希分片：负载均匀，但分片之间无序 / Hash partitioning: even load, but shards are not ordered.
+     */
+    template <class Key, class Hash = std::hash<Key>>
+    struct hash_partition
+    {
+        /// @brief 分片按键序排列吗 / whether shards follow key order.
+        static constexpr bool ordered = false;
+
+        Hash hash{};
+
+        std::size_t operator()(const Key &key, std::size_t shards) const noexcept
+        {
+            // splitmix64 终结步打散 std::hash<int> 这类恒等哈希，再用乘法取高位映射到分片
+            // the splitmix64 finalizer spreads identity hashes like std::hash<int>; multiply-high maps to a shard
+            std::uint64_t x = static_cast<std::uint64_t>(hash(key)) + 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return static_cast<std::size_t>(((x >> 32) * static_cast<std::uint64_t>(shards)) >> 32);
+        }
+    };
+
+    /**
+     * @brief 按区间分片：分片 i 存放 [bounds[i-1], bounds[i]) 的键，有序遍历只需依次拼接
+     *        / Range partitioning: shard i holds keys in [bounds[i-1], bounds[i]), so ordered
+     *        traversal simply concatenates the shards.
+     */
+    template <class Key, class Compare = std::less<Key>>
+    struct range_partition
+    {
+        /// @brief 分片按键序排列吗 / whether shards follow key order.
+        static constexpr bool ordered = true;
+
+        /// @brief 升序的分界键（至多 分片数 - 1 个）/ ascending split keys (at most shards - 1).
+        std::vector<Key> bounds;
+        Compare comp{};
+
+        std::size_t operator()(const Key &key, std::size_t shards) const
+        {
+            std::size_t i = static_cast<std::size_t>(
+                std::upper_bound(bounds.begin(), bounds.end(), key, comp) - bounds.begin());
+            return std::min(i, shards - 1);
+        }
+    };
+
+    /**
+     * @brief
+     *  分片并发集合：按 Partition 把键分到 Shards 个互相独立的树里，每个分片一把按缓存行对齐的读写锁；
+     *  不同分片上的操作互不阻塞，同一分片的查找可以并行。
+     *  Sharded concurrent set: Partition spreads keys over Shards independent trees, each
+     *  behind its own cache-line-aligned reader-writer lock; operations on different shards
+     *  never block each other, and lookups on the same shard run in parallel.
+     *
+     * @tparam Tree      每个分片的树（avl_tree、RedBlackTree、BTreeSet、BinaryTree 等）
+     *                   / per-shard tree (avl_tree, RedBlackTree, BTreeSet, BinaryTree, ...)
+     * @tparam Shards    分片数 / number of shards
+     * @tparam Partition 分片函数（缺省 hash_partition）/ partition function (default hash_partition)
+     *
+     * @note size() 与 for_each() 逐个分片加锁，并发修改时得到的不是同一时刻的快照。
+     *       size() and for_each() lock one shard at a time, so under concurrent updates they do
+     *       not observe a single point in time.
+     */
+    template <class Tree, std::size_t Shards, class Partition = hash_partition<set_traits::key_of_t<Tree>>>
+    class ShardedSet
+    {
+        static_assert(Shards >= 1, "ShardedSet<Shards>: Shards must be >= 1");
+
+    public:
+        /// @brief 键类型 / key type.
+        using key_type = set_traits::key_of_t<Tree>;
+        /// @brief 值类型 / value type.
+        using value_type = key_type;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+        /// @brief 每个分片的树 / per-shard tree.
+        using tree_type = Tree;
+        /// @brief 分片函数类型 / partition type.
+        using partition_type = Partition;
+
+        /// @brief 分片数 / number of shards.
+        static constexpr size_type shard_count = Shards;
+
+        /**
+         * @brief 构造空集合 / Construct an empty set.
+         */
+        explicit ShardedSet(const Partition &partition = Partition())
+            : partition_(partition)
+        {
+        }
+
+        ShardedSet(const ShardedSet &) = delete;
+        ShardedSet &operator=(const ShardedSet &) = delete;
+
+        /**
+         * @brief 插入键 / Insert a key.
+         * @return 是否新插入 / whether the key was newly inserted.
+         */
+        bool insert(const key_type &key)
+        {
+            Shard &shard = shards_[shard_of(key)];
+            std::unique_lock<std::shared_mutex> guard(shard.lock);
+            return set_traits::inserted(shard.tree.insert(key));
+        }
+
+        /**
+         * @brief 删除键 / Erase a key.
+         * @return 删除的个数（0 或 1）/ number of erased keys (0 or 1).
+         */
+        size_type erase(const key_type &key)
+        {
+            Shard &shard = shards_[shard_of(key)];
+            std::unique_lock<std::shared_mutex> guard(shard.lock);
+            return static_cast<size_type>(shard.tree.erase(key));
+        }
+
+        /**
+         * @brief 是否包含键 / Whether the key is present.
+         */
+        bool contains(const key_type &key) const
+        {
+            const Shard &shard = shards_[shard_of(key)];
+            std::shared_lock<std::shared_mutex> guard(shard.lock);
+            return set_traits::contains(shard.tree, key);
+        }
+
+        /**
+         * @brief 批量插入：先按分片分组，每个分片只加一次锁 / Batch insert: keys are grouped per shard and each shard is locked once.
+         * @return 新插入的个数 / number of newly inserted keys.
+         */
+        template <class InputIt>
+        size_type insert_batch(InputIt first, InputIt last)
+        {
+            std::vector<key_type> keys(first, last);
+            size_type inserted = 0;
+            for_each_group(keys, [&](std::size_t s, const std::size_t *begin, const std::size_t *end)
+                           {
+                Shard &shard = shards_[s];
+                std::unique_lock<std::shared_mutex> guard(shard.lock);
+                for (const std::size_t *i = begin; i != end; ++i)
+                    inserted += set_traits::inserted(shard.tree.insert(keys[*i])) ? 1 : 0; });
+            return inserted;
+        }
+
+        /**
+         * @brief 批量删除，每个分片只加一次锁 / Batch erase, locking each shard once.
+         * @return 删除的个数 / number of erased keys.
+         */
+        template <class InputIt>
+        size_type erase_batch(InputIt first, InputIt last)
+        {
+            std::vector<key_type> keys(first, last);
+            size_type erased = 0;
+            for_each_group(keys, [&](std::size_t s, const std::size_t *begin, const std::size_t *end)
+                           {
+                Shard &shard = shards_[s];
+                std::unique_lock<std::shared_mutex> guard(shard.lock);
+                for (const std::size_t *i = begin; i != end; ++i)
+                    erased += static_cast<size_type>(shard.tree.erase(keys[*i])); });
+            return erased;
+        }
+
+        /**
+         * @brief 批量查找，每个分片只加一次读锁 / Batch lookup, taking each shard's read lock once.
+         * @return 与 keys 一一对应的结果 / results in the order of keys.
+         */
+        std::vector<bool> contains_batch(const std::vector<key_type> &keys) const
+        {
+            std::vector<bool> found(keys.size());
+            for_each_group(keys, [&](std::size_t s, const std::size_t *begin, const std::size_t *end)
+                           {
+                const Shard &shard = shards_[s];
+                std::shared_lock<std::shared_mutex> guard(shard.lock);
+                for (const std::size_t *i = begin; i != end; ++i)
+                    found[*i] = set_traits::contains(shard.tree, keys[*i]); });
+            return found;
+        }
+
+        /**
+         * @brief 按升序对每个键调用 f；区间分片依次拼接，哈希分片按 operator< 做 k 路归并
+         *        / Call f on every key in ascending order; range shards are concatenated, hash
+         *        shards are k-way merged with operator<.
+         */
+        template <class F>
+        void for_each(F f) const
+        {
+            if constexpr (Partition::ordered)
+            {
+                for (const Shard &shard : shards_)
+                {
+                    std::shared_lock<std::shared_mutex> guard(shard.lock);
+                    set_traits::for_each_key(shard.tree, f);
+                }
+            }
+            else
+            {
+                // 逐个分片拷出有序快照，再用小根堆归并
+                // copy a sorted snapshot of each shard, then merge with a min-heap
+                std::array<std::vector<key_type>, Shards> runs;
+                for (std::size_t s = 0; s < Shards; ++s)
+                {
+                    std::shared_lock<std::shared_mutex> guard(shards_[s].lock);
+                    runs[s].reserve(shards_[s].tree.size());
+                    set_traits::for_each_key(shards_[s].tree, [&runs, s](const key_type &key)
+                                             { runs[s].push_back(key); });
+                }
+
+                using cursor = std::pair<std::size_t, std::size_t>; // (run, position)
+                auto greater = [&runs](const cursor &a, const cursor &b)
+                {
+                    return runs[b.first][b.second] < runs[a.first][a.second];
+                };
+                std::priority_queue<cursor, std::vector<cursor>, decltype(greater)> heap(greater);
+                for (std::size_t s = 0; s < Shards; ++s)
+                {
+                    if (!runs[s].empty())
+                        heap.emplace(s, 0);
+                }
+                while (!heap.empty())
+                {
+                    cursor c = heap.top();
+                    heap.pop();
+                    f(runs[c.first][c.second]);
+                    if (++c.second < runs[c.first].size())
+                        heap.push(c);
+                }
+            }
+        }
+
+        /**
+         * @brief 元素个数（逐分片累加）/ Number of keys (summed shard by shard).
+         */
+        size_type size() const
+        {
+            size_type total = 0;
+            for (const Shard &shard : shards_)
+            {
+                std::shared_lock<std::shared_mutex> guard(shard.lock);
+                total += shard.tree.size();
+            }
+            return total;
+        }
+
+        /**
+         * @brief 是否为空 / Whether empty.
+         */
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /**
+         * @brief 清空所有分片 / Clear every shard.
+         */
+        void clear()
+        {
+            for (Shard &shard : shards_)
+            {
+                std::unique_lock<std::shared_mutex> guard(shard.lock);
+                shard.tree.clear();
+            }
+        }
+
+    private:
+        /// @brief 一个分片：锁与树独占缓存行起点，相邻分片的锁不会伪共享
+        ///        / one shard: lock and tree start a cache line, so neighbouring locks never false-share.
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex lock;
+            Tree tree;
+        };
+
+        std::size_t shard_of(const key_type &key) const
+        {
+            return partition_(key, Shards);
+        }
+
+        /// @brief 按分片对 keys 的下标做计数排序，再对每个非空分片调用 g(分片号, begin, end)
+        ///        / counting-sort the indices of keys by shard, then call g(shard index, begin, end) per non-empty shard.
+        template <class G>
+        void for_each_group(const std::vector<key_type> &keys, G g) const
+        {
+            std::vector<std::size_t> shard_ids(keys.size());
+            std::array<std::size_t, Shards + 1> offsets{};
+            for (std::size_t i = 0; i < keys.size(); ++i)
+            {
+                shard_ids[i] = shard_of(keys[i]);
+                ++offsets[shard_ids[i] + 1];
+            }
+            for (std::size_t s = 0; s < Shards; ++s)
+                offsets[s + 1] += offsets[s];
+
+            std::vector<std::size_t> order(keys.size());
+            std::array<std::size_t, Shards> fill{};
+            for (std::size_t i = 0; i < keys.size(); ++i)
+            {
+                std::size_t s = shard_ids[i];
+                order[offsets[s] + fill[s]++] = i;
+            }
+
+            for (std::size_t s = 0; s < Shards; ++s)
+            {
+                if (offsets[s] != offsets[s + 1])
+                    g(s, order.data() + offsets[s], order.data() + offsets[s + 1]);
+            }
+        }
+
+        Partition partition_;
+        std::array<Shard, Shards> shards_;
+    }; // class ShardedSet
+
+} // namespace test_forest
+
+#endif
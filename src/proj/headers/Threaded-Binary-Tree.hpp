@@ -0,0 +1,1120 @@
+#ifndef _THREADED_BINARY_TREE_HPP
+#define _THREADED_BINARY_TREE_HPP
+
+/**
+ * @file Threaded-Binary-Tree.hpp
+ * @brief 中序线索二叉搜索树容器（模板）声明与实现 / In-order threaded binary search tree container (template) declaration & implementation.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <vector>
+
+namespace test_forest
+{
+
+    /**
+     * @brief
+     *  中序线索二叉搜索树，接口与 BinaryTree 一致。空的左/右孩子链接被替换为带标记的
+     *  中序前驱/后继“线索”，因此 ++it 通常只需一次加载，且结点无需 parent 指针。
+     *  In-order threaded binary search tree with the same interface as BinaryTree. Null
+     *  left/right child links are replaced by tagged in-order predecessor/successor
+     *  "threads", so ++it is usually a single load and nodes need no parent pointer.
+     *
+     * @tparam T
+     *  元素类型 / element type.
+     * @tparam Compare
+     *  比较器类型（缺省为 std::less<T>）/ comparator type (defaults to std::less<T>).
+     * @tparam Allocator
+     *  分配器类型（缺省为 std::allocator<T>）/ allocator type (defaults to std::allocator<T>).
+     *
+     * @note
+     *  链接的最低位为 1 表示线索，为 0 表示孩子；最小结点的左线索与最大结点的右线索为
+     *  带标记的空指针。
+     *  The lowest bit of a link is 1 for a thread and 0 for a child; the left thread of
+     *  the minimum and the right thread of the maximum are tagged null pointers.
+     */
+    template <class T,
+              class Compare = std::less<T>,
+              class Allocator = std::allocator<T>>
+    class ThreadedBinaryTree
+    {
+    private:
+        // ============================
+        // 内部结点结构 / Internal node
+        // ============================
+        struct node
+        {
+            /// @brief 存储的值 / stored value.
+            T value;
+            /// @brief 左链接：孩子或前驱线索 / left link: child or predecessor thread.
+            std::uintptr_t left;
+            /// @brief 右链接：孩子或后继线索 / right link: child or successor thread.
+            std::uintptr_t right;
+
+            /// @brief 构造函数 / constructor.
+            node(const T &v, std::uintptr_t l, std::uintptr_t r)
+                : value(v), left(l), right(r) {}
+
+            /// @brief 移动构造函数 / move constructor.
+            node(T &&v, std::uintptr_t l, std::uintptr_t r)
+                : value(std::move(v)), left(l), right(r) {}
+        };
+
+        static_assert(alignof(node) >= 2, "ThreadedBinaryTree: node alignment must leave a tag bit");
+
+    public:
+        // ============================
+        // 公共类型别名 / Public type aliases
+        // ============================
+        /// @brief 值类型 / value type.
+        using value_type = T;
+        /// @brief 比较器类型 / comparator type.
+        using compare_type = Compare;
+        /// @brief 分配器类型 / allocator type.
+        using allocator_type = Allocator;
+        /// @brief 大小类型 / size type.
+        using size_type = std::size_t;
+        /// @brief 差值类型 / difference type.
+        using difference_type = std::ptrdiff_t;
+        /// @brief 引用类型 / reference type.
+        using reference = value_type &;
+        /// @brief 常量引用类型 / const reference type.
+        using const_reference = const value_type &;
+
+    private:
+        /// @brief 结点分配器类型 / allocator type for node.
+        using node_allocator_type =
+            typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+
+        /// @brief 结点分配器 traits / allocator traits for node.
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+
+    public:
+        // ============================
+        // 迭代器定义 / Iterator definition
+        // ============================
+
+        /**
+         * @brief
+         *  双向迭代器，沿线索按中序访问元素。
+         *  Bidirectional iterator following threads in in-order.
+         */
+        class iterator
+        {
+        public:
+            /// @brief 迭代器类别 / iterator category.
+            using iterator_category = std::bidirectional_iterator_tag;
+            /// @brief 值类型 / value type.
+            using value_type = T;
+            /// @brief 差值类型 / difference type.
+            using difference_type = std::ptrdiff_t;
+            /// @brief 指针类型 / pointer type.
+            using pointer = T *;
+            /// @brief 引用类型 / reference type.
+            using reference = T &;
+
+            /// @brief 默认构造，指向空 / default constructor, points to null.
+            iterator() noexcept : current_(nullptr), owner_(nullptr) {}
+
+            /// @brief 解引用 / dereference.
+            reference operator*() const noexcept
+            {
+                return current_->value;
+            }
+
+            /// @brief 指针访问 / pointer access.
+            pointer operator->() const noexcept
+            {
+                return &current_->value;
+            }
+
+            /// @brief 前置++，移动到下一个元素 / pre-increment, move to next element.
+            iterator &operator++() noexcept
+            {
+                current_ = ThreadedBinaryTree::next_node(current_);
+                return *this;
+            }
+
+            /// @brief 后置++ / post-increment.
+            iterator operator++(int) noexcept
+            {
+                iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            /// @brief 前置--，移动到前一个元素；若当前为 end()，则跳到最大元素。
+            ///        pre-decrement, move to previous element; if at end(), jumps to maximum element.
+            iterator &operator--() noexcept
+            {
+                if (!owner_)
+                {
+                    return *this;
+                }
+                if (!current_)
+                { // end() -> 最大元素 / end() -> max element
+                    current_ = ThreadedBinaryTree::maximum(owner_->root_);
+                }
+                else
+                {
+                    current_ = ThreadedBinaryTree::prev_node(current_);
+                }
+                return *this;
+            }
+
+            /// @brief 后置-- / post-decrement.
+            iterator operator--(int) noexcept
+            {
+                iterator tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            /// @brief 相等比较 / equality comparison.
+            friend bool operator==(const iterator &a, const iterator &b) noexcept
+            {
+                return a.current_ == b.current_;
+            }
+
+            /// @brief 不等比较 / inequality comparison.
+            friend bool operator!=(const iterator &a, const iterator &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            node *current_;
+            const ThreadedBinaryTree *owner_;
+
+            explicit iterator(node *n, const ThreadedBinaryTree *owner) noexcept
+                : current_(n), owner_(owner) {}
+
+            friend class ThreadedBinaryTree;
+            friend class const_iterator;
+        };
+
+        /**
+         * @brief
+         *  常量双向迭代器 / const bidirectional iterator.
+         */
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() noexcept : current_(nullptr), owner_(nullptr) {}
+
+            /// @brief 从非常量迭代器构造 / construct from non-const iterator.
+            const_iterator(const iterator &it) noexcept
+                : current_(it.current_), owner_(it.owner_) {}
+
+            reference operator*() const noexcept
+            {
+                return current_->value;
+            }
+
+            pointer operator->() const noexcept
+            {
+                return &current_->value;
+            }
+
+            const_iterator &operator++() noexcept
+            {
+                current_ = ThreadedBinaryTree::next_node(current_);
+                return *this;
+            }
+
+            const_iterator operator++(int) noexcept
+            {
+                const_iterator tmp(*this);
+                ++(*this);
+                return tmp;
+            }
+
+            const_iterator &operator--() noexcept
+            {
+                if (!owner_)
+                {
+                    return *this;
+                }
+                if (!current_)
+                {
+                    current_ = ThreadedBinaryTree::maximum(owner_->root_);
+                }
+                else
+                {
+                    current_ = ThreadedBinaryTree::prev_node(current_);
+                }
+                return *this;
+            }
+
+            const_iterator operator--(int) noexcept
+            {
+                const_iterator tmp(*this);
+                --(*this);
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator &a,
+                                   const const_iterator &b) noexcept
+            {
+                return a.current_ == b.current_;
+            }
+
+            friend bool operator!=(const const_iterator &a,
+                                   const const_iterator &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            node *current_;
+            const ThreadedBinaryTree *owner_;
+
+            explicit const_iterator(node *n, const ThreadedBinaryTree *owner) noexcept
+                : current_(n), owner_(owner) {}
+
+            friend class ThreadedBinaryTree;
+        };
+
+        // ============================
+        // 构造 / 析构 / 赋值
+        // Constructors / destructor / assignment
+        // ============================
+
+        /**
+         * @brief
+         *  默认构造，使用缺省比较器和分配器。
+         *  Default constructor using default comparator and allocator.
+         */
+        ThreadedBinaryTree()
+            : root_(nullptr),
+              size_(0),
+              comp_(),
+              alloc_(),
+              node_alloc_(alloc_) {}
+
+        /**
+         * @brief
+         *  使用指定比较器和分配器构造。
+         *  Construct with specific comparator and allocator.
+         */
+        explicit ThreadedBinaryTree(const Compare &comp,
+                                    const Allocator &alloc = Allocator())
+            : root_(nullptr),
+              size_(0),
+              comp_(comp),
+              alloc_(alloc),
+              node_alloc_(alloc_) {}
+
+        /**
+         * @brief
+         *  仅指定分配器构造，比较器使用缺省。
+         *  Construct with allocator only, comparator is default constructed.
+         */
+        explicit ThreadedBinaryTree(const Allocator &alloc)
+            : root_(nullptr),
+              size_(0),
+              comp_(),
+              alloc_(alloc),
+              node_alloc_(alloc_) {}
+
+        /**
+         * @brief
+         *  区间构造，从 [first, last) 插入所有元素。
+         *  Range constructor, inserts all elements from [first, last).
+         */
+        template <class InputIt>
+        ThreadedBinaryTree(InputIt first, InputIt last,
+                           const Compare &comp = Compare(),
+                           const Allocator &alloc = Allocator())
+            : ThreadedBinaryTree(comp, alloc)
+        {
+            insert(first, last);
+        }
+
+        /**
+         * @brief
+         *  使用初始化列表构造。
+         *  Construct from initializer list.
+         */
+        ThreadedBinaryTree(std::initializer_list<T> init,
+                           const Compare &comp = Compare(),
+                           const Allocator &alloc = Allocator())
+            : ThreadedBinaryTree(comp, alloc)
+        {
+            insert(init);
+        }
+
+        /**
+         * @brief
+         *  拷贝构造函数，按结构深拷贝整棵树并重建线索。
+         *  Copy constructor, deep-copies the tree structure and rebuilds threads.
+         */
+        ThreadedBinaryTree(const ThreadedBinaryTree &other)
+            : ThreadedBinaryTree(other.comp_,
+                                 std::allocator_traits<Allocator>::
+                                     select_on_container_copy_construction(other.alloc_))
+        {
+            root_ = clone_tree(other.root_);
+            size_ = other.size_;
+        }
+
+        /**
+         * @brief
+         *  移动构造函数，接管另一棵树的资源。
+         *  Move constructor, steal resources from another tree.
+         */
+        ThreadedBinaryTree(ThreadedBinaryTree &&other) noexcept
+            : root_(other.root_),
+              size_(other.size_),
+              comp_(std::move(other.comp_)),
+              alloc_(std::move(other.alloc_)),
+              node_alloc_(std::move(other.node_alloc_))
+        {
+            other.root_ = nullptr;
+            other.size_ = 0;
+        }
+
+        /**
+         * @brief
+         *  析构函数，释放所有结点。
+         *  Destructor, releases all nodes.
+         */
+        ~ThreadedBinaryTree()
+        {
+            clear();
+        }
+
+        /**
+         * @brief
+         *  拷贝赋值运算符。
+         *  Copy assignment operator.
+         */
+        ThreadedBinaryTree &operator=(const ThreadedBinaryTree &other)
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+            ThreadedBinaryTree tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+        /**
+         * @brief
+         *  移动赋值运算符。
+         *  Move assignment operator.
+         */
+        ThreadedBinaryTree &operator=(ThreadedBinaryTree &&other) noexcept
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+
+            clear();
+
+            if constexpr (std::allocator_traits<Allocator>::
+                              propagate_on_container_move_assignment::value)
+            {
+                alloc_ = std::move(other.alloc_);
+                node_alloc_ = std::move(other.node_alloc_);
+            }
+            comp_ = std::move(other.comp_);
+            root_ = other.root_;
+            size_ = other.size_;
+
+            other.root_ = nullptr;
+            other.size_ = 0;
+            return *this;
+        }
+
+        // ============================
+        // 容量 / Capacity
+        // ============================
+
+        /**
+         * @brief
+         *  是否为空。
+         *  Check if container is empty.
+         */
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        /**
+         * @brief
+         *  返回元素个数。
+         *  Get number of elements.
+         */
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        /**
+         * @brief
+         *  清空整棵树（沿线索中序释放，O(1) 额外空间）。
+         *  Clear the whole tree (frees nodes in-order along threads, O(1) extra space).
+         */
+        void clear() noexcept
+        {
+            destroy_tree(root_);
+            root_ = nullptr;
+            size_ = 0;
+        }
+
+        // ============================
+        // 迭代器 / Iterators
+        // ============================
+
+        /// @brief 返回指向第一个元素的迭代器 / return iterator to first element.
+        iterator begin() noexcept
+        {
+            return iterator(minimum(root_), this);
+        }
+
+        /// @brief 返回指向第一个元素的常量迭代器 / return const iterator to first element.
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(minimum(root_), this);
+        }
+
+        /// @brief 返回指向第一个元素的常量迭代器 / return const iterator to first element.
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        /// @brief 返回尾后迭代器 / return iterator past the last element.
+        iterator end() noexcept
+        {
+            return iterator(nullptr, this);
+        }
+
+        /// @brief 返回尾后常量迭代器 / return const iterator past the last element.
+        const_iterator end() const noexcept
+        {
+            return const_iterator(nullptr, this);
+        }
+
+        /// @brief 返回尾后常量迭代器 / return const iterator past the last element.
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        // ============================
+        // 修改器 / Modifiers
+        // ============================
+
+        /**
+         * @brief
+         *  插入一个值（拷贝），若已存在则不插入。
+         *  Insert a value (copy). If already exists, no insertion.
+         *
+         * @return
+         *  pair(迭代器, 是否插入成功) / pair(iterator, bool inserted).
+         */
+        std::pair<iterator, bool> insert(const T &value)
+        {
+            return emplace_internal(value);
+        }
+
+        /**
+         * @brief
+         *  插入一个值（移动），若已存在则不插入。
+         *  Insert a value (move). If already exists, no insertion.
+         */
+        std::pair<iterator, bool> insert(T &&value)
+        {
+            return emplace_internal(std::move(value));
+        }
+
+        /**
+         * @brief
+         *  插入区间 [first, last) 的所有元素。
+         *  Insert all elements from range [first, last).
+         */
+        template <class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+            {
+                insert(*first);
+            }
+        }
+
+        /**
+         * @brief
+         *  插入初始化列表中所有元素。
+         *  Insert all elements from initializer list.
+         */
+        void insert(std::initializer_list<T> init)
+        {
+            insert(init.begin(), init.end());
+        }
+
+        /**
+         * @brief
+         *  删除指定位置的元素，返回指向后一个元素的迭代器。
+         *  Erase element at given position, returns iterator to next element.
+         */
+        iterator erase(iterator pos)
+        {
+            if (pos == end())
+            {
+                return end();
+            }
+            node *n = pos.current_;
+            iterator next_it = ++pos;
+            erase_at(find_parent(n), n);
+            return next_it;
+        }
+
+        /**
+         * @brief
+         *  删除指定位置的元素（const 版本）。
+         *  Erase element at given position (const version).
+         */
+        iterator erase(const_iterator pos)
+        {
+            return erase(iterator(pos.current_, this));
+        }
+
+        /**
+         * @brief
+         *  删除等于 key 的元素（此容器中最多 1 个）。
+         *  Erase element equal to key (at most 1 in this container).
+         *
+         * @return
+         *  删除的元素个数（0 或 1）/ number of erased elements (0 or 1).
+         */
+        size_type erase(const T &key)
+        {
+            node *parent = nullptr;
+            node *cur = root_;
+            while (cur)
+            {
+                std::uintptr_t link;
+                if (comp_(key, cur->value))
+                {
+                    link = cur->left;
+                }
+                else if (comp_(cur->value, key))
+                {
+                    link = cur->right;
+                }
+                else
+                {
+                    erase_at(parent, cur);
+                    return 1;
+                }
+                if (is_thread(link))
+                {
+                    return 0;
+                }
+                parent = cur;
+                cur = to_node(link);
+            }
+            return 0;
+        }
+
+        /**
+         * @brief
+         *  与另一棵树交换内容。
+         *  Swap contents with another tree.
+         */
+        void swap(ThreadedBinaryTree &other) noexcept(
+            node_alloc_traits::is_always_equal::value &&
+            std::is_nothrow_swappable<Compare>::value)
+        {
+            using std::swap;
+            swap(root_, other.root_);
+            swap(size_, other.size_);
+            swap(comp_, other.comp_);
+            if constexpr (node_alloc_traits::propagate_on_container_swap::value)
+            {
+                swap(node_alloc_, other.node_alloc_);
+                swap(alloc_, other.alloc_);
+            }
+        }
+
+        // ============================
+        // 查找 / Lookup
+        // ============================
+
+        /**
+         * @brief
+         *  查找等于 key 的元素。
+         *  Find element equal to key.
+         */
+        iterator find(const T &key) noexcept
+        {
+            return iterator(find_node(key), this);
+        }
+
+        /**
+         * @brief
+         *  查找等于 key 的元素（常量版本）。
+         *  Find element equal to key (const version).
+         */
+        const_iterator find(const T &key) const noexcept
+        {
+            return const_iterator(find_node(key), this);
+        }
+
+        /**
+         * @brief
+         *  是否包含等于 key 的元素。
+         *  Check if container contains an element equal to key.
+         */
+        bool contains(const T &key) const noexcept
+        {
+            return find_node(key) != nullptr;
+        }
+
+        // ============================
+        // 访问器 / Observers
+        // ============================
+
+        /**
+         * @brief
+         *  返回比较器对象。
+         *  Get comparator object.
+         */
+        compare_type value_comp() const
+        {
+            return comp_;
+        }
+
+        /**
+         * @brief
+         *  返回分配器。
+         *  Get allocator.
+         */
+        allocator_type get_allocator() const noexcept
+        {
+            return alloc_;
+        }
+
+    private:
+        // ============================
+        // 成员变量 / Data members
+        // ============================
+        /// @brief 根结点指针 / root node pointer.
+        node *root_;
+        /// @brief 元素个数 / number of elements.
+        size_type size_;
+        /// @brief 比较器 / comparator.
+        compare_type comp_;
+        /// @brief 元素分配器 / allocator for values.
+        allocator_type alloc_;
+        /// @brief 结点分配器 / allocator for nodes.
+        node_allocator_type node_alloc_;
+
+        // ============================
+        // 链接编码 / Link encoding
+        // ============================
+
+        /// @brief 链接是否为线索 / whether a link is a thread.
+        static bool is_thread(std::uintptr_t link) noexcept
+        {
+            return (link & 1u) != 0;
+        }
+
+        /// @brief 取出链接指向的结点（去掉标记位）/ node a link refers to (tag stripped).
+        static node *to_node(std::uintptr_t link) noexcept
+        {
+            return reinterpret_cast<node *>(link & ~static_cast<std::uintptr_t>(1));
+        }
+
+        /// @brief 编码孩子链接 / encode a child link.
+        static std::uintptr_t child_link(node *n) noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(n);
+        }
+
+        /// @brief 编码线索链接 / encode a thread link.
+        static std::uintptr_t thread_link(node *n) noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(n) | 1u;
+        }
+
+        // ============================
+        // 结点工具函数 / Node helpers
+        // ============================
+
+        /**
+         * @brief
+         *  在子树中找到最小结点。
+         *  Find minimum node in subtree.
+         */
+        static node *minimum(node *n) noexcept
+        {
+            if (!n)
+                return nullptr;
+            while (!is_thread(n->left))
+            {
+                n = to_node(n->left);
+            }
+            return n;
+        }
+
+        /**
+         * @brief
+         *  在子树中找到最大结点。
+         *  Find maximum node in subtree.
+         */
+        static node *maximum(node *n) noexcept
+        {
+            if (!n)
+                return nullptr;
+            while (!is_thread(n->right))
+            {
+                n = to_node(n->right);
+            }
+            return n;
+        }
+
+        /**
+         * @brief
+         *  中序后继：右链接为线索时一次加载即可得到。
+         *  In-order successor: a single load when the right link is a thread.
+         */
+        static node *next_node(node *n) noexcept
+        {
+            if (!n)
+                return nullptr;
+            std::uintptr_t r = n->right;
+            if (is_thread(r))
+            {
+                return to_node(r);
+            }
+            return minimum(to_node(r));
+        }
+
+        /**
+         * @brief
+         *  中序前驱：左链接为线索时一次加载即可得到。
+         *  In-order predecessor: a single load when the left link is a thread.
+         */
+        static node *prev_node(node *n) noexcept
+        {
+            if (!n)
+                return nullptr;
+            std::uintptr_t l = n->left;
+            if (is_thread(l))
+            {
+                return to_node(l);
+            }
+            return maximum(to_node(l));
+        }
+
+        /**
+         * @brief
+         *  分配并构造一个结点。
+         *  Allocate and construct a node.
+         */
+        template <class U>
+        node *create_node(U &&value, std::uintptr_t left, std::uintptr_t right)
+        {
+            node *n = node_alloc_traits::allocate(node_alloc_, 1);
+            try
+            {
+                node_alloc_traits::construct(node_alloc_, n, std::forward<U>(value), left, right);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(node_alloc_, n, 1);
+                throw;
+            }
+            return n;
+        }
+
+        /**
+         * @brief
+         *  销毁并释放结点。
+         *  Destroy and deallocate node.
+         */
+        void destroy_node(node *n) noexcept
+        {
+            if (!n)
+                return;
+            node_alloc_traits::destroy(node_alloc_, n);
+            node_alloc_traits::deallocate(node_alloc_, n, 1);
+        }
+
+        /**
+         * @brief
+         *  沿线索按中序释放整棵树，不递归。
+         *  Free a whole tree in order along the threads, without recursion.
+         */
+        void destroy_tree(node *root) noexcept
+        {
+            node *cur = minimum(root);
+            while (cur)
+            {
+                node *next = next_node(cur);
+                destroy_node(cur);
+                cur = next;
+            }
+        }
+
+        /**
+         * @brief
+         *  用显式栈按先序复制整棵树：树不做平衡，升序建成的树深度为 N，不能逐层递归。
+         *  每个待展开的结点先以子树外侧的中序前驱/后继作线索，所以复制到一半的树始终是
+         *  合法的线索树，失败时按 destroy_tree 释放即可。
+         *  Clone a whole tree in preorder with an explicit stack: the tree never rebalances
+         *  and sorted input makes it N deep, so recursing per level is not an option. Each
+         *  node waiting to be expanded threads to the in-order neighbours outside its
+         *  subtree, so a half-built copy is always a valid threaded tree and a failed copy is
+         *  released by destroy_tree.
+         */
+        node *clone_tree(const node *src_root)
+        {
+            if (!src_root)
+                return nullptr;
+
+            // 待展开的结点：源结点、副本与子树外侧的中序前驱/后继
+            // node waiting to be expanded: source, copy and the in-order neighbours outside its subtree
+            struct clone_frame
+            {
+                const node *src;
+                node *dst;
+                node *pred;
+                node *succ;
+            };
+
+            node *root = create_node(src_root->value, thread_link(nullptr), thread_link(nullptr));
+            try
+            {
+                std::vector<clone_frame> stack;
+                stack.push_back({src_root, root, nullptr, nullptr});
+                while (!stack.empty())
+                {
+                    clone_frame f = stack.back();
+                    stack.pop_back();
+                    if (!is_thread(f.src->right))
+                    {
+                        const node *src = to_node(f.src->right);
+                        node *c = create_node(src->value, thread_link(f.dst), thread_link(f.succ));
+                        f.dst->right = child_link(c);
+                        stack.push_back({src, c, f.dst, f.succ});
+                    }
+                    if (!is_thread(f.src->left))
+                    {
+                        const node *src = to_node(f.src->left);
+                        node *c = create_node(src->value, thread_link(f.pred), thread_link(f.dst));
+                        f.dst->left = child_link(c);
+                        stack.push_back({src, c, f.pred, f.dst});
+                    }
+                }
+            }
+            catch (...)
+            {
+                destroy_tree(root);
+                throw;
+            }
+            return root;
+        }
+
+        /**
+         * @brief
+         *  在树中查找等于 key 的结点。
+         *  Find node equal to key in the tree.
+         */
+        node *find_node(const T &key) const noexcept
+        {
+            node *cur = root_;
+            while (cur)
+            {
+                std::uintptr_t link;
+                if (comp_(key, cur->value))
+                {
+                    link = cur->left;
+                }
+                else if (comp_(cur->value, key))
+                {
+                    link = cur->right;
+                }
+                else
+                {
+                    return cur;
+                }
+                if (is_thread(link))
+                {
+                    return nullptr;
+                }
+                cur = to_node(link);
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief
+         *  结点没有 parent 指针，按键从根下降找到父结点。
+         *  Nodes carry no parent pointer, so descend from the root by key to find the parent.
+         */
+        node *find_parent(const node *n) const noexcept
+        {
+            node *parent = nullptr;
+            node *cur = root_;
+            while (cur != n)
+            {
+                parent = cur;
+                cur = to_node(comp_(n->value, cur->value) ? cur->left : cur->right);
+            }
+            return parent;
+        }
+
+        /**
+         * @brief
+         *  把 parent 指向 z 的孩子链接替换为 c。
+         *  Replace parent's child link to z with a child link to c.
+         */
+        void replace_child(node *parent, node *z, node *c) noexcept
+        {
+            if (!parent)
+            {
+                root_ = c;
+            }
+            else if (parent->left == child_link(z))
+            {
+                parent->left = child_link(c);
+            }
+            else
+            {
+                parent->right = child_link(c);
+            }
+        }
+
+        /**
+         * @brief
+         *  删除 parent 下的结点 z，并修补所有指向 z 的线索（重新链接结点，不移动值）。
+         *  Erase node z below parent and repair every thread that referred to z
+         *  (relinks nodes instead of moving values).
+         */
+        void erase_at(node *parent, node *z) noexcept
+        {
+            const bool has_left = !is_thread(z->left);
+            const bool has_right = !is_thread(z->right);
+
+            if (has_left && has_right)
+            {
+                // 后继 s = min(z->right)，其左链接必为指向 z 的线索
+                // successor s = min(z->right); its left link is a thread to z
+                node *s_parent = z;
+                node *s = to_node(z->right);
+                while (!is_thread(s->left))
+                {
+                    s_parent = s;
+                    s = to_node(s->left);
+                }
+
+                // 前驱的右线索改指 s / predecessor's right thread now refers to s
+                maximum(to_node(z->left))->right = thread_link(s);
+
+                if (s_parent != z)
+                {
+                    s_parent->left = is_thread(s->right) ? thread_link(s) : s->right;
+                    s->right = z->right;
+                }
+                s->left = z->left;
+                replace_child(parent, z, s);
+            }
+            else if (has_left)
+            {
+                maximum(to_node(z->left))->right = z->right;
+                replace_child(parent, z, to_node(z->left));
+            }
+            else if (has_right)
+            {
+                minimum(to_node(z->right))->left = z->left;
+                replace_child(parent, z, to_node(z->right));
+            }
+            else if (!parent)
+            {
+                root_ = nullptr;
+            }
+            else if (parent->left == child_link(z))
+            {
+                parent->left = z->left;
+            }
+            else
+            {
+                parent->right = z->right;
+            }
+
+            destroy_node(z);
+            --size_;
+        }
+
+        /**
+         * @brief
+         *  内部 emplace 实现：新叶子继承父结点一侧的线索，并以父结点为另一侧线索。
+         *  Internal emplace: the new leaf inherits the parent's thread on one side and
+         *  threads to the parent on the other.
+         */
+        template <class U>
+        std::pair<iterator, bool> emplace_internal(U &&value)
+        {
+            if (!root_)
+            {
+                root_ = create_node(std::forward<U>(value), thread_link(nullptr), thread_link(nullptr));
+                ++size_;
+                return {iterator(root_, this), true};
+            }
+
+            node *cur = root_;
+            while (true)
+            {
+                if (comp_(value, cur->value))
+                {
+                    if (is_thread(cur->left))
+                    {
+                        node *n = create_node(std::forward<U>(value), cur->left, thread_link(cur));
+                        cur->left = child_link(n);
+                        ++size_;
+                        return {iterator(n, this), true};
+                    }
+                    cur = to_node(cur->left);
+                }
+                else if (comp_(cur->value, value))
+                {
+                    if (is_thread(cur->right))
+                    {
+                        node *n = create_node(std::forward<U>(value), thread_link(cur), cur->right);
+                        cur->right = child_link(n);
+                        ++size_;
+                        return {iterator(n, this), true};
+                    }
+                    cur = to_node(cur->right);
+                }
+                else
+                {
+                    // 已存在 / already exists
+                    return {iterator(cur, this), false};
+                }
+            }
+        }
+    };
+
+} // namespace test_forest
+
+#endif
@@ -0,0 +1,1111 @@
+#ifndef _WAVL_TREE_HPP
+#define _WAVL_TREE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace test_forest
+{
+
+    /**
+     * @brief 弱 AVL（WAVL，rank-balanced）树（接口同 avl_tree 的基本部分）
+     *        weak AVL (WAVL, rank-balanced) tree (same basic interface as avl_tree)
+     *
+     * @tparam T         键/值类型 / key & value type
+     * @tparam Compare   比较器(less) / comparator (less)
+     * @tparam Allocator 分配器(allocator) / allocator
+     *
+     * @note
+     *  - 每个节点存秩 r，空子树的秩为 -1；秩差（父减子）为 1 或 2，叶子为 (1, 1)
+     *    every node stores a rank r, with rank -1 for an empty subtree; rank differences
+     *    (parent minus child) are 1 or 2, and leaves are (1, 1)
+     *  - 只插入时秩差 (2, 2) 不会出现，树与 AVL 完全相同（秩 = 高度 - 1）
+     *    with insertions only, (2, 2) nodes never appear and the tree is exactly an AVL tree
+     *    (rank = height - 1)
+     *  - 插入与删除都至多做两次旋转（一次单旋或一次双旋），升降秩摊还 O(1)
+     *    both insertion and erasure make at most two rotations (one single or one double
+     *    rotation), with amortized O(1) promotions and demotions
+     *  - 删除可能留下 (2, 2) 节点，高度上界放宽为 2·log2 N
+     *    erasure may leave (2, 2) nodes, relaxing the height bound to 2·log2 N
+     */
+    template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class wavl_tree
+    {
+    private:
+        // ===================== 节点定义 / Node definition =====================
+
+        /**
+         * @brief 链接与秩（header 只有这一部分）/ links and rank (all the header has)
+         */
+        struct node_base
+        {
+            /// @brief 父节点指针 / parent pointer
+            node_base *parent;
+
+            /// @brief 左子节点指针 / left child pointer
+            node_base *left;
+
+            /// @brief 右子节点指针 / right child pointer
+            node_base *right;
+
+            /// @brief 秩；header 为 header_rank / rank; header_rank for the header
+            int rank;
+        };
+
+        /**
+         * @brief 完整节点 / full node
+         */
+        struct node : node_base
+        {
+            /// @brief 节点存储的值 / stored value
+            T value;
+
+            /**
+             * @brief 以左值构造叶节点（秩 0）/ construct a leaf from lvalue (rank 0)
+             */
+            explicit node(const T &v)
+                : node_base{nullptr, nullptr, nullptr, 0}, value(v)
+            {
+            }
+
+            /**
+             * @brief 以右值构造叶节点（秩 0）/ construct a leaf from rvalue (rank 0)
+             */
+            explicit node(T &&v)
+                : node_base{nullptr, nullptr, nullptr, 0}, value(std::move(v))
+            {
+            }
+        };
+
+        /// @brief header 的秩标记（真实节点的秩非负）/ header rank marker (real ranks are >= 0)
+        static constexpr int header_rank = -2;
+
+        // 为 allocator 重新绑定节点类型 / rebind allocator for node
+        using node_allocator_raw = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+        using node_traits = std::allocator_traits<node_allocator_raw>;
+
+        // ===================== 字段访问 / Field access =====================
+
+        /// @brief 取父节点 / get parent
+        static node_base *parent_of(const node_base *n) noexcept
+        {
+            return n->parent;
+        }
+
+        /// @brief 设置父节点 / set parent
+        static void set_parent(node_base *n, node_base *p) noexcept
+        {
+            n->parent = p;
+        }
+
+        /// @brief 子树的秩，空为 -1 / rank of a subtree, -1 if empty
+        static int rank_of(const node_base *n) noexcept
+        {
+            return n ? n->rank : -1;
+        }
+
+        /// @brief 是否为 header / whether n is the header
+        static bool is_header(const node_base *n) noexcept
+        {
+            return n->rank == header_rank;
+        }
+
+        /// @brief 子树最小节点 / minimum of subtree
+        static node_base *min_node(node_base *n) noexcept
+        {
+            while (n->left)
+                n = n->left;
+            return n;
+        }
+
+        /// @brief 子树最大节点 / maximum of subtree
+        static node_base *max_node(node_base *n) noexcept
+        {
+            while (n->right)
+                n = n->right;
+            return n;
+        }
+
+        /**
+         * @brief 中序后继；root 为最大值时经 header 绕回根的情况停在 header
+         *        in-order successor; stops on header when the climb wraps around through it
+         */
+        static node_base *next_node(node_base *n) noexcept
+        {
+            if (n->right)
+                return min_node(n->right);
+            node_base *p = parent_of(n);
+            while (n == p->right)
+            {
+                n = p;
+                p = parent_of(p);
+            }
+            return n->right != p ? p : n;
+        }
+
+        /**
+         * @brief 中序前驱；--end() 得到最大值 / in-order predecessor; --end() yields the maximum
+         */
+        static node_base *prev_node(node_base *n) noexcept
+        {
+            if (is_header(n))
+                return n->right;
+            if (n->left)
+                return max_node(n->left);
+            node_base *p = parent_of(n);
+            while (n == p->left)
+            {
+                n = p;
+                p = parent_of(p);
+            }
+            return p;
+        }
+
+        /// @brief 取节点值 / get node value
+        static T &value_of(node_base *n) noexcept
+        {
+            return static_cast<node *>(n)->value;
+        }
+
+        // ===================== 迭代器实现 / Iterator implementation =====================
+
+        /**
+         * @brief 双向中序迭代器 / bidirectional in-order iterator
+         */
+        class iterator_impl
+        {
+        public:
+            using value_type = T;
+            using reference = T &;
+            using pointer = T *;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            /// @brief 默认构造空迭代器 / default-construct null iterator
+            iterator_impl() noexcept : node_(nullptr) {}
+
+            reference operator*() const noexcept { return value_of(node_); }
+            pointer operator->() const noexcept { return std::addressof(value_of(node_)); }
+
+            iterator_impl &operator++() noexcept
+            {
+                node_ = next_node(node_);
+                return *this;
+            }
+
+            iterator_impl operator++(int) noexcept
+            {
+                iterator_impl tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+
+            iterator_impl &operator--() noexcept
+            {
+                node_ = prev_node(node_);
+                return *this;
+            }
+
+            iterator_impl operator--(int) noexcept
+            {
+                iterator_impl tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            friend bool operator==(const iterator_impl &a, const iterator_impl &b) noexcept
+            {
+                return a.node_ == b.node_;
+            }
+
+            friend bool operator!=(const iterator_impl &a, const iterator_impl &b) noexcept
+            {
+                return a.node_ != b.node_;
+            }
+
+        private:
+            /// @brief 当前节点指针 / underlying node pointer
+            node_base *node_;
+
+            /// @brief 允许容器访问内部节点指针 / allow wavl_tree to access node_
+            friend class wavl_tree;
+
+            /// @brief 通过节点构造迭代器 / construct from node pointer
+            explicit iterator_impl(node_base *n) noexcept : node_(n) {}
+        };
+
+        /**
+         * @brief const 版本迭代器，可由非 const 迭代器隐式构造
+         *        const iterator, implicitly constructible from the non-const one
+         */
+        class const_iterator_impl
+        {
+        public:
+            using value_type = T;
+            using reference = const T &;
+            using pointer = const T *;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            /// @brief 默认构造空迭代器 / default-construct null iterator
+            const_iterator_impl() noexcept : node_(nullptr) {}
+
+            /// @brief 从非 const 迭代器构造 / construct from non-const iterator
+            const_iterator_impl(const iterator_impl &it) noexcept : node_(it.node_) {}
+
+            reference operator*() const noexcept { return value_of(node_); }
+            pointer operator->() const noexcept { return std::addressof(value_of(node_)); }
+
+            const_iterator_impl &operator++() noexcept
+            {
+                node_ = next_node(node_);
+                return *this;
+            }
+
+            const_iterator_impl operator++(int) noexcept
+            {
+                const_iterator_impl tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+
+            const_iterator_impl &operator--() noexcept
+            {
+                node_ = prev_node(node_);
+                return *this;
+            }
+
+            const_iterator_impl operator--(int) noexcept
+            {
+                const_iterator_impl tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            friend bool operator==(const const_iterator_impl &a, const const_iterator_impl &b) noexcept
+            {
+                return a.node_ == b.node_;
+            }
+
+            friend bool operator!=(const const_iterator_impl &a, const const_iterator_impl &b) noexcept
+            {
+                return a.node_ != b.node_;
+            }
+
+        private:
+            /// @brief 当前节点指针（链接部分从不经由迭代器修改）
+            ///        underlying node pointer (links are never modified through an iterator)
+            node_base *node_;
+
+            /// @brief 允许容器访问内部节点指针 / allow wavl_tree to access node_
+            friend class wavl_tree;
+
+            /// @brief 通过节点构造迭代器 / construct from node pointer
+            explicit const_iterator_impl(const node_base *n) noexcept
+                : node_(const_cast<node_base *>(n))
+            {
+            }
+        };
+
+    public:
+        // ===================== 公共类型别名 / Public type aliases =====================
+
+        using key_type = T;
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using allocator_type = Allocator;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using iterator = iterator_impl;
+        using const_iterator = const_iterator_impl;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // ===================== 构造/析构 / Constructors & destructor =====================
+
+        /**
+         * @brief 默认构造空树 / construct empty tree
+         */
+        wavl_tree()
+            : wavl_tree(key_compare(), allocator_type())
+        {
+        }
+
+        /**
+         * @brief 使用比较器和分配器构造 / construct with comparator and allocator
+         *
+         * @param comp  比较器 / comparator
+         * @param alloc 分配器 / allocator
+         */
+        explicit wavl_tree(const key_compare &comp, const allocator_type &alloc = allocator_type())
+            : header_(), size_(0), comp_(comp), alloc_(alloc)
+        {
+            reset_header();
+        }
+
+        /**
+         * @brief 仅指定分配器构造 / construct with allocator only
+         *
+         * @param alloc 分配器 / allocator
+         */
+        explicit wavl_tree(const allocator_type &alloc)
+            : wavl_tree(key_compare(), alloc)
+        {
+        }
+
+        /**
+         * @brief 区间构造 / range constructor
+         */
+        template <class InputIt>
+        wavl_tree(InputIt first, InputIt last,
+                        const key_compare &comp = key_compare(),
+                        const allocator_type &alloc = allocator_type())
+            : wavl_tree(comp, alloc)
+        {
+            insert(first, last);
+        }
+
+        /**
+         * @brief 初始化列表构造 / initializer-list constructor
+         */
+        wavl_tree(std::initializer_list<value_type> init,
+                        const key_compare &comp = key_compare(),
+                        const allocator_type &alloc = allocator_type())
+            : wavl_tree(comp, alloc)
+        {
+            insert(init.begin(), init.end());
+        }
+
+        /**
+         * @brief 拷贝构造：逐节点复制结构与秩，O(N)
+         *        copy constructor: clones structure and ranks node by node, O(N)
+         *
+         * @param other 另一棵树 / another tree
+         */
+        wavl_tree(const wavl_tree &other)
+            : wavl_tree(other.comp_,
+                              std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                                  other.get_allocator()))
+        {
+            if (!other.root())
+                return;
+            node_base *r = clone_subtree(other.root(), &header_);
+            set_root(r);
+            header_.left = min_node(r);
+            header_.right = max_node(r);
+            size_ = other.size_;
+        }
+
+        /**
+         * @brief 移动构造 / move constructor
+         *
+         * @param other 被移动的树 / tree to move from
+         */
+        wavl_tree(wavl_tree &&other) noexcept
+            : header_(), size_(0), comp_(std::move(other.comp_)), alloc_(std::move(other.alloc_))
+        {
+            reset_header();
+            steal(other);
+        }
+
+        /**
+         * @brief 拷贝赋值 / copy assignment
+         */
+        wavl_tree &operator=(const wavl_tree &other)
+        {
+            if (this == &other)
+                return *this;
+
+            wavl_tree tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+        /**
+         * @brief 移动赋值 / move assignment
+         */
+        wavl_tree &operator=(wavl_tree &&other) noexcept
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+            comp_ = std::move(other.comp_);
+            alloc_ = std::move(other.alloc_);
+            steal(other);
+            return *this;
+        }
+
+        /**
+         * @brief 析构函数 / destructor
+         */
+        ~wavl_tree()
+        {
+            clear();
+        }
+
+        // ===================== 基本属性 / Basic properties =====================
+
+        allocator_type get_allocator() const noexcept
+        {
+            return allocator_type(alloc_);
+        }
+
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        /**
+         * @brief 单个节点占用的字节数 / bytes occupied by one node
+         */
+        static constexpr size_type node_size() noexcept
+        {
+            return sizeof(node);
+        }
+
+        /**
+         * @brief 清空所有元素 / clear all elements
+         */
+        void clear() noexcept
+        {
+            destroy_subtree(root());
+            reset_header();
+            size_ = 0;
+        }
+
+        // ===================== 插入 / Insertion =====================
+
+        /**
+         * @brief 插入一个元素（左值）/ insert a value (lvalue)
+         *
+         * @return pair(迭代器, 是否插入成功) / pair(iterator, inserted ?)
+         */
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            return insert_impl(value);
+        }
+
+        /**
+         * @brief 插入一个元素（右值）/ insert a value (rvalue)
+         *
+         * @return pair(迭代器, 是否插入成功) / pair(iterator, inserted ?)
+         */
+        std::pair<iterator, bool> insert(value_type &&value)
+        {
+            return insert_impl(std::move(value));
+        }
+
+        /**
+         * @brief 插入区间内所有元素 / insert every element of a range
+         */
+        template <class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        // ===================== 删除 / Erase =====================
+
+        /**
+         * @brief 根据键删除元素 / erase element by key
+         *
+         * @return 删除的数量(0 或 1) / count of erased elements (0 or 1)
+         */
+        size_type erase(const key_type &key)
+        {
+            iterator it = find(key);
+            if (it == end())
+                return 0;
+            erase(it);
+            return 1;
+        }
+
+        /**
+         * @brief 删除指定位置的元素 / erase element at iterator
+         *
+         * @return 删除元素后的位置 / iterator following the erased element
+         */
+        iterator erase(const_iterator pos)
+        {
+            node_base *n = pos.node_;
+            assert(n && !is_header(n) && "erase on end() is undefined");
+
+            iterator next(next_node(n));
+            erase_node(n);
+            return next;
+        }
+
+        // ===================== 迭代器接口 / Iterator interface =====================
+
+        iterator begin() noexcept { return iterator(header_.left); }
+        const_iterator begin() const noexcept { return const_iterator(header_.left); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return iterator(&header_); }
+        const_iterator end() const noexcept { return const_iterator(&header_); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        // ===================== 查找与范围 / Lookup & range =====================
+
+        /**
+         * @brief 按键查找元素 / find element by key
+         *
+         * @return 指向找到元素的迭代器，若无则为 end() / iterator to element or end()
+         */
+        iterator find(const key_type &key)
+        {
+            return iterator(find_node(key));
+        }
+
+        const_iterator find(const key_type &key) const
+        {
+            return const_iterator(find_node(key));
+        }
+
+        size_type count(const key_type &key) const
+        {
+            return find(key) == end() ? 0 : 1;
+        }
+
+        bool contains(const key_type &key) const
+        {
+            return find(key) != end();
+        }
+
+        /**
+         * @brief 第一个不小于 key 的元素 / first element not less than key
+         */
+        iterator lower_bound(const key_type &key)
+        {
+            return iterator(lower_bound_node(key));
+        }
+
+        const_iterator lower_bound(const key_type &key) const
+        {
+            return const_iterator(lower_bound_node(key));
+        }
+
+        /**
+         * @brief 第一个大于 key 的元素 / first element greater than key
+         */
+        iterator upper_bound(const key_type &key)
+        {
+            return iterator(upper_bound_node(key));
+        }
+
+        const_iterator upper_bound(const key_type &key) const
+        {
+            return const_iterator(upper_bound_node(key));
+        }
+
+        std::pair<iterator, iterator> equal_range(const key_type &key)
+        {
+            return {lower_bound(key), upper_bound(key)};
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return {lower_bound(key), upper_bound(key)};
+        }
+
+        key_compare key_comp() const
+        {
+            return comp_;
+        }
+
+        value_compare value_comp() const
+        {
+            return comp_;
+        }
+
+        // ===================== 其它辅助接口 / Other helpers =====================
+
+        /**
+         * @brief 交换两棵树的内容 / swap contents of two trees
+         */
+        void swap(wavl_tree &other) noexcept
+        {
+            using std::swap;
+            swap(header_, other.header_);
+            swap(size_, other.size_);
+            swap(comp_, other.comp_);
+            swap(alloc_, other.alloc_);
+            // header 内嵌在对象里，交换后需让根重新指向各自的 header
+            // headers are embedded, so each root must be re-pointed at its new header
+            reattach_header();
+            other.reattach_header();
+        }
+
+    private:
+        // ===================== 内部状态 / Internal state =====================
+
+        /// @brief 内嵌 header：parent 为根，left/right 为最小/最大节点
+        ///        embedded header: parent is the root, left/right the minimum/maximum
+        node_base header_;
+
+        /// @brief 元素数量 / number of elements
+        size_type size_;
+
+        /// @brief 键比较器 / key comparator
+        key_compare comp_;
+
+        /// @brief 节点分配器 / node allocator
+        node_allocator_raw alloc_;
+
+        // ===================== 内部工具函数 / Internal helpers =====================
+
+        /// @brief 根节点 / root node
+        node_base *root() const noexcept
+        {
+            return parent_of(&header_);
+        }
+
+        /// @brief 设置根节点 / set root node
+        void set_root(node_base *r) noexcept
+        {
+            header_.parent = r;
+        }
+
+        /// @brief 把 header 置为空树状态 / reset header to the empty state
+        void reset_header() noexcept
+        {
+            header_.parent = nullptr;
+            header_.rank = header_rank;
+            header_.left = &header_;
+            header_.right = &header_;
+        }
+
+        /**
+         * @brief 接管 other 的节点（比较器与分配器由调用者处理），other 变为空
+         *        take over other's nodes (comparator and allocator are handled by the caller),
+         *        leaving other empty
+         */
+        void steal(wavl_tree &other) noexcept
+        {
+            node_base *r = other.root();
+            if (!r)
+            {
+                reset_header();
+                size_ = 0;
+                return;
+            }
+            set_root(r);
+            set_parent(r, &header_);
+            header_.left = other.header_.left;
+            header_.right = other.header_.right;
+            size_ = other.size_;
+            other.reset_header();
+            other.size_ = 0;
+        }
+
+        /// @brief header 被整体搬移后修复根的父指针与空树自指 / repair the root's parent link and
+        ///        the empty self-links after the header has been relocated
+        void reattach_header() noexcept
+        {
+            if (size_ == 0)
+                reset_header();
+            else
+                set_parent(root(), &header_);
+        }
+
+        /// @brief 在父节点（或 header）中把子链接 from 替换为 to / replace child link from with to
+        void replace_child(node_base *p, node_base *from, node_base *to) noexcept
+        {
+            if (p == &header_)
+                set_root(to);
+            else if (p->left == from)
+                p->left = to;
+            else
+                p->right = to;
+        }
+
+        template <class U>
+        node *create_node(U &&v)
+        {
+            node *n = node_traits::allocate(alloc_, 1);
+            try
+            {
+                node_traits::construct(alloc_, n, std::forward<U>(v));
+            }
+            catch (...)
+            {
+                node_traits::deallocate(alloc_, n, 1);
+                throw;
+            }
+            return n;
+        }
+
+        void destroy_node(node_base *b) noexcept
+        {
+            node *n = static_cast<node *>(b);
+            node_traits::destroy(alloc_, n);
+            node_traits::deallocate(alloc_, n, 1);
+        }
+
+        void destroy_subtree(node_base *n) noexcept
+        {
+            while (n)
+            {
+                destroy_subtree(n->right);
+                node_base *l = n->left;
+                destroy_node(n);
+                n = l;
+            }
+        }
+
+        /**
+         * @brief 复制子树（含秩）/ clone a subtree including ranks
+         */
+        node_base *clone_subtree(const node_base *src, node_base *parent)
+        {
+            node *n = create_node(value_of(const_cast<node_base *>(src)));
+            n->parent = parent;
+            n->rank = src->rank;
+            try
+            {
+                if (src->left)
+                    n->left = clone_subtree(src->left, n);
+                if (src->right)
+                    n->right = clone_subtree(src->right, n);
+            }
+            catch (...)
+            {
+                destroy_subtree(n);
+                throw;
+            }
+            return n;
+        }
+
+        node_base *find_node(const key_type &key) const
+        {
+            node_base *cur = root();
+            while (cur)
+            {
+                if (comp_(key, value_of(cur)))
+                    cur = cur->left;
+                else if (comp_(value_of(cur), key))
+                    cur = cur->right;
+                else
+                    return cur;
+            }
+            return const_cast<node_base *>(&header_);
+        }
+
+        node_base *lower_bound_node(const key_type &key) const
+        {
+            node_base *cur = root();
+            node_base *result = const_cast<node_base *>(&header_);
+            while (cur)
+            {
+                if (!comp_(value_of(cur), key))
+                {
+                    result = cur;
+                    cur = cur->left;
+                }
+                else
+                {
+                    cur = cur->right;
+                }
+            }
+            return result;
+        }
+
+        node_base *upper_bound_node(const key_type &key) const
+        {
+            node_base *cur = root();
+            node_base *result = const_cast<node_base *>(&header_);
+            while (cur)
+            {
+                if (comp_(key, value_of(cur)))
+                {
+                    result = cur;
+                    cur = cur->left;
+                }
+                else
+                {
+                    cur = cur->right;
+                }
+            }
+            return result;
+        }
+
+        // ===================== 旋转 / Rotations =====================
+
+        /**
+         * @brief 把 c 旋到其父节点之上（方向由 c 是左子还是右子决定），不改秩
+         *        rotate c above its parent (direction given by which child c is); ranks untouched
+         */
+        void rotate_up(node_base *c) noexcept
+        {
+            node_base *p = parent_of(c);
+            node_base *g = parent_of(p);
+            if (c == p->left)
+            {
+                p->left = c->right;
+                if (p->left)
+                    set_parent(p->left, p);
+                c->right = p;
+            }
+            else
+            {
+                p->right = c->left;
+                if (p->right)
+                    set_parent(p->right, p);
+                c->left = p;
+            }
+            set_parent(p, c);
+            set_parent(c, g);
+            replace_child(g, p, c);
+        }
+
+        // ===================== 插入与删除实现 / Insert & erase internals =====================
+
+        /**
+         * @brief 插入实现 / internal insert implementation
+         */
+        template <class U>
+        std::pair<iterator, bool> insert_impl(U &&value)
+        {
+            node_base *parent = &header_;
+            node_base *cur = root();
+            bool left_child = false;
+
+            while (cur)
+            {
+                parent = cur;
+                if (comp_(value, value_of(cur)))
+                {
+                    cur = cur->left;
+                    left_child = true;
+                }
+                else if (comp_(value_of(cur), value))
+                {
+                    cur = cur->right;
+                    left_child = false;
+                }
+                else
+                {
+                    return {iterator(cur), false};
+                }
+            }
+
+            node_base *n = create_node(std::forward<U>(value));
+            set_parent(n, parent);
+            ++size_;
+
+            if (parent == &header_)
+            {
+                set_root(n);
+                header_.left = n;
+                header_.right = n;
+                return {iterator(n), true};
+            }
+
+            if (left_child)
+            {
+                parent->left = n;
+                if (parent == header_.left)
+                    header_.left = n;
+            }
+            else
+            {
+                parent->right = n;
+                if (parent == header_.right)
+                    header_.right = n;
+            }
+
+            rebalance_insert(n);
+            return {iterator(n), true};
+        }
+
+        /**
+         * @brief 插入后修复 0-子节点：(0, 1) 提升后继续上行，(0, 2) 旋转后结束
+         *        repair a 0-child after insertion: a (0, 1) parent is promoted and the walk
+         *        continues, a (0, 2) parent is fixed by rotation and the walk stops
+         *
+         * @param x 秩可能与父节点相同的节点 / node whose rank may equal its parent's
+         */
+        void rebalance_insert(node_base *x) noexcept
+        {
+            for (node_base *p = parent_of(x); p != &header_ && p->rank == x->rank; p = parent_of(x))
+            {
+                bool left = x == p->left;
+                node_base *s = left ? p->right : p->left;
+                if (p->rank - rank_of(s) == 1)
+                {
+                    ++p->rank;
+                    x = p;
+                    continue;
+                }
+
+                node_base *y = left ? x->right : x->left;
+                if (x->rank - rank_of(y) == 2)
+                {
+                    // 内侧孙子是 2-子：单旋 / inner grandchild is a 2-child: single rotation
+                    rotate_up(x);
+                    --p->rank;
+                }
+                else
+                {
+                    // 内侧孙子是 1-子：双旋，y 升为子树根 / inner grandchild is a 1-child: double
+                    // rotation, y becomes the subtree root
+                    rotate_up(y);
+                    rotate_up(y);
+                    ++y->rank;
+                    --x->rank;
+                    --p->rank;
+                }
+                return;
+            }
+        }
+
+        /**
+         * @brief 删除后修复：(2, 2) 叶子降秩，3-子节点沿路降秩，至多一次（单或双）旋转后结束
+         *        repair after erasure: a (2, 2) leaf is demoted, 3-children are fixed by demotions
+         *        going up, and at most one (single or double) rotation ends the walk
+         *
+         * @param p         被删位置的父节点 / parent of the vacated position
+         * @param from_left 被删位置是否为左子 / whether the vacated position is a left child
+         */
+        void rebalance_erase(node_base *p, bool from_left) noexcept
+        {
+            node_base *x = from_left ? p->left : p->right;
+            if (!p->left && !p->right && p->rank == 1)
+            {
+                p->rank = 0;
+                x = p;
+                p = parent_of(p);
+                from_left = p != &header_ && p->left == x;
+            }
+
+            while (p != &header_ && p->rank - rank_of(x) == 3)
+            {
+                node_base *y = from_left ? p->right : p->left;
+                if (p->rank - y->rank == 2)
+                {
+                    --p->rank;
+                }
+                else if (y->rank - rank_of(y->left) == 2 && y->rank - rank_of(y->right) == 2)
+                {
+                    --y->rank;
+                    --p->rank;
+                }
+                else
+                {
+                    node_base *outer = from_left ? y->right : y->left;
+                    if (y->rank - rank_of(outer) == 1)
+                    {
+                        rotate_up(y);
+                        ++y->rank;
+                        --p->rank;
+                        // p 变成 (2, 2) 叶子时再降一次 / demote again if p became a (2, 2) leaf
+                        if (!p->left && !p->right)
+                            --p->rank;
+                    }
+                    else
+                    {
+                        node_base *v = from_left ? y->left : y->right;
+                        rotate_up(v);
+                        rotate_up(v);
+                        v->rank += 2;
+                        --y->rank;
+                        p->rank -= 2;
+                    }
+                    return;
+                }
+                x = p;
+                p = parent_of(p);
+                from_left = p != &header_ && p->left == x;
+            }
+        }
+
+        /**
+         * @brief 删除指定节点并保持 WAVL 秩规则 / erase node and keep the WAVL rank rule
+         */
+        void erase_node(node_base *z)
+        {
+            // 节点只重连不搬值，先用中序邻居更新 header 最左最右指针
+            // nodes are relinked, never moved: update the header extremes from the in-order
+            // neighbours first
+            if (header_.left == z)
+                header_.left = z->right ? min_node(z->right) : parent_of(z);
+            if (header_.right == z)
+                header_.right = z->left ? max_node(z->left) : parent_of(z);
+
+            node_base *retrace_at;
+            bool from_left;
+
+            if (z->left && z->right)
+            {
+                node_base *y = min_node(z->right);
+                node_base *x = y->right;
+                if (parent_of(y) == z)
+                {
+                    retrace_at = y;
+                    from_left = false;
+                }
+                else
+                {
+                    node_base *yp = parent_of(y);
+                    yp->left = x;
+                    if (x)
+                        set_parent(x, yp);
+                    y->right = z->right;
+                    set_parent(y->right, y);
+                    retrace_at = yp;
+                    from_left = true;
+                }
+                node_base *zp = parent_of(z);
+                replace_child(zp, z, y);
+                y->left = z->left;
+                set_parent(y->left, y);
+                // y 接替 z 的位置与秩 / y takes over z's position and rank
+                set_parent(y, zp);
+                y->rank = z->rank;
+            }
+            else
+            {
+                node_base *child = z->left ? z->left : z->right;
+                node_base *zp = parent_of(z);
+                from_left = zp != &header_ && zp->left == z;
+                replace_child(zp, z, child);
+                if (child)
+                    set_parent(child, zp);
+                retrace_at = zp;
+            }
+
+            destroy_node(z);
+            --size_;
+            if (size_ == 0)
+                reset_header();
+            else if (retrace_at != &header_)
+                rebalance_erase(retrace_at, from_left);
+        }
+    };
+
+} // namespace test_forest
+
+#endif
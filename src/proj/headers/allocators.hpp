@@ -0,0 +1,532 @@
+#ifndef _ALLOCATORS_HPP
+#define _ALLOCATORS_HPP
+
+/**
+ * @file allocators.hpp
+ * @brief 可插拔节点分配器：定长分级内存池、单调 arena、线程缓存池与计数分配器 / Pluggable node allocators: fixed-size-class pool, monotonic arena, thread-caching pool and counting allocator.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace test_forest
+{
+    namespace utils
+    {
+
+        // ==========================================
+        // 内存资源 / Memory resources
+        // ==========================================
+
+        /**
+         * @brief
+         *  定长分级空闲链表内存池：按 16 字节粒度把不超过 256 字节的请求归入尺寸级，
+         *  每级从 64 KiB 大块中切分，释放的块挂回该级空闲链表；更大的请求直接转给 operator new。
+         *  Fixed-size-class free-list pool: requests up to 256 bytes are rounded to 16-byte size
+         *  classes, each class carves slots out of 64 KiB chunks and freed slots go back onto the
+         *  class free list; larger requests go straight to operator new.
+         *
+         * @note
+         *  非线程安全；大块只在资源析构时归还系统。/ Not thread-safe; chunks return to the system only when the resource is destroyed.
+         */
+        class PoolResource
+        {
+        public:
+            /// @brief 尺寸级粒度（字节）/ size-class granularity in bytes.
+            static constexpr std::size_t granularity = 16;
+            /// @brief 走内存池的最大请求（字节）/ largest pooled request in bytes.
+            static constexpr std::size_t max_pooled = 256;
+            /// @brief 每个大块的字节数 / bytes per chunk.
+            static constexpr std::size_t chunk_bytes = 64 * 1024;
+
+            PoolResource() = default;
+            ~PoolResource();
+
+            PoolResource(const PoolResource &) = delete;
+            PoolResource &operator=(const PoolResource &) = delete;
+
+            /**
+             * @brief 分配 bytes 字节 / Allocate bytes bytes.
+             */
+            void *allocate(std::size_t bytes, std::size_t alignment);
+
+            /**
+             * @brief 归还 allocate 得到的内存 / Return memory obtained from allocate.
+             */
+            void deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept;
+
+            /**
+             * @brief 当前从系统持有的字节数 / Bytes currently held from the system.
+             */
+            std::size_t reserved_bytes() const noexcept { return reserved_; }
+
+        private:
+            /// @brief 空闲块链表结点 / free-slot list node.
+            struct FreeSlot
+            {
+                FreeSlot *next;
+            };
+
+            /// @brief 一个尺寸级 / one size class.
+            struct SizeClass
+            {
+                FreeSlot *free = nullptr;
+                char *cursor = nullptr;
+                char *limit = nullptr;
+            };
+
+            static bool pooled(std::size_t bytes, std::size_t alignment) noexcept
+            {
+                return bytes != 0 && bytes <= max_pooled && alignment <= granularity;
+            }
+
+            SizeClass classes_[max_pooled / granularity];
+            std::vector<void *> chunks_;
+            std::size_t reserved_ = 0;
+        };
+
+        /**
+         * @brief
+         *  单调 arena：在几何增长的大块上顺序切分，deallocate 不回收，资源析构时整体释放。
+         *  Monotonic arena: carves sequentially from geometrically growing chunks; deallocate
+         *  reclaims nothing and everything is released when the resource is destroyed.
+         *
+         * @note
+         *  非线程安全；适合「建好、用完、整体丢弃」的容器。/ Not thread-safe; suits containers that are built, used and dropped as a whole.
+         */
+        class ArenaResource
+        {
+        public:
+            /// @brief 首个大块的字节数 / bytes of the first chunk.
+            static constexpr std::size_t initial_chunk_bytes = 64 * 1024;
+            /// @brief 大块增长的上限 / upper bound of chunk growth.
+            static constexpr std::size_t max_chunk_bytes = 16 * 1024 * 1024;
+
+            ArenaResource() = default;
+            ~ArenaResource();
+
+            ArenaResource(const ArenaResource &) = delete;
+            ArenaResource &operator=(const ArenaResource &) = delete;
+
+            /**
+             * @brief 分配 bytes 字节 / Allocate bytes bytes.
+             */
+            void *allocate(std::size_t bytes, std::size_t alignment);
+
+            /**
+             * @brief 不做任何事：内存随 arena 一起释放 / Does nothing: memory goes away with the arena.
+             */
+            void deallocate(void *, std::size_t, std::size_t) noexcept {}
+
+            /**
+             * @brief 当前从系统持有的字节数 / Bytes currently held from the system.
+             */
+            std::size_t reserved_bytes() const noexcept { return reserved_; }
+
+        private:
+            char *cursor_ = nullptr;
+            char *limit_ = nullptr;
+            std::size_t next_chunk_ = initial_chunk_bytes;
+            std::vector<void *> chunks_;
+            std::size_t reserved_ = 0;
+        };
+
+        /**
+         * @brief
+         *  线程缓存内存池（进程级单例）：与 PoolResource 相同的尺寸级，每个线程持有各级的本地空闲链表，
+         *  无锁分配与释放；本地链表空了从共享池一次取 batch 个槽，超过 2·batch 个则一次还回 batch 个。
+         *  共享池每个尺寸级一把独立的、按缓存行对齐的锁。
+         *  Thread-caching pool (process-wide singleton): the same size classes as PoolResource,
+         *  but every thread keeps local free lists per class and allocates / frees without
+         *  locking; an empty local list takes batch slots from the shared pool at once, and a
+         *  list above 2·batch slots hands batch slots back at once. The shared pool has one
+         *  cache-line-aligned lock per size class.
+         *
+         * @note
+         *  线程安全；一个线程释放的槽可以由另一个线程分配的内存而来。线程退出时其缓存还回共享池；
+         *  共享池的大块在进程生命周期内不归还系统。
+         *  Thread-safe; a thread may free slots allocated by another thread. A thread's cache
+         *  goes back to the shared pool when it exits; the shared pool keeps its chunks for
+         *  the lifetime of the process.
+         */
+        class ThreadCacheResource
+        {
+        public:
+            /// @brief 尺寸级粒度（字节）/ size-class granularity in bytes.
+            static constexpr std::size_t granularity = 16;
+            /// @brief 走线程缓存的最大请求（字节）/ largest cached request in bytes.
+            static constexpr std::size_t max_cached = 256;
+            /// @brief 共享池每个大块的字节数 / bytes per shared-pool chunk.
+            static constexpr std::size_t chunk_bytes = 256 * 1024;
+            /// @brief 线程缓存与共享池之间一次搬运的槽数 / slots moved per refill or return.
+            static constexpr std::size_t batch = 64;
+
+            ThreadCacheResource() = delete;
+
+            /**
+             * @brief 分配 bytes 字节 / Allocate bytes bytes.
+             */
+            static void *allocate(std::size_t bytes, std::size_t alignment);
+
+            /**
+             * @brief 归还 allocate 得到的内存 / Return memory obtained from allocate.
+             */
+            static void deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept;
+
+            /**
+             * @brief 共享池从系统持有的字节数 / Bytes the shared pool holds from the system.
+             */
+            static std::size_t reserved_bytes() noexcept;
+
+            /**
+             * @brief 把当前线程缓存的槽全部还回共享池 / Hand every slot cached by the calling thread back to the shared pool.
+             */
+            static void flush_thread_cache() noexcept;
+
+        private:
+            static bool cached(std::size_t bytes, std::size_t alignment) noexcept
+            {
+                return bytes != 0 && bytes <= max_cached && alignment <= granularity;
+            }
+        };
+
+        // ==========================================
+        // 分配器 / Allocators
+        // ==========================================
+
+        /**
+         * @brief
+         *  把内存资源包装成标准分配器，可作为 BinaryTree / avl_tree / RedBlackTree 等的 Allocator 参数；
+         *  rebind 后与原分配器共享同一资源。
+         *  Wraps a memory resource as a standard allocator usable as the Allocator argument of
+         *  BinaryTree / avl_tree / RedBlackTree and friends; rebound copies share the resource.
+         *
+         * @tparam T
+         *  元素类型 / value type.
+         * @tparam Resource
+         *  内存资源类型 / memory resource type.
+         *
+         * @note
+         *  默认构造会新建一个资源，因此每个默认构造的容器独占自己的池；经
+         *  select_on_container_copy_construction 拷贝的容器也为副本新建资源。
+         *  Default construction creates a new resource, so every default-constructed container
+         *  owns its pool; a container copied through select_on_container_copy_construction
+         *  gives the copy a fresh resource too.
+         */
+        template <typename T, typename Resource>
+        class ResourceAllocator
+        {
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = std::false_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+            using is_always_equal = std::false_type;
+
+            /**
+             * @brief 新建一个资源 / Create a new resource.
+             */
+            ResourceAllocator()
+                : resource_(std::make_shared<Resource>())
+            {
+            }
+
+            /**
+             * @brief 拷贝（移动同样是拷贝：被移动的分配器保持不变）
+             *        / Copy (moving copies too: a moved-from allocator stays unchanged).
+             */
+            ResourceAllocator(const ResourceAllocator &) noexcept = default;
+            ResourceAllocator &operator=(const ResourceAllocator &) noexcept = default;
+
+            /**
+             * @brief rebind 构造：共享资源 / Rebinding constructor: shares the resource.
+             */
+            template <typename U>
+            ResourceAllocator(const ResourceAllocator<U, Resource> &other) noexcept
+                : resource_(other.resource_)
+            {
+            }
+
+            T *allocate(std::size_t n)
+            {
+                if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                    throw std::bad_array_new_length();
+                return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *p, std::size_t n) noexcept
+            {
+                resource_->deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            /**
+             * @brief 容器拷贝时为副本新建资源 / A container copy gets a fresh resource.
+             */
+            ResourceAllocator select_on_container_copy_construction() const
+            {
+                return ResourceAllocator();
+            }
+
+            /**
+             * @brief 底层资源 / Underlying resource.
+             */
+            Resource &resource() const noexcept { return *resource_; }
+
+            template <typename U>
+            friend bool operator==(const ResourceAllocator &a, const ResourceAllocator<U, Resource> &b) noexcept
+            {
+                return a.resource_ == b.resource_;
+            }
+
+            template <typename U>
+            friend bool operator!=(const ResourceAllocator &a, const ResourceAllocator<U, Resource> &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            template <typename, typename>
+            friend class ResourceAllocator;
+
+            std::shared_ptr<Resource> resource_;
+        };
+
+        /// @brief 定长分级内存池分配器 / Fixed-size-class pool allocator.
+        template <typename T>
+        using PoolAllocator = ResourceAllocator<T, PoolResource>;
+
+        /// @brief 单调 arena 分配器 / Monotonic arena allocator.
+        template <typename T>
+        using ArenaAllocator = ResourceAllocator<T, ArenaResource>;
+
+        /**
+         * @brief
+         *  ThreadCacheResource 上的无状态分配器：所有实例相等，容器可以在线程间移动、交换。
+         *  Stateless allocator over ThreadCacheResource: all instances compare equal, so
+         *  containers may be moved and swapped across threads.
+         */
+        template <typename T>
+        class ThreadCachingAllocator
+        {
+        public:
+            using value_type = T;
+            using is_always_equal = std::true_type;
+
+            ThreadCachingAllocator() noexcept = default;
+
+            template <typename U>
+            ThreadCachingAllocator(const ThreadCachingAllocator<U> &) noexcept
+            {
+            }
+
+            T *allocate(std::size_t n)
+            {
+                if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                    throw std::bad_array_new_length();
+                return static_cast<T *>(ThreadCacheResource::allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *p, std::size_t n) noexcept
+            {
+                ThreadCacheResource::deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            template <typename U>
+            friend bool operator==(const ThreadCachingAllocator &, const ThreadCachingAllocator<U> &) noexcept
+            {
+                return true;
+            }
+
+            template <typename U>
+            friend bool operator!=(const ThreadCachingAllocator &, const ThreadCachingAllocator<U> &) noexcept
+            {
+                return false;
+            }
+        };
+
+        // ==========================================
+        // 内存计量 / Memory accounting
+        // ==========================================
+
+        /**
+         * @brief
+         *  分配计数器：记录当前字节数、峰值字节数与分配次数，峰值与次数可按阶段清零。
+         *  Allocation counter: tracks live bytes, peak bytes and allocation count; the peak
+         *  and the count can be reset per phase.
+         *
+         * @note
+         *  非线程安全，与它计量的容器一样由单线程使用。/ Not thread-safe; used by one thread, like the container it measures.
+         */
+        class AllocationCounter
+        {
+        public:
+            void on_allocate(std::size_t bytes) noexcept
+            {
+                live_ += bytes;
+                ++allocations_;
+                if (live_ > peak_)
+                    peak_ = live_;
+            }
+
+            void on_deallocate(std::size_t bytes) noexcept
+            {
+                live_ -= bytes;
+            }
+
+            /// @brief 当前字节数 / live bytes.
+            std::uint64_t live_bytes() const noexcept { return live_; }
+            /// @brief 自上次 reset_phase 以来的峰值字节数 / peak bytes since the last reset_phase.
+            std::uint64_t peak_bytes() const noexcept { return peak_; }
+            /// @brief 自上次 reset_phase 以来的分配次数 / allocations since the last reset_phase.
+            std::uint64_t allocations() const noexcept { return allocations_; }
+
+            /**
+             * @brief 开始新阶段：峰值回落到当前值，分配次数清零 / Start a new phase: the peak drops to the live value and the count restarts.
+             */
+            void reset_phase() noexcept
+            {
+                peak_ = live_;
+                allocations_ = 0;
+            }
+
+            /**
+             * @brief 本阶段的内存占用，bytes_per_key 按 keys 个键折算 / Memory usage of this phase, bytes_per_key over keys keys.
+             */
+            MemoryUsage usage(std::size_t keys) const noexcept
+            {
+                MemoryUsage m;
+                m.live_bytes = live_;
+                m.peak_bytes = peak_;
+                m.alloc_count = allocations_;
+                m.bytes_per_key = keys ? static_cast<double>(peak_) / static_cast<double>(keys) : 0.0;
+                return m;
+            }
+
+        private:
+            std::uint64_t live_ = 0;
+            std::uint64_t peak_ = 0;
+            std::uint64_t allocations_ = 0;
+        };
+
+        /**
+         * @brief
+         *  计数分配器：把请求转给 Base，同时记入共享的 AllocationCounter；rebind 后共享同一计数器，
+         *  所以容器的节点、哨兵与辅助缓冲都算在一起。
+         *  Counting allocator: forwards to Base and records every request in a shared
+         *  AllocationCounter; rebound copies share the counter, so a container's nodes,
+         *  sentinels and scratch buffers are all counted together.
+         *
+         * @tparam T
+         *  元素类型 / value type.
+         * @tparam Base
+         *  实际分配内存的分配器（缺省 std::allocator<T>，也可以是 PoolAllocator 等）
+         *  / allocator that does the real work (default std::allocator<T>; PoolAllocator and friends also work).
+         */
+        template <typename T, typename Base = std::allocator<T>>
+        class CountingAllocator
+        {
+        public:
+            using value_type = T;
+            using base_type = Base;
+            using propagate_on_container_copy_assignment = std::false_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+            using is_always_equal = std::false_type;
+
+            template <typename U>
+            struct rebind
+            {
+                using other = CountingAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+            };
+
+            /**
+             * @brief 新建一个计数器 / Create a new counter.
+             */
+            CountingAllocator()
+                : counter_(std::make_shared<AllocationCounter>()), base_()
+            {
+            }
+
+            CountingAllocator(const CountingAllocator &) = default;
+            CountingAllocator &operator=(const CountingAllocator &) = default;
+
+            /**
+             * @brief rebind 构造：共享计数器 / Rebinding constructor: shares the counter.
+             */
+            template <typename U, typename B>
+            CountingAllocator(const CountingAllocator<U, B> &other)
+                : counter_(other.counter_), base_(other.base_)
+            {
+            }
+
+            T *allocate(std::size_t n)
+            {
+                T *p = std::allocator_traits<Base>::allocate(base_, n);
+                counter_->on_allocate(n * sizeof(T));
+                return p;
+            }
+
+            void deallocate(T *p, std::size_t n) noexcept
+            {
+                counter_->on_deallocate(n * sizeof(T));
+                std::allocator_traits<Base>::deallocate(base_, p, n);
+            }
+
+            /**
+             * @brief 容器拷贝时为副本新建计数器 / A container copy gets a fresh counter.
+             */
+            CountingAllocator select_on_container_copy_construction() const
+            {
+                CountingAllocator copy(*this);
+                copy.counter_ = std::make_shared<AllocationCounter>();
+                copy.base_ = std::allocator_traits<Base>::select_on_container_copy_construction(base_);
+                return copy;
+            }
+
+            /**
+             * @brief 共享的计数器 / Shared counter.
+             */
+            AllocationCounter &counter() const noexcept { return *counter_; }
+
+            template <typename U, typename B>
+            friend bool operator==(const CountingAllocator &a, const CountingAllocator<U, B> &b) noexcept
+            {
+                return a.counter_ == b.counter_ && a.base_ == b.base_;
+            }
+
+            template <typename U, typename B>
+            friend bool operator!=(const CountingAllocator &a, const CountingAllocator<U, B> &b) noexcept
+            {
+                return !(a == b);
+            }
+
+        private:
+            template <typename, typename>
+            friend class CountingAllocator;
+
+            std::shared_ptr<AllocationCounter> counter_;
+            Base base_;
+        };
+
+        /// @brief 是否为 CountingAllocator / Whether an allocator is a CountingAllocator.
+        template <typename Alloc>
+        struct is_counting_allocator : std::false_type
+        {
+        };
+
+        template <typename T, typename Base>
+        struct is_counting_allocator<CountingAllocator<T, Base>> : std::true_type
+        {
+        };
+
+    } // namespace utils
+} // namespace test_forest
+
+#endif // _ALLOCATORS_HPP
@@ -217,10 +217,29 @@ namespace test_forest
         // CSV 日志器 / CSV logger
         // ============================
 
+        /**
+         * @brief
+         *  一个测试阶段的内存占用，写在 CSV 的 time_usage 之后。/ Memory usage of one benchmark phase, written after time_usage in the CSV.
+         */
+        struct MemoryUsage
+        {
+            /// @brief 阶段结束时仍在使用的字节数 / bytes still in use when the phase ends.
+            std::uint64_t live_bytes = 0;
+            /// @brief 阶段内的峰值字节数 / peak bytes in use during the phase.
+            std::uint64_t peak_bytes = 0;
+            /// @brief 阶段内的分配次数 / number of allocations during the phase.
+            std::uint64_t alloc_count = 0;
+            /// @brief 峰值字节数 / 键数 / peak bytes divided by the number of keys.
+            double bytes_per_key = 0.0;
+        };
+
         /**
          * @brief
          *  并发安全的 CSV 日志器。将测试结果以表头
-         *  "test_func_name,count,time_usage" 写入文件。/ Thread-safe CSV logger writing results with header "test_func_name,count,time_usage".
+         *  "test_func_name,count,time_usage,live_bytes,peak_bytes,alloc_count,bytes_per_key" 写入文件，
+         *  未测内存的行后四列留空。/ Thread-safe CSV logger writing results with header
+         *  "test_func_name,count,time_usage,live_bytes,peak_bytes,alloc_count,bytes_per_key";
+         *  rows without memory figures leave the last four columns empty.
          *
          * @note
          *  复制 CsvLogger 只是共享同一个实现（内部 shared_ptr），适合在线程之间传递。/
@@ -287,7 +306,7 @@ namespace test_forest
 
             /**
              * @brief
-             *  追加一行测试结果到 CSV：`test_func_name,count,time_usage`。/ Append one result row to CSV: `test_func_name,count,time_usage`.
+             *  追加一行测试结果到 CSV：`test_func_name,count,time_usage`，内存列留空。/ Append one result row to CSV: `test_func_name,count,time_usage`, memory columns left empty.
              *
              * @param test_func_name
              *  测试函数或场景名称。/ Name of the test function or scenario.
@@ -300,6 +319,24 @@ namespace test_forest
                         std::uint64_t count,
                         double time_usage_seconds);
 
+            /**
+             * @brief
+             *  追加一行带内存占用的测试结果。/ Append one result row together with its memory usage.
+             *
+             * @param test_func_name
+             *  测试函数或场景名称。/ Name of the test function or scenario.
+             * @param count
+             *  操作次数。/ Number of operations or iterations.
+             * @param time_usage_seconds
+             *  总耗时（秒）。/ Total time usage in seconds.
+             * @param memory
+             *  该阶段的内存占用。/ Memory usage of the phase.
+             */
+            void append(const std::string &test_func_name,
+                        std::uint64_t count,
+                        double time_usage_seconds,
+                        const MemoryUsage &memory);
+
             /**
              * @brief
              *  刷新底层输出缓冲区。/ Flush underlying output buffer.
@@ -8,19 +8,34 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <deque>
 #include <exception>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <shared_mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #include "utils.hpp"
+#include "allocators.hpp"
 #include "Binary-Tree.hpp"
+#include "Threaded-Binary-Tree.hpp"
+#include "Compact-Binary-Tree.hpp"
 #include "AVL-Tree.hpp"
+#include "Packed-AVL-Tree.hpp"
+#include "Concurrent-AVL-Tree.hpp"
+#include "WAVL-Tree.hpp"
 #include "Red-Black-Tree.hpp"
+#include "RCU-Red-Black-Tree.hpp"
+#include "Persistent-Red-Black-Tree.hpp"
+#include "Interval-Tree.hpp"
+#include "Filtered-Set.hpp"
+#include "Sharded-Set.hpp"
 #include "B-Tree.hpp"
 
 /// @brief 项目主命名空间 / Main project namespace.
@@ -29,10 +44,129 @@ namespace test_forest
 
     // 为了少打一点字，给几个类型起别名 / Short aliases for containers we benchmark.
     using BinaryTreeInt = BinaryTree<int>;
+    using ScapegoatTreeInt = BinaryTree<int, std::less<int>, std::allocator<int>, scapegoat_policy<>>;
+    using ThreadedBinaryTreeInt = ThreadedBinaryTree<int>;
+    using CompactBinaryTreeInt = CompactBinaryTree<int>;
     using AvlTreeInt = avl_tree<int>;
+    using PackedAvlTreeInt = packed_avl_tree<int>;
+    using OrderStatAvlTreeInt = avl_tree<int, std::less<int>, std::allocator<int>, true>;
+    using ConcurrentAvlTreeInt = concurrent_avl_tree<int>;
+    using WavlTreeInt = wavl_tree<int>;
     using RedBlackTreeInt = RedBlackTree<int>;
+    using PackedRedBlackTreeInt = RedBlackTree<int, std::less<int>, std::allocator<int>, true>;
+    using SumRedBlackTreeInt = RedBlackTree<int, std::less<int>, std::allocator<int>, false, rb_sum_monoid<>>;
+    using RcuRedBlackTreeInt = rcu_red_black_tree<int>;
+    using PersistentRedBlackTreeInt = persistent_red_black_tree<int>;
     using BTreeInt = BTreeSet<int, 32>;
 
+    // 分配器维度：同一棵树分别配内存池与 arena / Allocator dimension: the same trees on a pool and on an arena.
+    using PoolBinaryTreeInt = BinaryTree<int, std::less<int>, utils::PoolAllocator<int>>;
+    using ArenaBinaryTreeInt = BinaryTree<int, std::less<int>, utils::ArenaAllocator<int>>;
+    using PoolAvlTreeInt = avl_tree<int, std::less<int>, utils::PoolAllocator<int>>;
+    using ArenaAvlTreeInt = avl_tree<int, std::less<int>, utils::ArenaAllocator<int>>;
+    using PoolRedBlackTreeInt = RedBlackTree<int, std::less<int>, utils::PoolAllocator<int>>;
+    using ArenaRedBlackTreeInt = RedBlackTree<int, std::less<int>, utils::ArenaAllocator<int>>;
+    using CachedAvlTreeInt = avl_tree<int, std::less<int>, utils::ThreadCachingAllocator<int>>;
+    using CachedRedBlackTreeInt = RedBlackTree<int, std::less<int>, utils::ThreadCachingAllocator<int>>;
+
+    // 内存计量：计数分配器包在 std::allocator 外面 / Memory accounting: a counting allocator over std::allocator.
+    using CountingBinaryTreeInt = BinaryTree<int, std::less<int>, utils::CountingAllocator<int>>;
+    using CountingAvlTreeInt = avl_tree<int, std::less<int>, utils::CountingAllocator<int>>;
+    using CountingRedBlackTreeInt = RedBlackTree<int, std::less<int>, utils::CountingAllocator<int>>;
+    using CountingPersistentRedBlackTreeInt = persistent_red_black_tree<int, std::less<int>, utils::CountingAllocator<int>>;
+
+    /**
+     * @brief
+     *  开启自动 DSW 重平衡（阈值 2·log2 N）的 BinaryTree，用于升序批量加载场景。
+     *  BinaryTree with automatic DSW rebalancing (threshold 2·log2 N) for sorted bulk loads.
+     */
+    struct AutoRebalanceTreeInt : BinaryTreeInt
+    {
+        AutoRebalanceTreeInt() { set_auto_rebalance(2.0); }
+    };
+
+    /**
+     * @brief
+     *  用一把互斥锁保护的 avl_tree，作为并发基准的对照。
+     *  avl_tree guarded by a single mutex, the baseline of the concurrent benchmark.
+     */
+    class MutexAvlTreeInt
+    {
+    public:
+        bool insert(int key)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return tree_.insert(key).second;
+        }
+
+        std::size_t erase(int key)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return tree_.erase(key);
+        }
+
+        bool contains(int key) const
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return tree_.find(key) != tree_.end();
+        }
+
+    private:
+        mutable std::mutex lock_;
+        AvlTreeInt tree_;
+    };
+
+    /**
+     * @brief
+     *  用读写锁保护的 RedBlackTree，作为 RCU 读者基准的对照。
+     *  RedBlackTree guarded by a reader-writer lock, the baseline of the RCU reader benchmark.
+     */
+    class RwLockRedBlackTreeInt
+    {
+    public:
+        bool insert(int key)
+        {
+            std::unique_lock<std::shared_mutex> guard(lock_);
+            return tree_.insert(key).second;
+        }
+
+        std::size_t erase(int key)
+        {
+            std::unique_lock<std::shared_mutex> guard(lock_);
+            return tree_.erase(key);
+        }
+
+        bool contains(int key) const
+        {
+            std::shared_lock<std::shared_mutex> guard(lock_);
+            return tree_.find(key) != tree_.end();
+        }
+
+    private:
+        mutable std::shared_mutex lock_;
+        RedBlackTreeInt tree_;
+    };
+
+    /**
+     * @brief
+     *  把并发基准的 key 区间 [0, 2^20) 均分成 64 段的区间分片。
+     *  Range partition splitting the concurrent benchmark's key range [0, 2^20) into 64
+     *  equal slices.
+     */
+    struct BenchmarkRangePartition : range_partition<int>
+    {
+        BenchmarkRangePartition()
+        {
+            for (int s = 1; s < 64; ++s)
+                bounds.push_back(s * ((1 << 20) / 64));
+        }
+    };
+
+    using ShardedAvlTreeInt = ShardedSet<AvlTreeInt, 64>;
+    using ShardedRedBlackTreeInt = ShardedSet<RedBlackTreeInt, 64>;
+    using ShardedBTreeInt = ShardedSet<BTreeInt, 64>;
+    using RangeShardedAvlTreeInt = ShardedSet<AvlTreeInt, 64, BenchmarkRangePartition>;
+
     /**
      * @brief
      *  检测容器是否提供 contains(key) 成员函数的辅助模板。
@@ -104,6 +238,28 @@ namespace test_forest
         return data;
     }
 
+    /**
+     * @brief
+     *  生成升序的 0..n-1，模拟单调递增 ID 的插入顺序。
+     *  Generate ascending integers 0..n-1, modelling monotonically increasing IDs.
+     *
+     * @param n
+     *  元素个数 / number of elements.
+     *
+     * @return
+     *  升序整数序列 / ascending sequence of integers.
+     */
+    std::vector<int> make_sorted_sequence(std::size_t n)
+    {
+        std::vector<int> data;
+        data.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            data.push_back(static_cast<int>(i));
+        }
+        return data;
+    }
+
     /**
      * @brief
      *  生成不存在于 [0, n-1] 中的“缺失 key”序列，例如 [n, 2n)。
@@ -126,6 +282,88 @@ namespace test_forest
         return data;
     }
 
+    /**
+     * @brief
+     *  单个测试阶段的内存探针；缺省不测内存，CSV 的内存列留空。
+     *  Per-phase memory probe; by default memory is not measured and the CSV memory
+     *  columns stay empty.
+     */
+    template <class Set, class = void>
+    struct phase_memory
+    {
+        static constexpr bool enabled = false;
+
+        void begin(const Set &) noexcept {}
+        utils::MemoryUsage end(const Set &, std::size_t) const noexcept { return {}; }
+    };
+
+    /**
+     * @brief 使用 CountingAllocator 的容器：直接读计数器 / Containers on a CountingAllocator: read the counter.
+     */
+    template <class Set>
+    struct phase_memory<Set, std::enable_if_t<utils::is_counting_allocator<typename Set::allocator_type>::value>>
+    {
+        static constexpr bool enabled = true;
+
+        void begin(const Set &set) noexcept { set.get_allocator().counter().reset_phase(); }
+
+        utils::MemoryUsage end(const Set &set, std::size_t keys) const noexcept
+        {
+            return set.get_allocator().counter().usage(keys);
+        }
+    };
+
+    /**
+     * @brief
+     *  BTreeSet 没有分配器参数，按节点数折算；插入阶段只分配、删除阶段只释放，
+     *  所以阶段两端的节点数就给出了峰值与分配次数。
+     *  BTreeSet takes no allocator, so usage is derived from node counts; insertion only
+     *  allocates and erasure only frees, so the node counts at both ends of a phase give
+     *  the peak and the allocation count.
+     */
+    template <typename Key, std::size_t Order, typename Compare>
+    struct phase_memory<BTreeSet<Key, Order, Compare>, void>
+    {
+        using Set = BTreeSet<Key, Order, Compare>;
+
+        static constexpr bool enabled = true;
+
+        std::size_t start_nodes = 0;
+
+        void begin(const Set &set) noexcept { start_nodes = set.node_count(); }
+
+        utils::MemoryUsage end(const Set &set, std::size_t keys) const noexcept
+        {
+            std::size_t nodes = set.node_count();
+            utils::MemoryUsage m;
+            m.live_bytes = nodes * Set::node_size();
+            m.peak_bytes = std::max(nodes, start_nodes) * Set::node_size();
+            m.alloc_count = nodes > start_nodes ? nodes - start_nodes : 0;
+            m.bytes_per_key = keys ? static_cast<double>(m.peak_bytes) / static_cast<double>(keys) : 0.0;
+            return m;
+        }
+    };
+
+    /**
+     * @brief
+     *  写一行 CSV；容器可测内存时附带该阶段的内存列。
+     *  Append one CSV row, with the phase's memory columns when the container supports it.
+     */
+    template <class Set>
+    void append_phase(utils::CsvLogger &logger,
+                      const std::string &name,
+                      std::uint64_t count,
+                      double seconds,
+                      const phase_memory<Set> &memory,
+                      const Set &set,
+                      std::size_t keys)
+    {
+        if constexpr (phase_memory<Set>::enabled)
+            logger.append(name, count, seconds, memory.end(set, keys));
+        else
+            logger.append(name, count, seconds);
+    }
+
     /**
      * @brief
      *  对一个 set-like 容器在多个 N 上进行基准测试，并将结果写入 CsvLogger。
@@ -160,9 +398,11 @@ namespace test_forest
             auto miss_keys = make_missing_keys(n);
 
             Set set;
+            phase_memory<Set> memory;
 
             // 2) 插入测试 / insertion benchmark
             {
+                memory.begin(set);
                 auto start = clock::now();
                 for (int key : insert_keys)
                 {
@@ -175,13 +415,12 @@ namespace test_forest
 
                 std::string name =
                     set_name + ".insert.N=" + std::to_string(n);
-                logger.append(name,
-                              static_cast<std::uint64_t>(n),
-                              seconds);
+                append_phase(logger, name, static_cast<std::uint64_t>(n), seconds, memory, set, n);
             }
 
             // 3) 命中查找 / successful lookups (search_hit)
             {
+                memory.begin(set);
                 auto start = clock::now();
                 std::uint64_t count = 0;
                 for (int key : insert_keys)
@@ -196,11 +435,12 @@ namespace test_forest
 
                 std::string name =
                     set_name + ".search_hit.N=" + std::to_string(n);
-                logger.append(name, count, seconds);
+                append_phase(logger, name, count, seconds, memory, set, n);
             }
 
             // 4) 失败查找 / unsuccessful lookups (search_miss)
             {
+                memory.begin(set);
                 auto start = clock::now();
                 std::uint64_t count = 0;
                 for (int key : miss_keys)
@@ -215,11 +455,12 @@ namespace test_forest
 
                 std::string name =
                     set_name + ".search_miss.N=" + std::to_string(n);
-                logger.append(name, count, seconds);
+                append_phase(logger, name, count, seconds, memory, set, n);
             }
 
             // 5) 删除测试 / erase benchmark
             {
+                memory.begin(set);
                 auto start = clock::now();
                 std::uint64_t count = 0;
                 for (int key : insert_keys)
@@ -234,103 +475,1220 @@ namespace test_forest
 
                 std::string name =
                     set_name + ".erase.N=" + std::to_string(n);
-                logger.append(name, count, seconds);
+                append_phase(logger, name, count, seconds, memory, set, n);
             }
         }
     }
 
     /**
      * @brief
-     *  并行执行多个 benchmark 任务的小型线程池实现。
-     *  A tiny thread-pool style runner to execute multiple benchmark tasks in parallel.
+     *  升序插入场景：测量按递增顺序插入以及随后命中查找的耗时，暴露退化成链表的树形。
+     *  Sorted-insertion scenario: time ascending insertion and the subsequent hit lookups,
+     *  exposing trees that degenerate into linked lists.
      *
-     * @param tasks
-     *  任务列表，每个任务是 `void()` 可调用对象。
-     *  List of tasks, each is a `void()` callable.
+     * @tparam Set
+     *  容器类型 / container type.
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
      */
-    void run_tasks_parallel(const std::vector<std::function<void()>> &tasks)
+    template <class Set>
+    void run_sorted_benchmark_for_set(const std::string &set_name,
+                                      utils::CsvLogger &logger,
+                                      const std::vector<std::size_t> &sizes)
     {
-        if (tasks.empty())
-        {
-            return;
-        }
-
-        std::atomic<std::size_t> next_index{0};
+        using clock = std::chrono::steady_clock;
 
-        const std::size_t task_count = tasks.size();
-        std::size_t thread_count = std::thread::hardware_concurrency();
-        if (thread_count == 0)
-        {
-            thread_count = 2;
-        }
-        if (thread_count > task_count)
+        for (std::size_t n : sizes)
         {
-            thread_count = task_count;
-        }
+            auto keys = make_sorted_sequence(n);
+            Set set;
 
-        auto worker = [&]()
-        {
-            while (true)
             {
-                std::size_t i = next_index.fetch_add(1, std::memory_order_relaxed);
-                if (i >= task_count)
+                auto start = clock::now();
+                for (int key : keys)
                 {
-                    break;
+                    (void)set.insert(key);
                 }
+                auto end = clock::now();
+                double seconds =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                        .count();
+                logger.append(set_name + ".insert_sorted.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n),
+                              seconds);
+            }
 
-                try
+            {
+                auto start = clock::now();
+                std::uint64_t count = 0;
+                for (int key : keys)
                 {
-                    tasks[i]();
+                    (void)tree_contains(set, key);
+                    ++count;
                 }
-                catch (const std::exception &ex)
+                auto end = clock::now();
+                double seconds =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                        .count();
+                logger.append(set_name + ".search_sorted.N=" + std::to_string(n),
+                              count,
+                              seconds);
+            }
+        }
+    }
+
+    /**
+     * @brief
+     *  近似有序（事件时间）摄入场景：每 8 个 key 局部打乱的升序流，分别用普通 insert 与
+     *  以 end() 为提示的 insert 插入。
+     *  Nearly sorted (event-time) ingestion scenario: an ascending stream shuffled within
+     *  blocks of 8, inserted once with plain insert and once with insert hinted at end().
+     *
+     * @tparam Set
+     *  容器类型（需提供 insert(hint, value)）/ container type (must provide insert(hint, value)).
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    template <class Set>
+    void run_hinted_benchmark_for_set(const std::string &set_name,
+                                      utils::CsvLogger &logger,
+                                      const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::mt19937 rng(42);
+
+        for (std::size_t n : sizes)
+        {
+            auto keys = make_sorted_sequence(n);
+            for (std::size_t i = 0; i + 8 <= n; i += 8)
+            {
+                std::shuffle(keys.begin() + static_cast<std::ptrdiff_t>(i),
+                             keys.begin() + static_cast<std::ptrdiff_t>(i + 8), rng);
+            }
+
+            {
+                Set set;
+                auto start = clock::now();
+                for (int key : keys)
                 {
-                    utils::log_error(std::string("Benchmark task threw exception: ") +
-                                     ex.what());
+                    (void)set.insert(key);
                 }
-                catch (...)
+                auto end = clock::now();
+                logger.append(set_name + ".insert_near_sorted.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n),
+                              std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+            }
+
+            {
+                Set set;
+                auto start = clock::now();
+                for (int key : keys)
                 {
-                    utils::log_error("Benchmark task threw unknown exception.");
+                    (void)set.insert(set.end(), key);
                 }
+                auto end = clock::now();
+                logger.append(set_name + ".insert_hint_end.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n),
+                              std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
             }
-        };
-
-        std::vector<std::thread> threads;
-        threads.reserve(thread_count);
-        for (std::size_t i = 0; i < thread_count; ++i)
-        {
-            threads.emplace_back(worker);
         }
-        for (auto &t : threads)
+    }
+
+    /**
+     * @brief
+     *  批量加载场景：用升序区间一次性构造容器，再对全部 key 做命中查找。
+     *  Bulk-load scenario: construct the container from an ascending range in one go, then
+     *  look up every key.
+     *
+     * @tparam Set
+     *  容器类型（需提供区间构造函数）/ container type (must provide a range constructor).
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    template <class Set>
+    void run_bulk_load_benchmark_for_set(const std::string &set_name,
+                                         utils::CsvLogger &logger,
+                                         const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+
+        for (std::size_t n : sizes)
         {
-            t.join();
+            auto keys = make_sorted_sequence(n);
+
+            auto start = clock::now();
+            Set set(keys.begin(), keys.end());
+            auto end = clock::now();
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".bulk_load.N=" + std::to_string(n),
+                          static_cast<std::uint64_t>(n),
+                          seconds);
+
+            start = clock::now();
+            std::uint64_t count = 0;
+            for (int key : keys)
+            {
+                (void)tree_contains(set, key);
+                ++count;
+            }
+            end = clock::now();
+            seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".search_bulk.N=" + std::to_string(n), count, seconds);
         }
     }
 
     /**
      * @brief
-     *  组合四种树容器的所有基准任务并并行执行。
-     *  Construct and execute all benchmark tasks for four tree containers in parallel.
+     *  全量中序扫描场景：随机顺序建树后，测量一次从 begin() 到 end() 的完整遍历。
+     *  Full in-order scan scenario: build from shuffled keys, then time one complete
+     *  traversal from begin() to end().
+     *
+     * @tparam Set
+     *  容器类型（需提供迭代器）/ container type (must provide iterators).
      *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
      * @param logger
      *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
      */
-    void run_all_benchmarks(utils::CsvLogger &logger)
+    template <class Set>
+    void run_scan_benchmark_for_set(const std::string &set_name,
+                                    utils::CsvLogger &logger,
+                                    const std::vector<std::size_t> &sizes)
     {
-        // 这里可以根据需要调整 N 的规模 / Adjust N values as needed.
-        std::vector<std::size_t> sizes;
-        sizes.reserve(100000 / 10 + 5);
-        for (std::size_t i = 10; i < 100000; i += 10)
-            sizes.push_back(i);
+        using clock = std::chrono::steady_clock;
 
-        std::vector<std::function<void()>> tasks;
-        tasks.reserve(4);
+        std::mt19937 rng(42);
 
-        // 为每一种容器添加一个任务 / One task per container.
-        tasks.emplace_back([&logger, &sizes]()
-                           {
-            utils::log_info("Running BinaryTree benchmarks...");
-            run_benchmark_for_set<BinaryTreeInt>("BinaryTree", logger, sizes);
-            utils::log_info("BinaryTree benchmarks finished."); });
+        for (std::size_t n : sizes)
+        {
+            Set set;
+            for (int key : make_shuffled_sequence(n, rng))
+            {
+                (void)set.insert(key);
+            }
+
+            // 累加到 volatile 变量，防止遍历被优化掉
+            // Accumulate into a volatile sink so the traversal is not optimized away.
+            volatile long long sink = 0;
+            auto start = clock::now();
+            long long sum = 0;
+            std::uint64_t count = 0;
+            for (auto it = set.begin(); it != set.end(); ++it)
+            {
+                sum += *it;
+                ++count;
+            }
+            sink = sum;
+            auto end = clock::now();
+            (void)sink;
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".full_scan.N=" + std::to_string(n), count, seconds);
+        }
+    }
+
+    /**
+     * @brief
+     *  对比指针结点 BinaryTree 与下标结点 CompactBinaryTree 的每键内存：两者都走 CountingAllocator，
+     *  随机插入 N 个 key 后写一行 "<Tree>@counting.build_memory.N=..."，内存列给出分配器实测的字节数
+     *  （CompactBinaryTree 含结点池的空闲容量与扩容时的峰值）。
+     *  Compare memory per key of the pointer-linked BinaryTree and the index-linked
+     *  CompactBinaryTree: both run on a CountingAllocator, and after N random inserts one row
+     *  "<Tree>@counting.build_memory.N=..." carries the bytes measured at the allocator
+     *  (for CompactBinaryTree including spare pool capacity and the peak while it grows).
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测量的 N 列表 / list of input sizes N.
+     */
+    void report_binary_tree_memory(utils::CsvLogger &logger, const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+        using CountingCompactBinaryTreeInt = CompactBinaryTree<int, std::less<int>, utils::CountingAllocator<int>>;
+
+        auto build = [&logger](const std::string &set_name, auto &tree, const std::vector<int> &keys)
+        {
+            utils::AllocationCounter &counter = tree.get_allocator().counter();
+            counter.reset_phase();
+            auto start = clock::now();
+            for (int key : keys)
+            {
+                (void)tree.insert(key);
+            }
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start)
+                    .count();
+            logger.append(set_name + "@counting.build_memory.N=" + std::to_string(keys.size()),
+                          static_cast<std::uint64_t>(keys.size()), seconds, counter.usage(keys.size()));
+        };
+
+        std::mt19937 rng(42);
+        for (std::size_t n : sizes)
+        {
+            std::vector<int> keys = make_shuffled_sequence(n, rng);
+
+            CountingBinaryTreeInt pointer_tree;
+            build("BinaryTree", pointer_tree, keys);
+
+            CountingCompactBinaryTreeInt compact_tree;
+            build("CompactBinaryTree", compact_tree, keys);
+        }
+    }
+
+    /**
+     * @brief
+     *  BTreeSet 的节点尺寸报告：节点字节数、节点数与每键字节数，对照红黑树节点，写入文本日志。
+     *  Node-size report for BTreeSet: node bytes, node count and bytes per key, set against
+     *  the red-black tree node, reported to the text log.
+     *
+     * @param sizes
+     *  要测量的 N 列表 / list of input sizes N.
+     */
+    void report_btree_memory(const std::vector<std::size_t> &sizes)
+    {
+        std::mt19937 rng(42);
+        for (std::size_t n : sizes)
+        {
+            BTreeInt tree;
+            for (int key : make_shuffled_sequence(n, rng))
+            {
+                (void)tree.insert(key);
+            }
+            double bytes_per_key =
+                static_cast<double>(tree.memory_usage()) / static_cast<double>(n);
+
+            utils::log_info("BTreeSet at N=" + std::to_string(n) +
+                            ": node " + std::to_string(BTreeInt::node_size()) +
+                            " B, " + std::to_string(tree.node_count()) + " nodes, " +
+                            std::to_string(bytes_per_key) + " B per key (RedBlackTree node " +
+                            std::to_string(RedBlackTreeInt::node_size()) + " B)");
+        }
+    }
+
+    /**
+     * @brief
+     *  区间删除场景：在 N 个升序 key 中删除中间一半的连续窗口。
+     *  Range-erase scenario: erase the contiguous middle half of N ascending keys.
+     *
+     * @tparam Set
+     *  容器类型（需提供 erase(first, last)）/ container type (must provide erase(first, last)).
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    template <class Set>
+    void run_range_erase_benchmark_for_set(const std::string &set_name,
+                                           utils::CsvLogger &logger,
+                                           const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+
+        for (std::size_t n : sizes)
+        {
+            Set set;
+            for (int key : make_sorted_sequence(n))
+            {
+                (void)set.insert(set.end(), key);
+            }
+
+            auto start = clock::now();
+            set.erase(set.lower_bound(static_cast<int>(n / 4)),
+                      set.lower_bound(static_cast<int>(3 * n / 4)));
+            auto end = clock::now();
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".erase_range_half.N=" + std::to_string(n),
+                          static_cast<std::uint64_t>(n / 2),
+                          seconds);
+        }
+    }
+
+    /**
+     * @brief
+     *  区间聚合场景：N 个随机 key 上做区间求和，对比维护子树和的 RedBlackTree 的 aggregate(lo, hi)
+     *  与普通 RedBlackTree 从 lower_bound 迭代到 upper_bound。
+     *  Range-aggregate scenario: range sums over N random keys, comparing aggregate(lo, hi) on
+     *  a RedBlackTree that maintains subtree sums with iterating from lower_bound to
+     *  upper_bound on a plain RedBlackTree.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    void run_range_aggregate_benchmark(utils::CsvLogger &logger,
+                                       const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr std::size_t queries = 10000;
+        std::mt19937 rng(42);
+
+        for (std::size_t n : sizes)
+        {
+            std::uniform_int_distribution<int> dist(0, static_cast<int>(4 * n) - 1);
+            RedBlackTreeInt plain;
+            SumRedBlackTreeInt summed;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                int key = dist(rng);
+                (void)plain.insert(key);
+                (void)summed.insert(key);
+            }
+
+            // 每个查询覆盖约 10% 的 key 空间 / each query covers about 10% of the key space
+            std::vector<std::pair<int, int>> ranges(queries);
+            for (auto &r : ranges)
+            {
+                r.first = dist(rng);
+                r.second = r.first + static_cast<int>(4 * n / 10);
+            }
+
+            auto start = clock::now();
+            long long total = 0;
+            for (const auto &r : ranges)
+                total += summed.aggregate(r.first, r.second);
+            auto end = clock::now();
+            logger.append("SumRedBlackTree.range_sum.N=" + std::to_string(n), queries,
+                          std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+
+            start = clock::now();
+            for (const auto &r : ranges)
+            {
+                for (auto it = plain.lower_bound(r.first), stop = plain.upper_bound(r.second); it != stop; ++it)
+                    total -= *it;
+            }
+            end = clock::now();
+            logger.append("RedBlackTree.range_sum_scan.N=" + std::to_string(n), queries,
+                          std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+
+            volatile long long sink = total;
+            (void)sink;
+        }
+    }
+
+    /**
+     * @brief
+     *  区间重叠场景：N 个随机短区间上做重叠查询，对比 interval_tree 的逐个查询、批量查询与线性扫描。
+     *  Interval-overlap scenario: overlap queries over N random short intervals, comparing
+     *  interval_tree single queries, batched queries and a linear scan.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    void run_interval_benchmark(utils::CsvLogger &logger,
+                                const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+        using interval_type = interval<int>;
+
+        constexpr std::size_t queries = 1000;
+        std::mt19937 rng(42);
+
+        auto seconds_since = [](clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start)
+                .count();
+        };
+
+        for (std::size_t n : sizes)
+        {
+            const int span = static_cast<int>(16 * n);
+            std::uniform_int_distribution<int> start_dist(0, span - 1);
+            std::uniform_int_distribution<int> length_dist(0, 64);
+
+            std::vector<interval_type> items(n);
+            for (auto &iv : items)
+            {
+                iv.low = start_dist(rng);
+                iv.high = iv.low + length_dist(rng);
+            }
+            interval_tree<int> tree(items.begin(), items.end());
+
+            std::vector<interval_type> probes(queries);
+            for (auto &q : probes)
+            {
+                q.low = start_dist(rng);
+                q.high = q.low + 256;
+            }
+
+            std::size_t hits = 0;
+            auto start = clock::now();
+            for (const auto &q : probes)
+                tree.overlaps(q.low, q.high, [&hits](const interval_type &)
+                              { ++hits; });
+            logger.append("IntervalTree.overlaps.N=" + std::to_string(n), queries, seconds_since(start));
+
+            start = clock::now();
+            tree.overlaps_batch(probes, [&hits](std::size_t, const interval_type &)
+                                { --hits; });
+            logger.append("IntervalTree.overlaps_batch.N=" + std::to_string(n), queries, seconds_since(start));
+
+            start = clock::now();
+            for (const auto &q : probes)
+            {
+                for (const auto &iv : tree)
+                {
+                    if (iv.low <= q.high && q.low <= iv.high)
+                        ++hits;
+                }
+            }
+            logger.append("IntervalTree.overlaps_scan.N=" + std::to_string(n), queries, seconds_since(start));
+
+            volatile std::size_t sink = hits;
+            (void)sink;
+        }
+    }
+
+    /**
+     * @brief
+     *  多版本场景：逐个插入 N 个随机 key，保留最近 version_window 个版本，并在更老的版本里等距抽样
+     *  保留 version_samples 个；对比持久化红黑树的路径复制与每个版本整棵拷贝 RedBlackTree
+     *  （后者为 O(N^2)，只测 N <= 1000）。两者都走 CountingAllocator，内存列给出保留版本占用的字节数。
+     *  Versioning scenario: insert N random keys one by one, retaining the most recent
+     *  version_window versions plus version_samples evenly spaced older ones; compares path
+     *  copying in the persistent red-black tree with a full RedBlackTree copy per version
+     *  (the latter is O(N^2), so only N <= 1000). Both run on a CountingAllocator, so the
+     *  memory columns report the bytes held by the retained versions.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    void run_versioned_benchmark(utils::CsvLogger &logger,
+                                 const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr std::size_t version_window = 64;
+        constexpr std::size_t version_samples = 64;
+        constexpr std::size_t max_copy_n = 1000;
+
+        auto seconds_since = [](clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start)
+                .count();
+        };
+
+        // 依次派生 n 个版本：窗口外的版本按 stride 抽样留下，其余丢弃
+        // derive n versions in turn: versions leaving the window are kept every stride steps, the rest dropped
+        auto derive_versions = [](auto first, const std::vector<int> &keys, auto &&next,
+                                  std::deque<decltype(first)> &window, std::vector<decltype(first)> &samples)
+        {
+            const std::size_t stride = std::max<std::size_t>(1, keys.size() / version_samples);
+            std::size_t front_version = 0;
+            window.push_back(std::move(first));
+            for (int key : keys)
+            {
+                window.push_back(next(window.back(), key));
+                if (window.size() > version_window)
+                {
+                    if (front_version % stride == 0)
+                        samples.push_back(std::move(window.front()));
+                    window.pop_front();
+                    ++front_version;
+                }
+            }
+        };
+
+        std::mt19937 rng(42);
+
+        for (std::size_t n : sizes)
+        {
+            std::uniform_int_distribution<int> dist(0, static_cast<int>(4 * n) - 1);
+            std::vector<int> keys(n);
+            for (int &key : keys)
+                key = dist(rng);
+
+            {
+                utils::CountingAllocator<int> alloc;
+                utils::AllocationCounter &counter = alloc.counter();
+                std::deque<CountingPersistentRedBlackTreeInt> window;
+                std::vector<CountingPersistentRedBlackTreeInt> samples;
+                samples.reserve(version_samples + 1);
+
+                counter.reset_phase();
+                auto start = clock::now();
+                derive_versions(CountingPersistentRedBlackTreeInt(std::less<int>(), alloc), keys,
+                                [](const CountingPersistentRedBlackTreeInt &v, int key)
+                                { return v.insert(key); },
+                                window, samples);
+                logger.append("PersistentRedBlackTree.insert_versioned.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n), seconds_since(start), counter.usage(n));
+
+                // 在抽样保留的旧版本里查找，确认旧版本仍可读
+                // Look up in the sampled old versions: old versions stay readable.
+                start = clock::now();
+                std::size_t hits = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const auto &version = samples.empty() ? window.front() : samples[i % samples.size()];
+                    hits += version.contains(keys[i]) ? 1 : 0;
+                }
+                volatile std::size_t sink = hits;
+                (void)sink;
+                logger.append("PersistentRedBlackTree.search_old_version.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n), seconds_since(start));
+            }
+
+            if (n <= max_copy_n)
+            {
+                utils::CountingAllocator<int> alloc;
+                utils::AllocationCounter &counter = alloc.counter();
+                std::deque<CountingRedBlackTreeInt> window;
+                std::vector<CountingRedBlackTreeInt> samples;
+                samples.reserve(version_samples + 1);
+
+                counter.reset_phase();
+                auto start = clock::now();
+                derive_versions(CountingRedBlackTreeInt(std::less<int>(), alloc), keys,
+                                [](const CountingRedBlackTreeInt &v, int key)
+                                {
+                                    CountingRedBlackTreeInt next(v);
+                                    (void)next.insert(key);
+                                    return next;
+                                },
+                                window, samples);
+                logger.append("RedBlackTree.insert_versioned_copy.N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n), seconds_since(start), counter.usage(n));
+            }
+        }
+    }
+
+    /**
+     * @brief
+     *  Bloom 过滤加速场景：对每个目标误判率 p 测 FilteredSet<Tree> 的插入、命中与失败查找，
+     *  名字形如 "AVLTree@bloom_p1e-2.search_miss.N=..."，与不带过滤器的同名容器对照。
+     *  Bloom-filter scenario: for each target false-positive rate p, time insertion, hit and
+     *  miss lookups of FilteredSet<Tree>, named like "AVLTree@bloom_p1e-2.search_miss.N=..."
+     *  to compare with the unfiltered container of the same name.
+     *
+     * @tparam Tree
+     *  被包装的树 / wrapped tree.
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     * @param rate_exponents
+     *  误判率 p = 10^-e 的指数 e 列表 / exponents e of the false-positive rates p = 10^-e.
+     */
+    template <class Tree>
+    void run_filtered_benchmark_for_set(const std::string &set_name,
+                                        utils::CsvLogger &logger,
+                                        const std::vector<std::size_t> &sizes,
+                                        const std::vector<int> &rate_exponents)
+    {
+        using clock = std::chrono::steady_clock;
+
+        auto seconds_since = [](clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start)
+                .count();
+        };
+
+        for (int e : rate_exponents)
+        {
+            const double rate = std::pow(10.0, -e);
+            const std::string prefix = set_name + "@bloom_p1e-" + std::to_string(e);
+            std::mt19937 rng(42);
+
+            for (std::size_t n : sizes)
+            {
+                auto insert_keys = make_shuffled_sequence(n, rng);
+                auto miss_keys = make_missing_keys(n);
+                const std::string suffix = ".N=" + std::to_string(n);
+
+                FilteredSet<Tree> set(rate);
+
+                auto start = clock::now();
+                for (int key : insert_keys)
+                    (void)set.insert(key);
+                logger.append(prefix + ".insert" + suffix, static_cast<std::uint64_t>(n), seconds_since(start));
+
+                start = clock::now();
+                std::size_t hits = 0;
+                for (int key : insert_keys)
+                    hits += set.contains(key) ? 1 : 0;
+                logger.append(prefix + ".search_hit" + suffix, static_cast<std::uint64_t>(n), seconds_since(start));
+
+                start = clock::now();
+                for (int key : miss_keys)
+                    hits += set.contains(key) ? 1 : 0;
+                logger.append(prefix + ".search_miss" + suffix, static_cast<std::uint64_t>(n), seconds_since(start));
+
+                volatile std::size_t sink = hits;
+                (void)sink;
+                if (n == sizes.back())
+                {
+                    // 失败查找中有多少仍要进树，即实测误判率
+                    // how many misses still have to enter the tree: the observed false-positive rate
+                    std::size_t false_positives = 0;
+                    for (int key : miss_keys)
+                        false_positives += set.may_contain(key) ? 1 : 0;
+                    const double observed = static_cast<double>(false_positives) / static_cast<double>(n);
+                    const std::string report = prefix + " at N=" + std::to_string(n) + ": observed false-positive rate " +
+                                               std::to_string(observed) + ", filter " + std::to_string(set.filter_bytes()) + " B";
+                    // 过滤器按满载设计，实测明显高于目标说明哈希位有相关性
+                    // the filter is sized for full load, so a rate well above the target means correlated hash bits
+                    if (observed > 1.5 * rate)
+                        utils::log_error(report + " exceeds the target " + std::to_string(rate));
+                    else
+                        utils::log_info(report);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief
+     *  集合代数场景：两棵各 N 个随机 key 的 avl_tree 求并、交、差，对比基于 join 的算法与逐个 insert/erase。
+     *  Set-algebra scenario: union, intersection and difference of two avl_trees holding N random
+     *  keys each, comparing the join-based algorithms with element-by-element insert/erase.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     * @param threads
+     *  join 算法使用的线程数；大于 1 时名字带 ".T=" / threads used by the join-based algorithms; names carry ".T=" when above 1.
+     */
+    void run_set_algebra_benchmark(utils::CsvLogger &logger,
+                                   const std::vector<std::size_t> &sizes,
+                                   unsigned threads)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::mt19937 rng(42);
+
+        for (std::size_t n : sizes)
+        {
+            // key 取自 [0, 4N)，两树约有 1/4 重叠 / keys drawn from [0, 4N), about 1/4 overlap
+            std::uniform_int_distribution<int> dist(0, static_cast<int>(4 * n) - 1);
+            AvlTreeInt a;
+            AvlTreeInt b;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                (void)a.insert(dist(rng));
+                (void)b.insert(dist(rng));
+            }
+
+            const std::string thread_tag = threads > 1 ? ".T=" + std::to_string(threads) : "";
+            auto time_it = [&logger, n](const std::string &name, auto &&op)
+            {
+                auto start = clock::now();
+                op();
+                auto end = clock::now();
+                double seconds =
+                    std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                        .count();
+                logger.append("AVLTree." + name + ".N=" + std::to_string(n),
+                              static_cast<std::uint64_t>(n),
+                              seconds);
+            };
+
+            // 拷贝不计时 / copies are made outside the timed region
+            {
+                AvlTreeInt x(a), y(b);
+                time_it("union_join" + thread_tag, [&]
+                        { x = AvlTreeInt::set_union(std::move(x), std::move(y), threads); });
+            }
+            {
+                AvlTreeInt x(a);
+                time_it("union_insert", [&]
+                        { for (int key : b) (void)x.insert(key); });
+            }
+            {
+                AvlTreeInt x(a), y(b);
+                time_it("intersection_join" + thread_tag, [&]
+                        { x = AvlTreeInt::set_intersection(std::move(x), std::move(y), threads); });
+            }
+            {
+                AvlTreeInt x(a), y(b);
+                time_it("difference_join" + thread_tag, [&]
+                        { x = AvlTreeInt::set_difference(std::move(x), std::move(y), threads); });
+            }
+            {
+                AvlTreeInt x(a);
+                time_it("difference_erase", [&]
+                        { for (int key : b) (void)x.erase(key); });
+            }
+        }
+    }
+
+    /**
+     * @brief
+     *  顺序统计场景：在 N 个随机 key 上做百分位查询（select）与区间计数，
+     *  区间计数同时给出普通 avl_tree 上 std::distance 的 O(k) 对照。
+     *  Order-statistics scenario: percentile queries (select) and range counts over N random
+     *  keys; range counts are also timed with std::distance on a plain avl_tree as the O(k)
+     *  baseline.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param sizes
+     *  要测试的 N 列表 / list of input sizes N.
+     */
+    void run_order_statistics_benchmark(utils::CsvLogger &logger,
+                                        const std::vector<std::size_t> &sizes)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // 每个 N 上查询的次数 / number of queries per N
+        constexpr std::size_t queries = 1000;
+
+        std::mt19937 rng(42);
+
+        for (std::size_t n : sizes)
+        {
+            auto keys = make_shuffled_sequence(n, rng);
+            OrderStatAvlTreeInt ranked;
+            AvlTreeInt plain;
+            for (int key : keys)
+            {
+                (void)ranked.insert(key);
+                (void)plain.insert(key);
+            }
+
+            std::uniform_int_distribution<int> dist(0, static_cast<int>(n) - 1);
+            std::vector<std::pair<int, int>> ranges;
+            ranges.reserve(queries);
+            for (std::size_t i = 0; i < queries; ++i)
+            {
+                int a = dist(rng);
+                int b = dist(rng);
+                ranges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+
+            volatile std::size_t sink = 0;
+
+            auto start = clock::now();
+            for (std::size_t i = 0; i < queries; ++i)
+            {
+                // 均匀取 0..100 百分位 / percentiles spread evenly over 0..100
+                sink = sink + static_cast<std::size_t>(*ranked.select(i * (n - 1) / (queries - 1)));
+            }
+            auto end = clock::now();
+            logger.append("AVLTreeOS.select.N=" + std::to_string(n), queries,
+                          std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+
+            start = clock::now();
+            for (const auto &r : ranges)
+            {
+                sink = sink + ranked.count_range(r.first, r.second);
+            }
+            end = clock::now();
+            logger.append("AVLTreeOS.count_range.N=" + std::to_string(n), queries,
+                          std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+
+            start = clock::now();
+            for (const auto &r : ranges)
+            {
+                sink = sink + static_cast<std::size_t>(
+                                  std::distance(plain.lower_bound(r.first), plain.lower_bound(r.second)));
+            }
+            end = clock::now();
+            logger.append("AVLTree.count_range_scan.N=" + std::to_string(n), queries,
+                          std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+            (void)sink;
+        }
+    }
+
+    /**
+     * @brief
+     *  并发混合负载场景：key 取自 [0, N)，预先插入一半；T 个线程共执行固定总数的操作，
+     *  其中 read_percent% 为查找，其余插入与删除各半。
+     *  Concurrent mixed-workload scenario: keys are drawn from [0, N) with half of them
+     *  preloaded; T threads share a fixed total number of operations, read_percent% of them
+     *  lookups and the rest split evenly between insert and erase.
+     *
+     * @tparam Set
+     *  可被多线程同时访问的容器 / container safe for simultaneous use by many threads.
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param thread_counts
+     *  要测试的线程数列表 / list of thread counts.
+     * @param read_percent
+     *  查找操作所占百分比 / percentage of lookups.
+     */
+    template <class Set>
+    void run_concurrent_benchmark_for_set(const std::string &set_name,
+                                          utils::CsvLogger &logger,
+                                          const std::vector<unsigned> &thread_counts,
+                                          unsigned read_percent)
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr int key_range = 1 << 20;
+        constexpr std::size_t total_ops = 4000000;
+
+        for (unsigned threads : thread_counts)
+        {
+            Set set;
+            std::mt19937 rng(42);
+            std::uniform_int_distribution<int> dist(0, key_range - 1);
+            for (int i = 0; i < key_range / 2; ++i)
+            {
+                (void)set.insert(dist(rng));
+            }
+
+            std::atomic<unsigned> ready{0};
+            std::atomic<bool> go{false};
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&set, &ready, &go, t, threads, read_percent]()
+                                     {
+                    std::mt19937 local_rng(1000 + t);
+                    std::uniform_int_distribution<int> key_dist(0, key_range - 1);
+                    std::uniform_int_distribution<unsigned> op_dist(0, 99);
+                    const std::size_t ops = total_ops / threads;
+                    ready.fetch_add(1);
+                    while (!go.load())
+                    {
+                        std::this_thread::yield();
+                    }
+                    // 命中数写入 volatile，防止查找被优化掉
+                    // Hits go to a volatile sink so lookups are not optimized away.
+                    std::size_t hits = 0;
+                    for (std::size_t i = 0; i < ops; ++i)
+                    {
+                        int key = key_dist(local_rng);
+                        unsigned op = op_dist(local_rng);
+                        if (op < read_percent)
+                            hits += set.contains(key) ? 1 : 0;
+                        else if ((op - read_percent) % 2 == 0)
+                            (void)set.insert(key);
+                        else
+                            (void)set.erase(key);
+                    }
+                    volatile std::size_t sink = hits;
+                    (void)sink; });
+            }
+            while (ready.load() != threads)
+            {
+                std::this_thread::yield();
+            }
+
+            auto start = clock::now();
+            go.store(true);
+            for (auto &w : workers)
+            {
+                w.join();
+            }
+            auto end = clock::now();
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".mixed_r" + std::to_string(read_percent) +
+                              ".T=" + std::to_string(threads) +
+                              ".N=" + std::to_string(key_range),
+                          static_cast<std::uint64_t>(total_ops / threads * threads),
+                          seconds);
+        }
+    }
+
+    /**
+     * @brief
+     *  分配吞吐随线程数的伸缩：T 个线程各自反复建一棵 N 个 key 的树再整体销毁，
+     *  每个线程的工作量固定，理想情况下耗时不随 T 增长。
+     *  Allocation throughput versus threads: each of T threads repeatedly builds its own
+     *  tree of N keys and tears it down; the work per thread is fixed, so ideally the time
+     *  does not grow with T.
+     *
+     * @tparam Set
+     *  被测容器（每个线程独占一棵）/ container under test (one per thread).
+     *
+     * @param set_name
+     *  用于 CSV test_func_name 的前缀 / prefix used for CSV test_func_name.
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     * @param thread_counts
+     *  要测试的线程数列表 / list of thread counts.
+     */
+    template <class Set>
+    void run_allocation_scaling_benchmark_for_set(const std::string &set_name,
+                                                  utils::CsvLogger &logger,
+                                                  const std::vector<unsigned> &thread_counts)
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr std::size_t keys_per_tree = 10000;
+        constexpr std::size_t rounds = 20;
+
+        for (unsigned threads : thread_counts)
+        {
+            std::atomic<unsigned> ready{0};
+            std::atomic<bool> go{false};
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&ready, &go, t]()
+                                     {
+                    std::mt19937 local_rng(1000 + t);
+                    auto keys = make_shuffled_sequence(keys_per_tree, local_rng);
+                    ready.fetch_add(1);
+                    while (!go.load())
+                    {
+                        std::this_thread::yield();
+                    }
+                    std::size_t total = 0;
+                    for (std::size_t r = 0; r < rounds; ++r)
+                    {
+                        Set set;
+                        for (int key : keys)
+                        {
+                            (void)set.insert(key);
+                        }
+                        total += set.size();
+                    }
+                    volatile std::size_t sink = total;
+                    (void)sink; });
+            }
+            while (ready.load() != threads)
+            {
+                std::this_thread::yield();
+            }
+
+            auto start = clock::now();
+            go.store(true);
+            for (auto &w : workers)
+            {
+                w.join();
+            }
+            auto end = clock::now();
+            double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(end - start)
+                    .count();
+            logger.append(set_name + ".alloc_scaling.T=" + std::to_string(threads) +
+                              ".N=" + std::to_string(keys_per_tree),
+                          static_cast<std::uint64_t>(keys_per_tree * rounds * threads),
+                          seconds);
+        }
+    }
+
+    /**
+     * @brief
+     *  执行一个 benchmark 任务，异常只记录不外抛。
+     *  Run one benchmark task, logging instead of propagating exceptions.
+     */
+    void run_task(const std::function<void()> &task)
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception &ex)
+        {
+            utils::log_error(std::string("Benchmark task threw exception: ") +
+                             ex.what());
+        }
+        catch (...)
+        {
+            utils::log_error("Benchmark task threw unknown exception.");
+        }
+    }
+
+    /**
+     * @brief
+     *  并行执行多个 benchmark 任务的小型线程池实现。
+     *  A tiny thread-pool style runner to execute multiple benchmark tasks in parallel.
+     *
+     * @param tasks
+     *  任务列表，每个任务是 `void()` 可调用对象。
+     *  List of tasks, each is a `void()` callable.
+     */
+    void run_tasks_parallel(const std::vector<std::function<void()>> &tasks)
+    {
+        if (tasks.empty())
+        {
+            return;
+        }
+
+        std::atomic<std::size_t> next_index{0};
+
+        const std::size_t task_count = tasks.size();
+        std::size_t thread_count = std::thread::hardware_concurrency();
+        if (thread_count == 0)
+        {
+            thread_count = 2;
+        }
+        if (thread_count > task_count)
+        {
+            thread_count = task_count;
+        }
+
+        auto worker = [&]()
+        {
+            while (true)
+            {
+                std::size_t i = next_index.fetch_add(1, std::memory_order_relaxed);
+                if (i >= task_count)
+                {
+                    break;
+                }
+
+                run_task(tasks[i]);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief
+     *  依次执行任务，用于自带多线程、需要独占机器的测试。
+     *  Run tasks one after another, for tests that spawn their own threads and need the machine to themselves.
+     *
+     * @param tasks
+     *  任务列表 / list of tasks.
+     */
+    void run_tasks_serial(const std::vector<std::function<void()>> &tasks)
+    {
+        for (const auto &task : tasks)
+            run_task(task);
+    }
+
+    /**
+     * @brief
+     *  组合所有树容器的基准任务并并行执行。
+     *  Construct and execute all benchmark tasks for the tree containers in parallel.
+     *
+     * @param logger
+     *  CSV 日志对象 / CSV logger.
+     */
+    void run_all_benchmarks(utils::CsvLogger &logger)
+    {
+        // 这里可以根据需要调整 N 的规模 / Adjust N values as needed.
+        std::vector<std::size_t> sizes;
+        sizes.reserve(100000 / 10 + 5);
+        for (std::size_t i = 10; i < 100000; i += 10)
+            sizes.push_back(i);
+
+        // 升序插入对非平衡 BinaryTree 是 O(N^2)，规模取小一些
+        // Sorted insertion is O(N^2) for the unbalanced BinaryTree, so keep N small.
+        std::vector<std::size_t> sorted_sizes;
+        for (std::size_t i = 2000; i <= 20000; i += 2000)
+            sorted_sizes.push_back(i);
+
+        // 全量扫描覆盖到 10^7 / Full scans go up to N = 10^7.
+        std::vector<std::size_t> scan_sizes{1000, 10000, 100000, 1000000, 10000000};
+
+        // 并发基准的线程数 / thread counts of the concurrent benchmark
+        std::vector<unsigned> thread_counts{1, 2, 4, 8, 16, 32, 64};
+
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(22);
+
+        // 线程扩展性测试自己起 1–64 个线程，等任务池跑完后再逐个串行执行，免得和其他任务争抢核心
+        // Thread-scaling tests spawn 1–64 threads of their own, so they run one by one after the
+        // task pool has drained instead of competing with other tasks for cores.
+        std::vector<std::function<void()>> scaling_tasks;
+        scaling_tasks.reserve(5);
+
+        // 为每一种容器添加一个任务 / One task per container.
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running BinaryTree benchmarks...");
+            run_benchmark_for_set<BinaryTreeInt>("BinaryTree", logger, sizes);
+            utils::log_info("BinaryTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running ScapegoatTree benchmarks...");
+            run_benchmark_for_set<ScapegoatTreeInt>("ScapegoatTree", logger, sizes);
+            utils::log_info("ScapegoatTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sorted_sizes]()
+                           {
+            utils::log_info("Running sorted-insertion benchmarks...");
+            run_sorted_benchmark_for_set<BinaryTreeInt>("BinaryTree", logger, sorted_sizes);
+            run_sorted_benchmark_for_set<ScapegoatTreeInt>("ScapegoatTree", logger, sorted_sizes);
+            run_sorted_benchmark_for_set<AutoRebalanceTreeInt>("AutoRebalanceTree", logger, sorted_sizes);
+            utils::log_info("Sorted-insertion benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &scan_sizes]()
+                           {
+            utils::log_info("Running hinted-insertion benchmarks...");
+            run_hinted_benchmark_for_set<AvlTreeInt>("AVLTree", logger, scan_sizes);
+            run_hinted_benchmark_for_set<RedBlackTreeInt>("RedBlackTree", logger, scan_sizes);
+            utils::log_info("Hinted-insertion benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &scan_sizes]()
+                           {
+            utils::log_info("Running bulk-load benchmarks...");
+            run_bulk_load_benchmark_for_set<BinaryTreeInt>("BinaryTree", logger, scan_sizes);
+            run_bulk_load_benchmark_for_set<AvlTreeInt>("AVLTree", logger, scan_sizes);
+            run_bulk_load_benchmark_for_set<RedBlackTreeInt>("RedBlackTree", logger, scan_sizes);
+            utils::log_info("Bulk-load benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running ThreadedBinaryTree benchmarks...");
+            run_benchmark_for_set<ThreadedBinaryTreeInt>("ThreadedBinaryTree", logger, sizes);
+            utils::log_info("ThreadedBinaryTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &scan_sizes]()
+                           {
+            utils::log_info("Running full-scan benchmarks...");
+            run_scan_benchmark_for_set<BinaryTreeInt>("BinaryTree", logger, scan_sizes);
+            run_scan_benchmark_for_set<ThreadedBinaryTreeInt>("ThreadedBinaryTree", logger, scan_sizes);
+            utils::log_info("Full-scan benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes, &scan_sizes]()
+                           {
+            utils::log_info("Running CompactBinaryTree benchmarks...");
+            run_benchmark_for_set<CompactBinaryTreeInt>("CompactBinaryTree", logger, sizes);
+            report_binary_tree_memory(logger, scan_sizes);
+            utils::log_info("CompactBinaryTree benchmarks finished."); });
 
         tasks.emplace_back([&logger, &sizes]()
                            {
@@ -338,19 +1696,159 @@ namespace test_forest
             run_benchmark_for_set<AvlTreeInt>("AVLTree", logger, sizes);
             utils::log_info("AVL tree benchmarks finished."); });
 
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running PackedAVLTree benchmarks...");
+            run_benchmark_for_set<PackedAvlTreeInt>("PackedAVLTree", logger, sizes);
+            utils::log_info("PackedAVLTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running WAVLTree benchmarks...");
+            run_benchmark_for_set<WavlTreeInt>("WAVLTree", logger, sizes);
+            utils::log_info("WAVLTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running order-statistic AVL benchmarks...");
+            run_benchmark_for_set<OrderStatAvlTreeInt>("AVLTreeOS", logger, sizes);
+            run_order_statistics_benchmark(logger, {1000, 10000, 100000, 1000000});
+            utils::log_info("Order-statistic AVL benchmarks finished."); });
+
+        tasks.emplace_back([&logger]()
+                           {
+            utils::log_info("Running AVL set-algebra benchmarks...");
+            // 任务池里已经并行，这里串行，避免超额占用核心
+            // the task pool already runs in parallel, so stay serial here to avoid oversubscription
+            run_set_algebra_benchmark(logger, {1000, 10000, 100000, 1000000}, 1);
+            utils::log_info("AVL set-algebra benchmarks finished."); });
+
+        scaling_tasks.emplace_back([&logger, &thread_counts]()
+                                   {
+            utils::log_info("Running concurrent AVL benchmarks...");
+            for (unsigned read_percent : {90u, 50u})
+            {
+                run_concurrent_benchmark_for_set<ConcurrentAvlTreeInt>("ConcurrentAVLTree", logger, thread_counts, read_percent);
+                run_concurrent_benchmark_for_set<MutexAvlTreeInt>("MutexAVLTree", logger, thread_counts, read_percent);
+            }
+            utils::log_info("Concurrent AVL benchmarks finished."); });
+
         tasks.emplace_back([&logger, &sizes]()
                            {
             utils::log_info("Running RedBlackTree benchmarks...");
             run_benchmark_for_set<RedBlackTreeInt>("RedBlackTree", logger, sizes);
+            run_range_erase_benchmark_for_set<RedBlackTreeInt>("RedBlackTree", logger, {1000, 10000, 100000, 1000000});
+            run_range_aggregate_benchmark(logger, {1000, 10000, 100000});
+            run_interval_benchmark(logger, {1000, 10000, 100000});
             utils::log_info("RedBlackTree benchmarks finished."); });
 
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running PackedRedBlackTree benchmarks (node " +
+                            std::to_string(PackedRedBlackTreeInt::node_size()) + " B vs " +
+                            std::to_string(RedBlackTreeInt::node_size()) + " B)...");
+            run_benchmark_for_set<PackedRedBlackTreeInt>("PackedRedBlackTree", logger, sizes);
+            utils::log_info("PackedRedBlackTree benchmarks finished."); });
+
+        scaling_tasks.emplace_back([&logger, &thread_counts]()
+                                   {
+            utils::log_info("Running RCU RedBlackTree benchmarks...");
+            for (unsigned read_percent : {99u, 90u})
+            {
+                run_concurrent_benchmark_for_set<RcuRedBlackTreeInt>("RCURedBlackTree", logger, thread_counts, read_percent);
+                run_concurrent_benchmark_for_set<RwLockRedBlackTreeInt>("RwLockRedBlackTree", logger, thread_counts, read_percent);
+            }
+            utils::log_info("RCU RedBlackTree benchmarks finished."); });
+
+        tasks.emplace_back([&logger]()
+                           {
+            utils::log_info("Running persistent RedBlackTree benchmarks...");
+            run_versioned_benchmark(logger, {1000, 10000, 100000, 1000000});
+            utils::log_info("Persistent RedBlackTree benchmarks finished."); });
+
         tasks.emplace_back([&logger, &sizes]()
                            {
             utils::log_info("Running BTreeSet benchmarks...");
             run_benchmark_for_set<BTreeInt>("BTreeSet", logger, sizes);
             utils::log_info("BTreeSet benchmarks finished."); });
 
+        // 分配器矩阵：std::allocator 的结果即上面不带后缀的名字
+        // Allocator matrix: the std::allocator results are the unsuffixed names above.
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running BinaryTree allocator benchmarks...");
+            run_benchmark_for_set<PoolBinaryTreeInt>("BinaryTree@pool", logger, sizes);
+            run_benchmark_for_set<ArenaBinaryTreeInt>("BinaryTree@arena", logger, sizes);
+            utils::log_info("BinaryTree allocator benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running AVL tree allocator benchmarks...");
+            run_benchmark_for_set<PoolAvlTreeInt>("AVLTree@pool", logger, sizes);
+            run_benchmark_for_set<ArenaAvlTreeInt>("AVLTree@arena", logger, sizes);
+            utils::log_info("AVL tree allocator benchmarks finished."); });
+
+        tasks.emplace_back([&logger, &sizes]()
+                           {
+            utils::log_info("Running RedBlackTree allocator benchmarks...");
+            run_benchmark_for_set<PoolRedBlackTreeInt>("RedBlackTree@pool", logger, sizes);
+            run_benchmark_for_set<ArenaRedBlackTreeInt>("RedBlackTree@arena", logger, sizes);
+            utils::log_info("RedBlackTree allocator benchmarks finished."); });
+
+        scaling_tasks.emplace_back([&logger, &thread_counts]()
+                                   {
+            utils::log_info("Running allocation-scaling benchmarks...");
+            run_allocation_scaling_benchmark_for_set<AvlTreeInt>("AVLTree@std", logger, thread_counts);
+            run_allocation_scaling_benchmark_for_set<PoolAvlTreeInt>("AVLTree@pool", logger, thread_counts);
+            run_allocation_scaling_benchmark_for_set<CachedAvlTreeInt>("AVLTree@tcache", logger, thread_counts);
+            run_allocation_scaling_benchmark_for_set<RedBlackTreeInt>("RedBlackTree@std", logger, thread_counts);
+            run_allocation_scaling_benchmark_for_set<PoolRedBlackTreeInt>("RedBlackTree@pool", logger, thread_counts);
+            run_allocation_scaling_benchmark_for_set<CachedRedBlackTreeInt>("RedBlackTree@tcache", logger, thread_counts);
+            utils::log_info("Allocation-scaling benchmarks finished."); });
+
+        // 内存计量：BTreeSet 的内存列已随上面的常规基准写出
+        // Memory accounting: BTreeSet rows already carry memory columns from its regular run above.
+        tasks.emplace_back([&logger]()
+                           {
+            utils::log_info("Running memory-accounting benchmarks...");
+            const std::vector<std::size_t> memory_sizes{1000, 10000, 100000, 1000000};
+            run_benchmark_for_set<CountingBinaryTreeInt>("BinaryTree@counting", logger, memory_sizes);
+            run_benchmark_for_set<CountingAvlTreeInt>("AVLTree@counting", logger, memory_sizes);
+            run_benchmark_for_set<CountingRedBlackTreeInt>("RedBlackTree@counting", logger, memory_sizes);
+            report_btree_memory(memory_sizes);
+            utils::log_info("Memory-accounting benchmarks finished."); });
+
+        tasks.emplace_back([&logger]()
+                           {
+            utils::log_info("Running Bloom-filtered lookup benchmarks...");
+            const std::vector<std::size_t> filter_sizes{1000, 10000, 100000, 1000000};
+            const std::vector<int> rate_exponents{1, 2, 3};
+            run_filtered_benchmark_for_set<AvlTreeInt>("AVLTree", logger, filter_sizes, rate_exponents);
+            run_filtered_benchmark_for_set<RedBlackTreeInt>("RedBlackTree", logger, filter_sizes, rate_exponents);
+            run_filtered_benchmark_for_set<BTreeInt>("BTreeSet", logger, filter_sizes, rate_exponents);
+            utils::log_info("Bloom-filtered lookup benchmarks finished."); });
+
+        scaling_tasks.emplace_back([&logger, &thread_counts]()
+                                   {
+            utils::log_info("Running sharded-set benchmarks...");
+            for (unsigned read_percent : {90u, 50u})
+            {
+                run_concurrent_benchmark_for_set<ShardedAvlTreeInt>("ShardedAVLTree", logger, thread_counts, read_percent);
+                run_concurrent_benchmark_for_set<RangeShardedAvlTreeInt>("RangeShardedAVLTree", logger, thread_counts, read_percent);
+                run_concurrent_benchmark_for_set<ShardedRedBlackTreeInt>("ShardedRedBlackTree", logger, thread_counts, read_percent);
+                run_concurrent_benchmark_for_set<ShardedBTreeInt>("ShardedBTreeSet", logger, thread_counts, read_percent);
+            }
+            utils::log_info("Sharded-set benchmarks finished."); });
+
+        scaling_tasks.emplace_back([&logger]()
+                                   {
+            unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+            utils::log_info("Running parallel AVL set-algebra benchmarks (" + std::to_string(threads) + " threads)...");
+            run_set_algebra_benchmark(logger, {100000, 1000000}, threads);
+            utils::log_info("Parallel AVL set-algebra benchmarks finished."); });
+
         run_tasks_parallel(tasks);
+        run_tasks_serial(scaling_tasks);
     }
 
 } // namespace test_forest
@@ -0,0 +1,362 @@
+/**
+ * @file allocators.cpp
+ * @brief 内存资源实现：定长分级内存池、单调 arena 与线程缓存池 / Implementation of memory resources: fixed-size-class pool, monotonic arena and thread-caching pool.
+ */
+
+#include "allocators.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace test_forest
+{
+    namespace utils
+    {
+
+        namespace
+        {
+            /// @brief 按对齐要求向系统申请 / allocate from the system honoring alignment.
+            void *system_allocate(std::size_t bytes, std::size_t alignment)
+            {
+                if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    return ::operator new(bytes, std::align_val_t(alignment));
+                return ::operator new(bytes);
+            }
+
+            /// @brief 归还 system_allocate 得到的内存 / release memory from system_allocate.
+            void system_deallocate(void *p, std::size_t alignment) noexcept
+            {
+                if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    ::operator delete(p, std::align_val_t(alignment));
+                else
+                    ::operator delete(p);
+            }
+        } // namespace
+
+        // ================================
+        // 定长分级内存池 / Size-class pool
+        // ================================
+
+        PoolResource::~PoolResource()
+        {
+            for (void *chunk : chunks_)
+                ::operator delete(chunk, std::align_val_t(granularity));
+        }
+
+        void *PoolResource::allocate(std::size_t bytes, std::size_t alignment)
+        {
+            if (!pooled(bytes, alignment))
+                return system_allocate(bytes, alignment);
+
+            std::size_t index = (bytes - 1) / granularity;
+            SizeClass &cls = classes_[index];
+            if (cls.free)
+            {
+                FreeSlot *slot = cls.free;
+                cls.free = slot->next;
+                return slot;
+            }
+
+            std::size_t slot_bytes = (index + 1) * granularity;
+            if (static_cast<std::size_t>(cls.limit - cls.cursor) < slot_bytes)
+            {
+                // 当前大块切完，换一个新块；旧块的尾巴不足一个槽，直接放弃
+                // current chunk exhausted: start a new one; its tail is smaller than a slot
+                void *chunk = ::operator new(chunk_bytes, std::align_val_t(granularity));
+                try
+                {
+                    chunks_.push_back(chunk);
+                }
+                catch (...)
+                {
+                    ::operator delete(chunk, std::align_val_t(granularity));
+                    throw;
+                }
+                reserved_ += chunk_bytes;
+                cls.cursor = static_cast<char *>(chunk);
+                cls.limit = cls.cursor + chunk_bytes;
+            }
+
+            void *p = cls.cursor;
+            cls.cursor += slot_bytes;
+            return p;
+        }
+
+        void PoolResource::deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            if (!p)
+                return;
+            if (!pooled(bytes, alignment))
+            {
+                system_deallocate(p, alignment);
+                return;
+            }
+
+            SizeClass &cls = classes_[(bytes - 1) / granularity];
+            FreeSlot *slot = static_cast<FreeSlot *>(p);
+            slot->next = cls.free;
+            cls.free = slot;
+        }
+
+        // ================================
+        // 单调 arena / Monotonic arena
+        // ================================
+
+        ArenaResource::~ArenaResource()
+        {
+            for (void *chunk : chunks_)
+                ::operator delete(chunk);
+        }
+
+        void *ArenaResource::allocate(std::size_t bytes, std::size_t alignment)
+        {
+            if (cursor_)
+            {
+                void *p = cursor_;
+                std::size_t space = static_cast<std::size_t>(limit_ - cursor_);
+                if (std::align(alignment, bytes, p, space))
+                {
+                    cursor_ = static_cast<char *>(p) + bytes;
+                    return p;
+                }
+            }
+
+            // 新块至少容纳本次请求，之后的块大小翻倍直到上限
+            // the new chunk fits at least this request; later chunks double up to the cap
+            std::size_t size = std::max(next_chunk_, bytes + alignment);
+            void *chunk = ::operator new(size);
+            try
+            {
+                chunks_.push_back(chunk);
+            }
+            catch (...)
+            {
+                ::operator delete(chunk);
+                throw;
+            }
+            reserved_ += size;
+            next_chunk_ = std::min(next_chunk_ * 2, max_chunk_bytes);
+
+            void *p = chunk;
+            std::size_t space = size;
+            std::align(alignment, bytes, p, space);
+            cursor_ = static_cast<char *>(p) + bytes;
+            limit_ = static_cast<char *>(chunk) + size;
+            return p;
+        }
+
+        // ================================
+        // 线程缓存池 / Thread-caching pool
+        // ================================
+
+        namespace
+        {
+            using TC = ThreadCacheResource;
+
+            constexpr std::size_t tc_class_count = TC::max_cached / TC::granularity;
+
+            /// @brief 空闲槽链表结点 / free-slot list node.
+            struct CachedSlot
+            {
+                CachedSlot *next;
+            };
+
+            /// @brief 共享池的一个尺寸级，独占缓存行 / one shared-pool size class on its own cache line.
+            struct alignas(64) CentralClass
+            {
+                std::mutex lock;
+                CachedSlot *free = nullptr;
+                char *cursor = nullptr;
+                char *limit = nullptr;
+            };
+
+            /// @brief 共享池 / shared pool.
+            struct CentralPool
+            {
+                CentralClass classes[tc_class_count];
+                std::mutex chunk_lock;
+                std::vector<void *> chunks;
+                std::atomic<std::size_t> reserved{0};
+            };
+
+            /// @brief 共享池单例；有意不析构，线程退出时总能把缓存还回来
+            ///        / shared-pool singleton; deliberately never destroyed so exiting threads can always return their caches.
+            CentralPool &central()
+            {
+                static CentralPool *pool = new CentralPool();
+                return *pool;
+            }
+
+            /// @brief 从共享池取至多 want 个槽，串成链表返回 / take up to want slots from the shared pool as a list.
+            CachedSlot *central_take(std::size_t index, std::size_t want, std::size_t &taken)
+            {
+                CentralPool &pool = central();
+                CentralClass &cls = pool.classes[index];
+                const std::size_t slot_bytes = (index + 1) * TC::granularity;
+
+                std::lock_guard<std::mutex> guard(cls.lock);
+                CachedSlot *head = nullptr;
+                std::size_t n = 0;
+                while (n < want && cls.free)
+                {
+                    CachedSlot *slot = cls.free;
+                    cls.free = slot->next;
+                    slot->next = head;
+                    head = slot;
+                    ++n;
+                }
+                while (n < want)
+                {
+                    if (static_cast<std::size_t>(cls.limit - cls.cursor) < slot_bytes)
+                    {
+                        void *chunk = ::operator new(TC::chunk_bytes, std::align_val_t(TC::granularity));
+                        try
+                        {
+                            std::lock_guard<std::mutex> chunk_guard(pool.chunk_lock);
+                            pool.chunks.push_back(chunk);
+                        }
+                        catch (...)
+                        {
+                            ::operator delete(chunk, std::align_val_t(TC::granularity));
+                            if (n != 0)
+                                break;
+                            throw;
+                        }
+                        pool.reserved.fetch_add(TC::chunk_bytes, std::memory_order_relaxed);
+                        cls.cursor = static_cast<char *>(chunk);
+                        cls.limit = cls.cursor + TC::chunk_bytes;
+                    }
+                    CachedSlot *slot = reinterpret_cast<CachedSlot *>(cls.cursor);
+                    cls.cursor += slot_bytes;
+                    slot->next = head;
+                    head = slot;
+                    ++n;
+                }
+                taken = n;
+                return head;
+            }
+
+            /// @brief 把链表 [head, tail] 还回共享池 / hand the list [head, tail] back to the shared pool.
+            void central_give(std::size_t index, CachedSlot *head, CachedSlot *tail) noexcept
+            {
+                CentralClass &cls = central().classes[index];
+                std::lock_guard<std::mutex> guard(cls.lock);
+                tail->next = cls.free;
+                cls.free = head;
+            }
+
+            /// @brief 线程本地的一个尺寸级 / one thread-local size class.
+            struct LocalClass
+            {
+                CachedSlot *free;
+                std::size_t count;
+            };
+
+            // 平凡析构：线程拆除期间（包括 flusher 析构之后）仍可安全访问
+            // trivially destructible: still safe to touch during thread teardown, even after the flusher ran
+            thread_local LocalClass local_classes[tc_class_count];
+            thread_local bool cache_retired = false;
+
+            /// @brief 线程退出时清空本线程缓存 / empties the thread's cache when the thread exits.
+            struct CacheFlusher
+            {
+                bool armed = false;
+
+                ~CacheFlusher()
+                {
+                    if (armed)
+                        TC::flush_thread_cache();
+                    cache_retired = true;
+                }
+            };
+
+            thread_local CacheFlusher flusher;
+        } // namespace
+
+        void *ThreadCacheResource::allocate(std::size_t bytes, std::size_t alignment)
+        {
+            if (!cached(bytes, alignment))
+                return system_allocate(bytes, alignment);
+
+            const std::size_t index = (bytes - 1) / granularity;
+            LocalClass &local = local_classes[index];
+            if (!local.free)
+            {
+                // 线程拆除后不再囤积，每次只取一个
+                // after teardown nothing is hoarded: take one slot at a time
+                std::size_t taken = 0;
+                local.free = central_take(index, cache_retired ? 1 : batch, taken);
+                local.count = taken;
+                if (!cache_retired)
+                    flusher.armed = true;
+            }
+
+            CachedSlot *slot = local.free;
+            local.free = slot->next;
+            --local.count;
+            return slot;
+        }
+
+        void ThreadCacheResource::deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            if (!p)
+                return;
+            if (!cached(bytes, alignment))
+            {
+                system_deallocate(p, alignment);
+                return;
+            }
+
+            const std::size_t index = (bytes - 1) / granularity;
+            CachedSlot *slot = static_cast<CachedSlot *>(p);
+            if (cache_retired)
+            {
+                central_give(index, slot, slot);
+                return;
+            }
+
+            LocalClass &local = local_classes[index];
+            if (!local.free)
+                flusher.armed = true;
+            slot->next = local.free;
+            local.free = slot;
+            if (++local.count <= 2 * batch)
+                return;
+
+            // 缓存过满：把最近释放的 batch 个槽一次还回共享池
+            // cache overfull: return the batch most recently freed slots in one go
+            CachedSlot *head = local.free;
+            CachedSlot *tail = head;
+            for (std::size_t i = 1; i < batch; ++i)
+                tail = tail->next;
+            local.free = tail->next;
+            local.count -= batch;
+            central_give(index, head, tail);
+        }
+
+        std::size_t ThreadCacheResource::reserved_bytes() noexcept
+        {
+            return central().reserved.load(std::memory_order_relaxed);
+        }
+
+        void ThreadCacheResource::flush_thread_cache() noexcept
+        {
+            for (std::size_t index = 0; index < tc_class_count; ++index)
+            {
+                LocalClass &local = local_classes[index];
+                if (!local.free)
+                    continue;
+                CachedSlot *tail = local.free;
+                while (tail->next)
+                    tail = tail->next;
+                central_give(index, local.free, tail);
+                local.free = nullptr;
+                local.count = 0;
+            }
+        }
+
+    } // namespace utils
+} // namespace test_forest
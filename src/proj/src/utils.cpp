@@ -80,12 +80,13 @@ namespace test_forest
 
                 if (write_header)
                 {
-                    out << "test_func_name,count,time_usage\n";
+                    out << "test_func_name,count,time_usage,live_bytes,peak_bytes,alloc_count,bytes_per_key\n";
                     header_written = true;
                 }
             }
 
-            void append(const std::string &name, std::uint64_t count, double time_usage_seconds)
+            void append(const std::string &name, std::uint64_t count, double time_usage_seconds,
+                        const MemoryUsage *memory)
             {
                 std::lock_guard<std::mutex> lock(mutex);
                 if (!out.is_open())
@@ -114,7 +115,19 @@ namespace test_forest
                 out << ',' << count << ',';
 
                 // 固定精度输出秒数 / fixed precision seconds
-                out << std::fixed << std::setprecision(9) << time_usage_seconds << '\n';
+                out << std::fixed << std::setprecision(9) << time_usage_seconds;
+
+                // 内存列：未测量时留空 / memory columns: empty when not measured
+                if (memory)
+                {
+                    out << ',' << memory->live_bytes << ',' << memory->peak_bytes << ','
+                        << memory->alloc_count << ',' << std::setprecision(3) << memory->bytes_per_key;
+                }
+                else
+                {
+                    out << ",,,,";
+                }
+                out << '\n';
             }
 
             void flush()
@@ -153,7 +166,19 @@ namespace test_forest
             {
                 throw std::runtime_error("CsvLogger: append() on invalid logger.");
             }
-            impl_->append(test_func_name, count, time_usage_seconds);
+            impl_->append(test_func_name, count, time_usage_seconds, nullptr);
+        }
+
+        void CsvLogger::append(const std::string &test_func_name,
+                               std::uint64_t count,
+                               double time_usage_seconds,
+                               const MemoryUsage &memory)
+        {
+            if (!impl_)
+            {
+                throw std::runtime_error("CsvLogger: append() on invalid logger.");
+            }
+            impl_->append(test_func_name, count, time_usage_seconds, &memory);
         }
 
         void CsvLogger::flush()